@@ -5,7 +5,9 @@
 
 #include "FrozenWorldPoseExtensions.h"
 #include "FrozenWorldPlugin.h"
+#include "PoseAveraging.h"
 
+#include "Async/ParallelFor.h"
 #include "HAL/PlatformFileManager.h"
 #include "Misc/Paths.h"
 
@@ -20,18 +22,32 @@ namespace WorldLockingTools
 	/// </summary>
 	void FReferencePose::CheckAttachmentPoint()
 	{
-		if (AttachmentPoint == nullptr)
+		if (!AttachmentPoint.IsValid())
 		{
 			LocationHandler.BindRaw(this, &FReferencePose::OnLocationUpdate);
 
-			AttachmentPoint = FFragmentManager::Get()->CreateAttachmentPoint(lockedPose.GetLocation(), nullptr, LocationHandler, nullptr);
+			AttachmentPoint = FFragmentManager::Get()->CreateAttachmentPoint(lockedPose.GetLocation(), FAttachmentPointHandle(), LocationHandler, nullptr);
 		}
 		else
 		{
-			FFragmentManager::Get()->TeleportAttachmentPoint(AttachmentPoint, lockedPose.GetLocation(), nullptr);
+			FFragmentManager::Get()->TeleportAttachmentPoint(AttachmentPoint, lockedPose.GetLocation(), FAttachmentPointHandle());
 		}
 	}
 
+	/// <summary>
+	/// Release the attachment point, once the pose is no longer in use.
+	/// </summary>
+	void FReferencePose::Release()
+	{
+		if (AttachmentPoint.IsValid())
+		{
+			FFragmentManager::Get()->ReleaseAttachmentPoint(AttachmentPoint);
+			AttachmentPoint = FAttachmentPointHandle();
+		}
+		LocationHandler.Unbind();
+		PoseChangedHandler.Unbind();
+	}
+
 	/// <summary>
 	/// Update the pose for refit operations.
 	/// </summary>
@@ -64,105 +80,138 @@ namespace WorldLockingTools
 		CheckSend();
 		CheckFragment();
 		CheckSave();
+		if (pinnedPosesDirty)
+		{
+			CachePinnedPoses();
+		}
 		if (activePoses.Num() < 1)
 		{
 			PinnedFromLocked = FTransform::Identity;
 		}
+		else if (levels.Num() > 0)
+		{
+			PinnedFromLocked = ComputeLevelsPose(lockedHeadPose.GetLocation(), levelHints);
+		}
 		else
 		{
-			TArray<WeightedPose> poses = ComputePoseWeights(lockedHeadPose.GetLocation());
-			PinnedFromLocked = WeightedAverage(poses);
+			Interpolant bary;
+			bool found = triangulator.Find(lockedHeadPose.GetLocation(), bary);
+			check(found); //Failed to find an interpolant even though there are pins active.
+			PinnedFromLocked = found ? BlendPinnedPoses(bary) : FTransform::Identity;
 		}
 	}
 
-	TArray<WeightedPose> FAlignmentManager::ComputePoseWeights(FVector lockedHeadPosition)
+	/// <summary>
+	/// Compute the PinnedFromLocked pose at each of many positions in locked space, as ComputePinnedPose does at the head.
+	///
+	/// The triangulation is walked from where the previous position was found, so positions close to the one before them
+	/// are found fastest.
+	/// </summary>
+	/// <param name="lockedPositions">The positions to evaluate at.</param>
+	/// <param name="outPinnedFromLocked">Set to the pose at each position, sized like lockedPositions.</param>
+	/// <param name="batchSize">Number of positions per task spread over worker threads, zero or negative to compute all on this thread.</param>
+	void FAlignmentManager::ComputePinnedPoses(TArrayView<const FVector> lockedPositions, TArrayView<FTransform> outPinnedFromLocked, int batchSize)
 	{
-		weightedPoses.Empty();
+		check(outPinnedFromLocked.Num() == lockedPositions.Num());
+		CheckSend();
+		CheckFragment();
+		if (pinnedPosesDirty)
+		{
+			CachePinnedPoses();
+		}
 
-		Interpolant bary;
-		if (triangulator.Find(lockedHeadPosition, bary))
+		// Lookups only read the triangulation and the cached poses, each range walking from its own last triangle found.
+		auto computeRange = [this, lockedPositions, outPinnedFromLocked](int begin, int end)
 		{
-			for (int i = 0; i < 3; ++i)
+			int hint = -1;
+			TArray<int, TInlineAllocator<8>> levelRangeHints;
+			levelRangeHints.Init(-1, levels.Num());
+			for (int i = begin; i < end; ++i)
 			{
-				weightedPoses.Add(
-					WeightedPose
-					{
-						ComputePinnedFromLocked(activePoses[bary.idx[i]]),
-						bary.weights[i]
-					}
-				);
+				if (levels.Num() > 0)
+				{
+					outPinnedFromLocked[i] = ComputeLevelsPose(lockedPositions[i], levelRangeHints);
+					continue;
+				}
+				Interpolant bary;
+				bool found = activePoses.Num() > 0 && triangulator.Find(lockedPositions[i], hint, bary);
+				outPinnedFromLocked[i] = found ? BlendPinnedPoses(bary) : FTransform::Identity;
 			}
+		};
+
+		int count = lockedPositions.Num();
+		if (batchSize <= 0 || count <= batchSize)
+		{
+			computeRange(0, count);
 		}
 		else
 		{
-			check(activePoses.Num() == 0); //Failed to find an interpolant even though there are pins active.
+			int numBatches = FMath::DivideAndRoundUp(count, batchSize);
+			ParallelFor(numBatches, [&computeRange, count, batchSize](int32 batch)
+			{
+				computeRange(batch * batchSize, FMath::Min(count, (batch + 1) * batchSize));
+			});
 		}
-
-		return weightedPoses;
 	}
 
 	/// <summary>
-	/// Compute the PinnedFromLocked pose for the given reference pose.
+	/// Blend the cached PinnedFromLocked poses of the pins at the corners of an interpolant.
 	/// </summary>
-	/// <param name="refPose">The reference pose to evaluate.</param>
-	/// <returns>The computed PinnedFromLocked pose.</returns>
-	FTransform FAlignmentManager::ComputePinnedFromLocked(FReferencePose refPose)
+	FTransform FAlignmentManager::BlendPinnedPoses(const Interpolant& bary) const
 	{
-		FTransform pinnedFromObject = refPose.virtualPose;
-		FTransform objectFromLocked = FFrozenWorldPoseExtensions::Inverse(refPose.LockedPose());
-
-		return FFrozenWorldPoseExtensions::Multiply(pinnedFromObject, objectFromLocked);
-	}
-
-	
-	/// <summary>
-	/// Collapse a list of weighted poses into a single equivalent pose.
-	/// </summary>
-	/// <param name="poses">The poses to average.</param>
-	/// <returns>The weighted average. If the list is empty, returns an identity pose.</returns>
-	FTransform FAlignmentManager::WeightedAverage(TArray<WeightedPose> poses)
-	{
-		if (poses.Num() < 1)
+		if (bary.weights[0] + bary.weights[1] + bary.weights[2] <= 0.0f)
 		{
 			return FTransform::Identity;
 		}
-
-		while (poses.Num() > 1)
+		FVector positions[3];
+		FQuat rotations[3];
+		for (int i = 0; i < 3; ++i)
 		{
-			// Collapse the last two into an equivalent average one.
-			poses[poses.Num() - 2] = WeightedAverage(poses[poses.Num() - 2], poses[poses.Num() - 1]);
-			poses.RemoveAt(poses.Num() - 1);
+			positions[i] = pinnedPositions[bary.idx[i]];
+			rotations[i] = pinnedRotations[bary.idx[i]];
 		}
+		TArrayView<const float> weights = MakeArrayView(bary.weights);
+		return FTransform(AverageRotations(MakeArrayView(rotations), weights), FPoseAveraging::AveragePositions(MakeArrayView(positions), weights));
+	}
 
-		return poses[0].pose;
+	/// <summary>
+	/// Average rotations the way SetEigenRotationAveraging last chose, for the pins of a triangle and for blended levels alike.
+	/// </summary>
+	FQuat FAlignmentManager::AverageRotations(TArrayView<const FQuat> rotations, TArrayView<const float> weights) const
+	{
+		return eigenRotationAveraging
+			? FPoseAveraging::AverageRotationsEigen(rotations, weights)
+			: FPoseAveraging::AverageRotations(rotations, weights);
 	}
+
 	/// <summary>
-	/// Combine two weighted poses via interpolation into a single equivalent weighted pose.
+	/// Compute each active pose's PinnedFromLocked, and the triangles' barycentric setup, once for every frame until they change.
 	/// </summary>
-	/// <param name="lhs">Left hand pose</param>
-	/// <param name="rhs">Right hand pose</param>
-	/// <returns>The equivalent pose.</returns>
-	WeightedPose FAlignmentManager::WeightedAverage(WeightedPose lhs, WeightedPose rhs)
+	void FAlignmentManager::CachePinnedPoses()
 	{
-		float minCombinedWeight = 0.0f;
-		if (lhs.weight + rhs.weight <= minCombinedWeight)
+		pinnedPosesDirty = false;
+		pinnedPositions.Reset(activePoses.Num());
+		pinnedRotations.Reset(activePoses.Num());
+		for (int poolIndex : activePoses)
 		{
-			return WeightedPose
-			{
-				FTransform::Identity,
-				0.0f
-			};
+			FTransform pinnedFromLocked = ComputePinnedFromLocked(PooledPose(poolIndex));
+			pinnedPositions.Add(pinnedFromLocked.GetLocation());
+			pinnedRotations.Add(pinnedFromLocked.GetRotation());
 		}
-		float interp = rhs.weight / (lhs.weight + rhs.weight);
+		triangulator.BuildTriangleCache();
+	}
 
-		WeightedPose ret;
-		FVector pos = lhs.pose.GetLocation() + interp * (rhs.pose.GetLocation() - lhs.pose.GetLocation());
-		FQuat rot = FQuat::Slerp(lhs.pose.GetRotation(), rhs.pose.GetRotation(), interp);
-		rot.Normalize();
-		ret.pose = FTransform(rot, pos);
-		ret.weight = lhs.weight + rhs.weight;
+	/// <summary>
+	/// Compute the PinnedFromLocked pose for the given reference pose.
+	/// </summary>
+	/// <param name="refPose">The reference pose to evaluate.</param>
+	/// <returns>The computed PinnedFromLocked pose.</returns>
+	FTransform FAlignmentManager::ComputePinnedFromLocked(const FReferencePose& refPose)
+	{
+		FTransform pinnedFromObject = refPose.virtualPose;
+		FTransform objectFromLocked = FFrozenWorldPoseExtensions::Inverse(refPose.LockedPose());
 
-		return ret;
+		return FFrozenWorldPoseExtensions::Multiply(pinnedFromObject, objectFromLocked);
 	}
 
 	/// <summary>
@@ -170,14 +219,14 @@ namespace WorldLockingTools
 	/// </summary>
 	void FAlignmentManager::CheckSave()
 	{
-		if (referencePosesToSave.Num() > 0)
+		if (posesToSave.Num() > 0)
 		{
-			//DebugLogSaveLoad($"{SaveFileName} has {referencePosesToSave.Count} to save");
-			for (int i = referencePosesToSave.Num() - 1; i >= 0; --i)
+			//DebugLogSaveLoad($"{SaveFileName} has {posesToSave.Count} to save");
+			for (int poolIndex : posesToSave)
 			{
-				poseDB.Set(referencePosesToSave[i]);
+				poseDB.Set(PooledPose(poolIndex));
 			}
-			referencePosesToSave.Empty();
+			posesToSave.Empty();
 			needSave = true;
 		}
 	}
@@ -202,27 +251,124 @@ namespace WorldLockingTools
 	/// </summary>
 	void FAlignmentManager::PerformSendAlignmentAnchors()
 	{
-		sentPoses.Empty();
-		for (int i = 0; i < referencePoses.Num(); ++i)
+		TArray<int> previousSentPoses = MoveTemp(sentPoses);
+		for (int poolIndex : previousSentPoses)
 		{
-			sentPoses.Add(referencePoses[i]);
+			posePool[poolIndex].sent = false;
+		}
+		sentPoses.Reset(addedPoses.Num());
+		for (const TPair<FrozenWorld_AnchorId, int>& added : addedPoses)
+		{
+			sentPoses.Add(added.Value);
+			posePool[added.Value].sent = true;
 		}
 		ActivateCurrentFragment();
+
+		// Poses removed since the last send are only let go once the triangulation no longer refers to them.
+		for (int poolIndex : previousSentPoses)
+		{
+			FreePoseIfUnused(poolIndex);
+		}
 	}
 
 	void FAlignmentManager::ActivateCurrentFragment()
 	{
 		//DebugLogSaveLoad($"Active fragment from {ActiveFragmentId.FormatStr()} to {CurrentFragmentId.FormatStr()}");
-		activePoses.Empty();
-		for (int i = 0; i < sentPoses.Num(); ++i)
+		FrozenWorld_FragmentId currentFragmentId = FFragmentManager::Get()->GetCurrentFragmentId();
+		TArray<int> newActivePoses;
+		for (int poolIndex : sentPoses)
+		{
+			if (PooledPose(poolIndex).IsActive(currentFragmentId))
+			{
+				newActivePoses.Add(poolIndex);
+			}
+		}
+
+		bool sameFragment = activeFragmentId == currentFragmentId;
+		activeFragmentId = currentFragmentId;
+		if (levelSeparation > 0)
+		{
+			activePoses = MoveTemp(newActivePoses);
+			BuildLevels();
+		}
+		else if (!sameFragment || !UpdateTriangulation(newActivePoses))
+		{
+			activePoses = MoveTemp(newActivePoses);
+			BuildTriangulation();
+		}
+		CachePinnedPoses();
+	}
+
+	/// <summary>
+	/// Bring the triangulation up to date with a new set of active poses by adding, removing and moving
+	/// only the vertices of poses that changed, matched up by name.
+	/// 
+	/// Editing a few pins among many then only changes the triangles around them.
+	/// </summary>
+	/// <returns>False, leaving everything as it was, if a full rebuild is called for instead.</returns>
+	bool FAlignmentManager::UpdateTriangulation(const TArray<int>& newActivePoses)
+	{
+		if (activePoses.Num() == 0 || newActivePoses.Num() == 0)
+		{
+			return false;
+		}
+
+		TMap<FName, int> newIndices;
+		newIndices.Reserve(newActivePoses.Num());
+		for (int i = 0; i < newActivePoses.Num(); ++i)
+		{
+			FName name = PooledPose(newActivePoses[i]).name;
+			if (newIndices.Contains(name))
+			{
+				return false;
+			}
+			newIndices.Add(name, i);
+		}
+
+		int numRemoved = 0;
+		for (int i = 0; i < activePoses.Num(); ++i)
+		{
+			numRemoved += newIndices.Contains(PooledPose(activePoses[i]).name) ? 0 : 1;
+		}
+		int numAdded = newActivePoses.Num() - (activePoses.Num() - numRemoved);
+		// When most of the poses are new, building from scratch is quicker.
+		if ((numRemoved + numAdded) * 2 > activePoses.Num())
+		{
+			return false;
+		}
+
+		// The triangulator removes vertices the same way the poses are removed here, so their indices stay in step.
+		TArray<bool> matched;
+		matched.Init(false, newActivePoses.Num());
+		for (int i = activePoses.Num() - 1; i >= 0; --i)
+		{
+			const int* newIndex = newIndices.Find(PooledPose(activePoses[i]).name);
+			if (newIndex == nullptr)
+			{
+				triangulator.RemoveVertex(i);
+				activePoses.RemoveAtSwap(i, 1, false);
+			}
+		}
+		for (int i = 0; i < activePoses.Num(); ++i)
 		{
-			if (sentPoses[i].IsActive(FFragmentManager::Get()->GetCurrentFragmentId()))
+			int newIndex = newIndices[PooledPose(activePoses[i]).name];
+			FVector newPosition = PooledPose(newActivePoses[newIndex]).LockedPose().GetLocation();
+			if (!newPosition.Equals(triangulator.GetVertex(i), 0.0f))
 			{
-				activePoses.Add(sentPoses[i]);
+				triangulator.MoveVertex(i, newPosition);
 			}
+			activePoses[i] = newActivePoses[newIndex];
+			matched[newIndex] = true;
 		}
-		activeFragmentId = FFragmentManager::Get()->GetCurrentFragmentId();
-		BuildTriangulation();
+		for (int i = 0; i < newActivePoses.Num(); ++i)
+		{
+			if (!matched[i])
+			{
+				triangulator.AddVertex(PooledPose(newActivePoses[i]).LockedPose().GetLocation());
+				activePoses.Add(newActivePoses[i]);
+			}
+		}
+		return true;
 	}
 
 	void FAlignmentManager::BuildTriangulation()
@@ -232,9 +378,9 @@ namespace WorldLockingTools
 		if (activePoses.Num() > 0)
 		{
 			TArray<FVector> positions;
-			for (int i = 0; i < activePoses.Num(); ++i)
+			for (int poolIndex : activePoses)
 			{
-				positions.Add(activePoses[i].LockedPose().GetLocation());
+				positions.Add(PooledPose(poolIndex).LockedPose().GetLocation());
 			}
 			triangulator.Add(positions);
 		}
@@ -249,6 +395,201 @@ namespace WorldLockingTools
 		}
 	}
 
+	void FAlignmentManager::InitTriangulator(FTriangulator& levelTriangulator) const
+	{
+		levelTriangulator.Clear();
+		levelTriangulator.SetDelaunay(triangulator.IsDelaunay());
+		levelTriangulator.SetBounds(FVector(-100000, -100000, 0), FVector(100000, 100000, 0));
+	}
+
+	void FAlignmentManager::SetDelaunayTriangulation(bool delaunay)
+	{
+		triangulator.SetDelaunay(delaunay);
+		triangulator.BuildTriangleCache();
+		for (FAlignmentLevel& level : levels)
+		{
+			level.triangulator.SetDelaunay(delaunay);
+			level.triangulator.BuildTriangleCache();
+		}
+	}
+
+	void FAlignmentManager::SetAlignmentLevels(float separation, float blendHeight)
+	{
+		levelBlendHeight = blendHeight;
+		if (separation == levelSeparation)
+		{
+			return;
+		}
+		levelSeparation = separation;
+		levels.Empty();
+		levelHints.Empty();
+		if (levelSeparation > 0)
+		{
+			triangulator.Clear();
+			BuildLevels();
+		}
+		else
+		{
+			BuildTriangulation();
+		}
+		CachePinnedPoses();
+	}
+
+	/// <summary>
+	/// Split the active poses into levels, wherever their locked heights are further apart than the level separation,
+	/// and triangulate each level by itself.
+	/// 
+	/// A level with the same pins at the same positions as before keeps its triangulation, so changing the pins
+	/// on one floor only triangulates that floor again.
+	/// </summary>
+	void FAlignmentManager::BuildLevels()
+	{
+		auto height = [this](int activeIndex)
+		{
+			return PooledPose(activePoses[activeIndex]).LockedPose().GetLocation().Z;
+		};
+		TArray<int> byHeight;
+		TMap<int, int> activeIndices;
+		byHeight.Reserve(activePoses.Num());
+		activeIndices.Reserve(activePoses.Num());
+		for (int i = 0; i < activePoses.Num(); ++i)
+		{
+			byHeight.Add(i);
+			activeIndices.Add(activePoses[i], i);
+		}
+		byHeight.Sort([&height](int lhs, int rhs) { return height(lhs) < height(rhs); });
+
+		TArray<FAlignmentLevel> previousLevels = MoveTemp(levels);
+		levels.Reset();
+		for (int begin = 0; begin < byHeight.Num();)
+		{
+			int end = begin + 1;
+			while (end < byHeight.Num() && height(byHeight[end]) - height(byHeight[end - 1]) <= levelSeparation)
+			{
+				++end;
+			}
+
+			FAlignmentLevel& level = levels.AddDefaulted_GetRef();
+			level.minHeight = height(byHeight[begin]);
+			level.maxHeight = height(byHeight[end - 1]);
+			TSet<int> levelPoses;
+			for (int i = begin; i < end; ++i)
+			{
+				level.poses.Add(activePoses[byHeight[i]]);
+				levelPoses.Add(activePoses[byHeight[i]]);
+			}
+
+			auto samePins = [this, &levelPoses](const FAlignmentLevel& previous)
+			{
+				if (previous.poses.Num() != levelPoses.Num())
+				{
+					return false;
+				}
+				for (int v = 0; v < previous.poses.Num(); ++v)
+				{
+					if (!levelPoses.Contains(previous.poses[v])
+						|| !PooledPose(previous.poses[v]).LockedPose().GetLocation().Equals(previous.triangulator.GetVertex(v), 0.0f))
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+			FAlignmentLevel* previous = previousLevels.FindByPredicate(samePins);
+			if (previous != nullptr)
+			{
+				// Keep the pins in the order of the triangulator's vertices.
+				level.poses = MoveTemp(previous->poses);
+				level.triangulator = MoveTemp(previous->triangulator);
+			}
+			else
+			{
+				InitTriangulator(level.triangulator);
+				TArray<FVector> positions;
+				for (int poolIndex : level.poses)
+				{
+					positions.Add(PooledPose(poolIndex).LockedPose().GetLocation());
+				}
+				level.triangulator.Add(positions);
+				level.triangulator.BuildTriangleCache();
+			}
+			for (int poolIndex : level.poses)
+			{
+				level.activeIndices.Add(activeIndices[poolIndex]);
+			}
+			begin = end;
+		}
+		levelHints.Init(-1, levels.Num());
+	}
+
+	/// <summary>
+	/// The height halfway between a level and the one above it.
+	/// </summary>
+	double FAlignmentManager::LevelBoundary(int levelIndex) const
+	{
+		return (levels[levelIndex].maxHeight + levels[levelIndex + 1].minHeight) * 0.5;
+	}
+
+	/// <summary>
+	/// Compute the PinnedFromLocked pose at a position from the pins of its level.
+	/// 
+	/// Within half the blend height of the boundary with the level above or below, the pose there is blended in,
+	/// from half at the boundary down to nothing, so that the alignment changes smoothly on stairs and ramps.
+	/// </summary>
+	/// <param name="hints">The triangle each level's lookups last ended in, updated by this lookup.</param>
+	FTransform FAlignmentManager::ComputeLevelsPose(FVector lockedPosition, TArrayView<int> hints) const
+	{
+		double height = lockedPosition.Z;
+		int levelIndex = 0;
+		while (levelIndex + 1 < levels.Num() && height > LevelBoundary(levelIndex))
+		{
+			++levelIndex;
+		}
+		FTransform pose = ComputeLevelPose(levelIndex, lockedPosition, hints[levelIndex]);
+
+		double halfBlendHeight = levelBlendHeight * 0.5;
+		int otherIndex = INDEX_NONE;
+		double distance = 0;
+		if (levelIndex > 0 && height - LevelBoundary(levelIndex - 1) < halfBlendHeight)
+		{
+			otherIndex = levelIndex - 1;
+			distance = height - LevelBoundary(levelIndex - 1);
+		}
+		else if (levelIndex + 1 < levels.Num() && LevelBoundary(levelIndex) - height < halfBlendHeight)
+		{
+			otherIndex = levelIndex + 1;
+			distance = LevelBoundary(levelIndex) - height;
+		}
+		if (otherIndex == INDEX_NONE)
+		{
+			return pose;
+		}
+
+		FTransform otherPose = ComputeLevelPose(otherIndex, lockedPosition, hints[otherIndex]);
+		float otherWeight = 0.5f * (1.0f - distance / halfBlendHeight);
+		float weights[2] = { 1.0f - otherWeight, otherWeight };
+		FQuat rotations[2] = { pose.GetRotation(), otherPose.GetRotation() };
+		FVector positions[2] = { pose.GetLocation(), otherPose.GetLocation() };
+		return FTransform(
+			AverageRotations(MakeArrayView(rotations), MakeArrayView(weights)),
+			FPoseAveraging::AveragePositions(MakeArrayView(positions), MakeArrayView(weights)));
+	}
+
+	FTransform FAlignmentManager::ComputeLevelPose(int levelIndex, FVector lockedPosition, int& hint) const
+	{
+		const FAlignmentLevel& level = levels[levelIndex];
+		Interpolant bary;
+		if (!level.triangulator.Find(lockedPosition, hint, bary))
+		{
+			return FTransform::Identity;
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			bary.idx[i] = level.activeIndices[bary.idx[i]];
+		}
+		return BlendPinnedPoses(bary);
+	}
+
 	/// <summary>
 	/// If still waiting for a valid current fragment since last load,
 	/// and there is a current valid fragment, set it to reference poses.
@@ -262,13 +603,14 @@ namespace WorldLockingTools
 			&& CurrentFragmentId != FrozenWorld_FragmentId_UNKNOWN)
 		{
 			FrozenWorld_FragmentId fragmentId = CurrentFragmentId;
-			for (int i = 0; i < referencePoses.Num(); ++i)
+			for (const TPair<FrozenWorld_AnchorId, int>& added : addedPoses)
 			{
-				if (referencePoses[i].fragmentId == FrozenWorld_FragmentId_INVALID 
-					|| referencePoses[i].fragmentId == FrozenWorld_FragmentId_UNKNOWN)
+				FReferencePose& refPose = PooledPose(added.Value);
+				if (refPose.fragmentId == FrozenWorld_FragmentId_INVALID 
+					|| refPose.fragmentId == FrozenWorld_FragmentId_UNKNOWN)
 				{
-					//DebugLogSaveLoad($"Transfer {referencePoses[i].anchorId.FormatStr()} from frag={referencePoses[i].fragmentId.FormatStr()} to {fragmentId.FormatStr()}");
-					referencePoses[i].fragmentId = fragmentId;
+					//DebugLogSaveLoad($"Transfer {refPose.anchorId.FormatStr()} from frag={refPose.fragmentId.FormatStr()} to {fragmentId.FormatStr()}");
+					refPose.fragmentId = fragmentId;
 					changed = true;
 				}
 			}
@@ -293,8 +635,14 @@ namespace WorldLockingTools
 	void FAlignmentManager::ClearAlignmentAnchors()
 	{
 		poseDB.Empty();
-		referencePoses.Empty();
-		referencePosesToSave.Empty();
+		for (const TPair<FrozenWorld_AnchorId, int>& added : addedPoses)
+		{
+			posePool[added.Value].added = false;
+			FreePoseIfUnused(added.Value);
+		}
+		addedPoses.Empty();
+		addedPosesByName.Empty();
+		posesToSave.Empty();
 
 		FAlignmentManager::OnAlignmentManagerReset.Broadcast();
 	}
@@ -308,9 +656,39 @@ namespace WorldLockingTools
 	/// </summary>
 	void FAlignmentManager::SendAlignmentAnchors()
 	{
+		if (transactionDepth > 0)
+		{
+			sendOnCommit = true;
+			return;
+		}
 		needSend = true;
 	}
 
+	/// <summary>
+	/// Hold back sends until the matching CommitTransaction, so that many alignment anchors can be added, removed
+	/// and sent one at a time, over any number of frames, and take effect together with a single send.
+	/// 
+	/// Transactions may be nested, in which case the sends are held until the outermost one is committed.
+	/// </summary>
+	void FAlignmentManager::BeginTransaction()
+	{
+		++transactionDepth;
+	}
+
+	/// <summary>
+	/// End a transaction begun with BeginTransaction. If any sends were asked for during it, the alignment anchors
+	/// are sent once, as by SendAlignmentAnchors.
+	/// </summary>
+	void FAlignmentManager::CommitTransaction()
+	{
+		check(transactionDepth > 0);
+		if (--transactionDepth == 0 && sendOnCommit)
+		{
+			sendOnCommit = false;
+			needSend = true;
+		}
+	}
+
 	/// <summary>
 	/// Add an anchor for aligning a virtual pose to a pose in real space. 
 	/// 
@@ -329,15 +707,16 @@ namespace WorldLockingTools
 		FrozenWorld_AnchorId anchorId = ClaimAnchorId();
 		virtualPose = FFrozenWorldPoseExtensions::Multiply(FFrozenWorldPlugin::Get()->PinnedFromFrozen(), virtualPose);
 
-		FReferencePose refPose;
-		refPose.name = uniqueName;
+		int poolIndex = AllocatePose();
+		FReferencePose& refPose = PooledPose(poolIndex);
+		refPose.name = FName(*uniqueName);
 		refPose.fragmentId = fragmentId;
 		refPose.anchorId = anchorId;
 		refPose.virtualPose = virtualPose;
 		refPose.SetLockedPose(lockedPose);
 
-		referencePoses.Add(refPose);
-		QueueForSave(refPose);
+		AddPose(poolIndex);
+		posesToSave.Add(poolIndex);
 
 		return anchorId;
 	}
@@ -353,13 +732,10 @@ namespace WorldLockingTools
 		if (AnchorID != FrozenWorld_AnchorId_UNKNOWN
 			&& AnchorID != FrozenWorld_AnchorId_INVALID)
 		{
-			for (int i = 0; i < referencePoses.Num(); ++i)
+			if (const int* poolIndex = addedPoses.Find(AnchorID))
 			{
-				if (referencePoses[i].anchorId == AnchorID)
-				{
-					outLockedPose = referencePoses[i].LockedPose();
-					return true;
-				}
+				outLockedPose = PooledPose(*poolIndex).LockedPose();
+				return true;
 			}
 		}
 		outLockedPose = FTransform::Identity;
@@ -373,46 +749,72 @@ namespace WorldLockingTools
 	/// <returns>True if the anchor was found.</returns>
 	bool FAlignmentManager::RemoveAlignmentAnchor(FrozenWorld_AnchorId AnchorID)
 	{
-		bool found = false;
 		if (AnchorID != FrozenWorld_AnchorId_UNKNOWN
 			&& AnchorID != FrozenWorld_AnchorId_INVALID)
 		{
-			for (int i = referencePoses.Num() - 1; i >= 0; --i)
-			{
-				if (referencePoses[i].anchorId == AnchorID)
-				{
-					poseDB.Forget(referencePoses[i].name);
-					referencePoses.RemoveAt(i);
-					found = true;
-				}
-			}
-			for (int i = referencePosesToSave.Num() - 1; i >= 0; --i)
+			if (const int* found = addedPoses.Find(AnchorID))
 			{
-				if (referencePosesToSave[i].anchorId == AnchorID)
-				{
-					referencePosesToSave.RemoveAt(i);
-				}
+				int poolIndex = *found;
+				poseDB.Forget(PooledPose(poolIndex).name);
+				RemovePose(poolIndex);
+				return true;
 			}
 		}
 
-		return found;
+		return false;
+	}
+
+	/// <summary>
+	/// Make room in the pool for a new reference pose, which isn't added yet.
+	/// </summary>
+	/// <returns>The pool index of the new pose.</returns>
+	int FAlignmentManager::AllocatePose()
+	{
+		int poolIndex = posePool.Emplace();
+		posePool[poolIndex].pose = MakeUnique<FReferencePose>();
+		PooledPose(poolIndex).PoseChangedHandler.BindRaw(this, &FAlignmentManager::OnPinnedPoseChanged);
+		return poolIndex;
 	}
 
 	/// <summary>
-	/// Add to queue for being saved to database next chance.
+	/// Add a pose from the pool to the alignment anchors, to be sent with the next SendAlignmentAnchors.
 	/// </summary>
-	void FAlignmentManager::QueueForSave(FReferencePose refPose)
+	void FAlignmentManager::AddPose(int poolIndex)
 	{
-		for (int i = 0; i < referencePosesToSave.Num(); i++)
+		const FReferencePose& refPose = PooledPose(poolIndex);
+		posePool[poolIndex].added = true;
+		addedPoses.Add(refPose.anchorId, poolIndex);
+		addedPosesByName.Add(refPose.name, poolIndex);
+	}
+
+	/// <summary>
+	/// Remove a pose from the alignment anchors. It stays in the pool for as long as it is still sent.
+	/// </summary>
+	void FAlignmentManager::RemovePose(int poolIndex)
+	{
+		const FReferencePose& refPose = PooledPose(poolIndex);
+		addedPoses.Remove(refPose.anchorId);
+		const int* namedIndex = addedPosesByName.Find(refPose.name);
+		if (namedIndex != nullptr && *namedIndex == poolIndex)
 		{
-			if (referencePosesToSave[i].anchorId == refPose.anchorId)
-			{
-				// refPose is already queued for save.
-				return;
-			}
+			addedPosesByName.Remove(refPose.name);
+		}
+		posesToSave.Remove(poolIndex);
+		posePool[poolIndex].added = false;
+		FreePoseIfUnused(poolIndex);
+	}
+
+	/// <summary>
+	/// Let go of a pose which is neither added nor sent any more, releasing its attachment point.
+	/// </summary>
+	void FAlignmentManager::FreePoseIfUnused(int poolIndex)
+	{
+		FPooledPose& pooled = posePool[poolIndex];
+		if (!pooled.added && !pooled.sent)
+		{
+			pooled.pose->Release();
+			posePool.RemoveAt(poolIndex);
 		}
-		
-		referencePosesToSave.Add(refPose);
 	}
 
 	/// <summary>
@@ -458,31 +860,24 @@ namespace WorldLockingTools
 	/// <returns>AnchorId of restored Alignment Anchor on success, else AnchorId.Invalid.</returns>
 	FrozenWorld_AnchorId FAlignmentManager::RestoreAlignmentAnchor(FString uniqueName, FTransform virtualPose)
 	{
-		FReferencePose refPose;
-		if (!poseDB.Get(uniqueName, refPose))
+		FName name(*uniqueName);
+		int poolIndex = AllocatePose();
+		if (!poseDB.Get(name, PooledPose(poolIndex)))
 		{
+			posePool.RemoveAt(poolIndex);
 			return FrozenWorld_AnchorId_INVALID;
 		}
-		
-		bool referencePoseUpdated = false;
-		for (int index = 0; index < referencePoses.Num(); index++)
-		{
-			if (referencePoses[index].name == uniqueName)
-			{
-				/// The reference pose already exists. Update it by replacing it
-				/// with the new refpose using same anchor id.
-				refPose.anchorId = referencePoses[index].anchorId;
-				referencePoses[index] = refPose;
-
-				referencePoseUpdated = true;
-				break;
-			}
-		}
+		FReferencePose& refPose = PooledPose(poolIndex);
 
-		if (!referencePoseUpdated)
+		if (const int* existing = addedPosesByName.Find(name))
 		{
-			referencePoses.Add(refPose);
+			/// The reference pose already exists. Update it by replacing it
+			/// with the new refpose using same anchor id.
+			int existingIndex = *existing;
+			refPose.anchorId = PooledPose(existingIndex).anchorId;
+			RemovePose(existingIndex);
 		}
+		AddPose(poolIndex);
 
 		/// If the referencePose has an invalid fragment id, it's only because there isn't a valid
 		/// fragment right now. Flag the condition and set the proper fragment id when there is
@@ -517,7 +912,7 @@ namespace WorldLockingTools
 
 		for (auto keyVal : data)
 		{
-			FString key = keyVal.Key;
+			FString key = keyVal.Key.ToString();
 			FStringView keyView = FStringView(key);
 			FTCHARToUTF8 UTF8String(keyView.GetData(), keyView.Len());
 
@@ -566,7 +961,7 @@ namespace WorldLockingTools
 				TArray<UTF8CHAR> nameData;
 				nameData.AddDefaulted(nameLen + 1);
 				FileHandle->Read((uint8*)&nameData[0], nameLen);
-				FString name = FString(UTF8_TO_TCHAR(&nameData[0]));
+				FName name = FName(UTF8_TO_TCHAR(&nameData[0]));
 
 				Element elem = Element::Read(FileHandle);
 				data.Add(name, elem);
@@ -587,14 +982,15 @@ namespace WorldLockingTools
 	/// </summary>
 	/// <param name="uniqueName">Unique name for the reference point.</param>
 	/// <returns>A valid reference point if found, else null.</returns>
-	bool FReferencePoseDB::Get(FString uniqueName, FReferencePose& outRefPose)
+	bool FReferencePoseDB::Get(FName uniqueName, FReferencePose& outRefPose)
 	{
-		if (!data.Contains(uniqueName))
+		const Element* found = data.Find(uniqueName);
+		if (found == nullptr)
 		{
 			return false;
 		}
 
-		Element src = data[uniqueName];
+		Element src = *found;
 		outRefPose.name = uniqueName;
 		outRefPose.fragmentId = FFragmentManager::Get()->GetCurrentFragmentId();
 		outRefPose.anchorId = FAlignmentManager::Get()->ClaimAnchorId();
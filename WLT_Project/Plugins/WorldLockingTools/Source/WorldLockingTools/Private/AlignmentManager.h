@@ -16,18 +16,6 @@
 
 namespace WorldLockingTools
 {
-	/// <summary>
-	/// The final pose with a single weight.
-	/// 
-	/// Note that this weight is not normalized in the sense of the weights summing to one,
-	/// as this would not be helpful where they are actually used.
-	/// </summary>
-	struct WeightedPose
-	{
-		FTransform pose;
-		float weight;
-	};
-
 	/// <summary>
 	/// A pose (possibly) contributing to the global camera alignment pose.
 	/// 
@@ -44,7 +32,7 @@ namespace WorldLockingTools
 		/// <summary>
 		///  The world locked space pose.
 		/// </summary>
-		FTransform LockedPose()
+		FTransform LockedPose() const
 		{
 			return lockedPose;
 		}
@@ -59,20 +47,25 @@ namespace WorldLockingTools
 		/// <summary>
 		/// Whether this reference pose should contribute now.
 		/// </summary>
-		bool IsActive(FrozenWorld_FragmentId CurrentFragmentId)
+		bool IsActive(FrozenWorld_FragmentId CurrentFragmentId) const
 		{
 			return fragmentId == CurrentFragmentId;
 		}
 
+		void Release();
+
 	public:
-		FString name;
+		FName name;
 		FrozenWorld_FragmentId fragmentId;
 		FrozenWorld_AnchorId anchorId;
 
+		/// Called whenever the locked pose changes, whether set or adjusted by a refit.
+		FSimpleDelegate PoseChangedHandler;
+
 	private:
 		FTransform lockedPose;
 
-		TSharedPtr<FAttachmentPoint> AttachmentPoint = nullptr;
+		FAttachmentPointHandle AttachmentPoint;
 		FAttachmentPoint::FAdjustLocationDelegate LocationHandler;
 
 	private:
@@ -82,7 +75,7 @@ namespace WorldLockingTools
 
 		void AfterAdjustmentPoseChanged()
 		{
-			/// Do any adjustment pose dependent caching here.
+			PoseChangedHandler.ExecuteIfBound();
 		}
 	};
 
@@ -114,29 +107,21 @@ namespace WorldLockingTools
 		/// </summary>
 		/// <param name="refPose">The reference pose to add/update to the database.</param>
 		/// <returns>True on success.</returns>
-		bool Set(FReferencePose refPose)
-		{
-			Element elem{ refPose.virtualPose, refPose.LockedPose() };
-			if (!data.Contains(refPose.name))
-			{
-				data.Add(refPose.name, elem);
-			}
-			else
-			{
-				data[refPose.name] = elem;
-			}
+		bool Set(const FReferencePose& refPose)
+		{
+			data.Add(refPose.name, Element{ refPose.virtualPose, refPose.LockedPose() });
 
 			return true;
 		}
 
-		bool Get(FString uniqueName, FReferencePose& outRefPose);
+		bool Get(FName uniqueName, FReferencePose& outRefPose);
 
 		/// <summary>
 		/// Delete an element from the database.
 		/// </summary>
 		/// <param name="uniqueName">The name of the element to delete.</param>
 		/// <returns>True if the element was in the database prior to deletion.</returns>
-		void Forget(FString uniqueName)
+		void Forget(FName uniqueName)
 		{
 			data.Remove(uniqueName);
 		}
@@ -155,7 +140,7 @@ namespace WorldLockingTools
 	private:
 		// current database version.
 		uint32 version = 1;
-		TMap<FString, Element> data;
+		TMap<FName, Element> data;
 
 		bool IsLoaded = false;
 	};
@@ -193,6 +178,7 @@ namespace WorldLockingTools
 
 	public:
 		void ComputePinnedPose(FTransform lockedHeadPose);
+		void ComputePinnedPoses(TArrayView<const FVector> lockedPositions, TArrayView<FTransform> outPinnedFromLocked, int batchSize = 0);
 
 	public:
 		FTransform PinnedFromLocked;
@@ -202,18 +188,41 @@ namespace WorldLockingTools
 		void CheckSend();
 		void CheckFragment();
 
-		TArray<WeightedPose> ComputePoseWeights(FVector lockedHeadPosition);
-		FTransform WeightedAverage(TArray<WeightedPose> poses);
-		WeightedPose WeightedAverage(WeightedPose lhs, WeightedPose rhs);
-		FTransform ComputePinnedFromLocked(FReferencePose refPose);
+		FTransform ComputePinnedFromLocked(const FReferencePose& refPose);
+		FTransform BlendPinnedPoses(const Interpolant& bary) const;
+		FQuat AverageRotations(TArrayView<const FQuat> rotations, TArrayView<const float> weights) const;
+		void CachePinnedPoses();
+		void OnPinnedPoseChanged()
+		{
+			pinnedPosesDirty = true;
+		}
 		void PerformSendAlignmentAnchors();
 		void ActivateCurrentFragment();
 		void BuildTriangulation();
+		bool UpdateTriangulation(const TArray<int>& newActivePoses);
 		void InitTriangulator();
+		void InitTriangulator(FTriangulator& levelTriangulator) const;
+
+		void BuildLevels();
+		double LevelBoundary(int levelIndex) const;
+		FTransform ComputeLevelsPose(FVector lockedPosition, TArrayView<int> hints) const;
+		FTransform ComputeLevelPose(int levelIndex, FVector lockedPosition, int& hint) const;
+
+		int AllocatePose();
+		void AddPose(int poolIndex);
+		void RemovePose(int poolIndex);
+		void FreePoseIfUnused(int poolIndex);
+
+		FReferencePose& PooledPose(int poolIndex) const
+		{
+			return *posePool[poolIndex].pose;
+		}
 
 	public:
 		void ClearAlignmentAnchors();
 		void SendAlignmentAnchors();
+		void BeginTransaction();
+		void CommitTransaction();
 		FrozenWorld_AnchorId AddAlignmentAnchor(FString uniqueName, FTransform virtualPose, FTransform lockedPose);
 		bool GetAlignmentPose(FrozenWorld_AnchorId AnchorID, FTransform& outLockedPose);
 		bool RemoveAlignmentAnchor(FrozenWorld_AnchorId AnchorID);
@@ -221,6 +230,35 @@ namespace WorldLockingTools
 		bool Save();
 		bool Load();
 		FrozenWorld_AnchorId RestoreAlignmentAnchor(FString uniqueName, FTransform virtualPose);
+
+		/// <summary>
+		/// Triangulate the pins Delaunay, with exact predicates, rather than by flipping long edges.
+		/// </summary>
+		void SetDelaunayTriangulation(bool delaunay);
+
+		/// <summary>
+		/// Align by the pins of each level, such as each floor of a building, separately from the others.
+		/// Pins are on different levels where their locked heights are more than separation apart, and the alignment
+		/// blends from one level to the next over blendHeight, halfway between them. Zero or negative separation
+		/// aligns by all the pins together.
+		/// </summary>
+		void SetAlignmentLevels(float separation, float blendHeight);
+		float GetAlignmentLevelSeparation() const
+		{
+			return levelSeparation;
+		}
+		float GetAlignmentLevelBlendHeight() const
+		{
+			return levelBlendHeight;
+		}
+
+		/// <summary>
+		/// Average the pins' rotations as the eigenvector of their outer products, rather than by normalizing their sum.
+		/// </summary>
+		void SetEigenRotationAveraging(bool eigen)
+		{
+			eigenRotationAveraging = eigen;
+		}
 		
 		FrozenWorld_AnchorId ClaimAnchorId()
 		{
@@ -228,11 +266,34 @@ namespace WorldLockingTools
 		}
 
 	private:
-		TArray<FReferencePose> referencePoses;
-		TArray<FReferencePose> sentPoses;
-		TArray<FReferencePose> activePoses;
-		TArray<WeightedPose> weightedPoses;
-		TArray<FReferencePose> referencePosesToSave;
+		/// <summary>
+		/// A reference pose in the pool, which stays there while it is added or sent.
+		/// </summary>
+		struct FPooledPose
+		{
+			/// Allocated by itself, as its attachment point calls back into it wherever the pool moves it to.
+			TUniquePtr<FReferencePose> pose;
+			/// Added and not removed since.
+			bool added = false;
+			/// Among the poses last sent.
+			bool sent = false;
+		};
+
+		/// Every reference pose, referred to everywhere else by its index here.
+		TSparseArray<FPooledPose> posePool;
+		/// Pool indices of the poses added and not removed since, by anchor id and by name.
+		TMap<FrozenWorld_AnchorId, int> addedPoses;
+		TMap<FName, int> addedPosesByName;
+		/// Pool indices of the poses last sent, and of those among them in the active fragment.
+		TArray<int> sentPoses;
+		TArray<int> activePoses;
+		/// PinnedFromLocked of each active pose, split into position and rotation, computed when the active poses change.
+		TArray<FVector> pinnedPositions;
+		TArray<FQuat> pinnedRotations;
+		/// Whether a pose's locked pose changed since the above were computed, as when a refit adjusts it.
+		bool pinnedPosesDirty = false;
+		/// Pool indices of the poses waiting to be saved.
+		TSet<int> posesToSave;
 
 		FrozenWorld_FragmentId activeFragmentId = FrozenWorld_FragmentId_UNKNOWN;
 		FrozenWorld_AnchorId nextAnchorId = FrozenWorld_AnchorId_INVALID + 1;
@@ -240,10 +301,58 @@ namespace WorldLockingTools
 		bool needSave = false;
 		bool needSend = false;
 		bool needFragment = false;
+		/// Number of transactions begun and not yet committed, and whether a send was asked for during them.
+		int transactionDepth = 0;
+		bool sendOnCommit = false;
+		bool eigenRotationAveraging = false;
 		FReferencePoseDB poseDB;
 
 		FTriangulator triangulator;
 
-		void QueueForSave(FReferencePose refPose);
+		/// <summary>
+		/// The pins at one level, such as a floor of a building, triangulated by themselves.
+		/// </summary>
+		struct FAlignmentLevel
+		{
+			/// Locked heights of the lowest and highest pins.
+			double minHeight = 0;
+			double maxHeight = 0;
+			/// Pool indices of the pins, in the order of the triangulator's vertices.
+			TArray<int> poses;
+			/// Indices into activePoses of the same pins.
+			TArray<int> activeIndices;
+			FTriangulator triangulator;
+		};
+
+		/// Levels of the active poses from the lowest up, or none to triangulate all of them together.
+		TArray<FAlignmentLevel> levels;
+		/// The triangle each level's lookups for ComputePinnedPose last ended in.
+		TArray<int> levelHints;
+		/// Height between pins from which they are on different levels, zero or negative for no levels.
+		float levelSeparation = 0.0f;
+		/// Height over which the alignment blends from one level to the next.
+		float levelBlendHeight = 0.0f;
+	};
+
+	/// <summary>
+	/// A transaction on the alignment manager for the lifetime of this object, begun on construction and committed on destruction.
+	/// </summary>
+	class FScopedAlignmentTransaction
+	{
+	public:
+		explicit FScopedAlignmentTransaction(FAlignmentManager* alignmentManager)
+			: alignmentManager(alignmentManager)
+		{
+			alignmentManager->BeginTransaction();
+		}
+		~FScopedAlignmentTransaction()
+		{
+			alignmentManager->CommitTransaction();
+		}
+		FScopedAlignmentTransaction(const FScopedAlignmentTransaction&) = delete;
+		FScopedAlignmentTransaction& operator=(const FScopedAlignmentTransaction&) = delete;
+
+	private:
+		FAlignmentManager* alignmentManager;
 	};
 }
\ No newline at end of file
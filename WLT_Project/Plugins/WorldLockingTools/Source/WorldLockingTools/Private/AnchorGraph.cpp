@@ -0,0 +1,281 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "AnchorGraph.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Forget all anchors and edges.
+	/// </summary>
+	void FAnchorGraph::Reset()
+	{
+		cells.Empty();
+		positions.Empty();
+		adjacency.Empty();
+	}
+
+	/// <summary>
+	/// Set the size of the grid cells, and rebucket any existing anchors.
+	/// 
+	/// Queries are cheapest when the cell size is close to the typical query radius.
+	/// </summary>
+	void FAnchorGraph::SetCellSize(float InCellSize)
+	{
+		InCellSize = FMath::Max(InCellSize, 1.0f);
+		if (InCellSize == cellSize)
+		{
+			return;
+		}
+
+		cellSize = InCellSize;
+		cells.Empty();
+		for (const auto& entry : positions)
+		{
+			AddToCell(entry.Key, entry.Value);
+		}
+	}
+
+	void FAnchorGraph::AddAnchor(FrozenWorld_AnchorId id, FVector position)
+	{
+		if (positions.Contains(id))
+		{
+			UpdateAnchor(id, position);
+			return;
+		}
+
+		positions.Add(id, position);
+		AddToCell(id, position);
+	}
+
+	void FAnchorGraph::UpdateAnchor(FrozenWorld_AnchorId id, FVector position)
+	{
+		FVector* oldPosition = positions.Find(id);
+		if (oldPosition == nullptr)
+		{
+			return;
+		}
+
+		if (CellOf(*oldPosition) != CellOf(position))
+		{
+			RemoveFromCell(id, *oldPosition);
+			AddToCell(id, position);
+		}
+		*oldPosition = position;
+	}
+
+	/// <summary>
+	/// Remove an anchor along with all of its edges.
+	/// </summary>
+	void FAnchorGraph::RemoveAnchor(FrozenWorld_AnchorId id)
+	{
+		FVector position;
+		if (positions.RemoveAndCopyValue(id, position))
+		{
+			RemoveFromCell(id, position);
+		}
+
+		TArray<FrozenWorld_AnchorId> neighbors;
+		if (adjacency.RemoveAndCopyValue(id, neighbors))
+		{
+			for (const auto& neighbor : neighbors)
+			{
+				if (TArray<FrozenWorld_AnchorId>* neighborEdges = adjacency.Find(neighbor))
+				{
+					neighborEdges->RemoveSwap(id);
+				}
+			}
+		}
+	}
+
+	bool FAnchorGraph::GetPosition(FrozenWorld_AnchorId id, FVector& outPosition) const
+	{
+		const FVector* position = positions.Find(id);
+		if (position == nullptr)
+		{
+			return false;
+		}
+		outPosition = *position;
+		return true;
+	}
+
+	TArray<FrozenWorld_AnchorId> FAnchorGraph::GetAnchorIds() const
+	{
+		TArray<FrozenWorld_AnchorId> ids;
+		positions.GetKeys(ids);
+		return ids;
+	}
+
+	/// <summary>
+	/// Merge the given edges into the mirrored adjacency.
+	/// Edges referring to anchors unknown to the graph are kept, they are harmless and
+	/// the anchor may be added later.
+	/// </summary>
+	void FAnchorGraph::AddEdges(const TArray<FrozenWorld_Edge>& edges)
+	{
+		for (const auto& edge : edges)
+		{
+			AddEdge(edge.anchorId1, edge.anchorId2);
+		}
+	}
+
+	void FAnchorGraph::AddEdge(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2)
+	{
+		if (id1 == id2)
+		{
+			return;
+		}
+		adjacency.FindOrAdd(id1).AddUnique(id2);
+		adjacency.FindOrAdd(id2).AddUnique(id1);
+	}
+
+	void FAnchorGraph::RemoveEdge(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2)
+	{
+		if (TArray<FrozenWorld_AnchorId>* edges1 = adjacency.Find(id1))
+		{
+			edges1->RemoveSwap(id2);
+		}
+		if (TArray<FrozenWorld_AnchorId>* edges2 = adjacency.Find(id2))
+		{
+			edges2->RemoveSwap(id1);
+		}
+	}
+
+	bool FAnchorGraph::HasEdge(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2) const
+	{
+		const TArray<FrozenWorld_AnchorId>* edges1 = adjacency.Find(id1);
+		return edges1 != nullptr && edges1->Contains(id2);
+	}
+
+	/// <summary>
+	/// Whether the two anchors have a neighbor in common, in which case the edge between them
+	/// (if any) can be removed without disconnecting them.
+	/// </summary>
+	bool FAnchorGraph::SharesNeighbor(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2) const
+	{
+		const TArray<FrozenWorld_AnchorId>* edges1 = adjacency.Find(id1);
+		const TArray<FrozenWorld_AnchorId>* edges2 = adjacency.Find(id2);
+		if (edges1 == nullptr || edges2 == nullptr)
+		{
+			return false;
+		}
+
+		for (const auto& neighbor : *edges1)
+		{
+			if (neighbor != id2 && edges2->Contains(neighbor))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int FAnchorGraph::Degree(FrozenWorld_AnchorId id) const
+	{
+		const TArray<FrozenWorld_AnchorId>* edges = adjacency.Find(id);
+		return edges != nullptr ? edges->Num() : 0;
+	}
+
+	TArray<FrozenWorld_AnchorId> FAnchorGraph::GetNeighbors(FrozenWorld_AnchorId id) const
+	{
+		const TArray<FrozenWorld_AnchorId>* edges = adjacency.Find(id);
+		return edges != nullptr ? *edges : TArray<FrozenWorld_AnchorId>();
+	}
+
+	/// <summary>
+	/// Find up to maxCount anchors within maxDistance of the position, nearest first.
+	/// </summary>
+	/// <param name="position">Query position in spongy space.</param>
+	/// <param name="maxCount">Maximum number of anchors to return.</param>
+	/// <param name="maxDistance">Anchors further than this are ignored.</param>
+	/// <param name="filter">Only anchors for which this returns true are considered.</param>
+	/// <returns>The anchor ids, sorted nearest first.</returns>
+	TArray<FrozenWorld_AnchorId> FAnchorGraph::FindNearest(FVector position, int maxCount, float maxDistance,
+		TFunctionRef<bool(FrozenWorld_AnchorId)> filter) const
+	{
+		struct FCandidate
+		{
+			FrozenWorld_AnchorId id;
+			double distSqr;
+		};
+
+		if (maxCount <= 0)
+		{
+			return TArray<FrozenWorld_AnchorId>();
+		}
+
+		TArray<FCandidate> candidates;
+		double maxDistSqr = (double)maxDistance * maxDistance;
+		int range = FMath::CeilToInt(maxDistance / cellSize);
+		FIntVector center = CellOf(position);
+		for (int x = -range; x <= range; ++x)
+		{
+			for (int y = -range; y <= range; ++y)
+			{
+				for (int z = -range; z <= range; ++z)
+				{
+					const TArray<FrozenWorld_AnchorId>* cell = cells.Find(center + FIntVector(x, y, z));
+					if (cell == nullptr)
+					{
+						continue;
+					}
+
+					for (const auto& id : *cell)
+					{
+						double distSqr = (positions[id] - position).SquaredLength();
+						if (distSqr <= maxDistSqr && filter(id))
+						{
+							candidates.Add(FCandidate{ id, distSqr });
+						}
+					}
+				}
+			}
+		}
+
+		candidates.Sort([](const FCandidate& lhs, const FCandidate& rhs)
+		{
+			return lhs.distSqr < rhs.distSqr;
+		});
+
+		TArray<FrozenWorld_AnchorId> nearest;
+		for (int i = 0; i < candidates.Num() && i < maxCount; ++i)
+		{
+			nearest.Add(candidates[i].id);
+		}
+		return nearest;
+	}
+
+	/// <summary>
+	/// Find all anchors within radius of the position, nearest first.
+	/// </summary>
+	TArray<FrozenWorld_AnchorId> FAnchorGraph::FindInRadius(FVector position, float radius) const
+	{
+		return FindNearest(position, positions.Num(), radius, [](FrozenWorld_AnchorId) { return true; });
+	}
+
+	FIntVector FAnchorGraph::CellOf(FVector position) const
+	{
+		return FIntVector(
+			FMath::FloorToInt(position.X / cellSize),
+			FMath::FloorToInt(position.Y / cellSize),
+			FMath::FloorToInt(position.Z / cellSize));
+	}
+
+	void FAnchorGraph::AddToCell(FrozenWorld_AnchorId id, FVector position)
+	{
+		cells.FindOrAdd(CellOf(position)).Add(id);
+	}
+
+	void FAnchorGraph::RemoveFromCell(FrozenWorld_AnchorId id, FVector position)
+	{
+		FIntVector cellKey = CellOf(position);
+		if (TArray<FrozenWorld_AnchorId>* cell = cells.Find(cellKey))
+		{
+			cell->RemoveSwap(id);
+			if (cell->Num() == 0)
+			{
+				cells.Remove(cellKey);
+			}
+		}
+	}
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#pragma warning(push)
+#pragma warning(disable: 4996)
+#include "FrozenWorldEngine.h"
+#pragma warning(pop)
+
+#include "CoreMinimal.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Client side mirror of the spongy anchor graph.
+	/// 
+	/// Anchor positions are bucketed in a uniform grid, so that the anchors near a position can be found
+	/// without visiting every anchor. The adjacency is a mirror of the edges known to the FrozenWorld engine,
+	/// used to keep the number of edges per anchor bounded.
+	/// Positions are in spongy (tracking) space, and are only refreshed when an anchor is added or revisited,
+	/// which is accurate enough for neighborhood queries at the scale of the grid cells.
+	/// </summary>
+	class FAnchorGraph
+	{
+	public:
+		void Reset();
+
+		void SetCellSize(float InCellSize);
+
+		void AddAnchor(FrozenWorld_AnchorId id, FVector position);
+		void UpdateAnchor(FrozenWorld_AnchorId id, FVector position);
+		void RemoveAnchor(FrozenWorld_AnchorId id);
+
+		bool Contains(FrozenWorld_AnchorId id) const
+		{
+			return positions.Contains(id);
+		}
+
+		bool GetPosition(FrozenWorld_AnchorId id, FVector& outPosition) const;
+
+		int Num() const
+		{
+			return positions.Num();
+		}
+
+		TArray<FrozenWorld_AnchorId> GetAnchorIds() const;
+
+		void AddEdges(const TArray<FrozenWorld_Edge>& edges);
+		void AddEdge(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2);
+		void RemoveEdge(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2);
+		bool HasEdge(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2) const;
+		bool SharesNeighbor(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2) const;
+		int Degree(FrozenWorld_AnchorId id) const;
+		TArray<FrozenWorld_AnchorId> GetNeighbors(FrozenWorld_AnchorId id) const;
+
+		TArray<FrozenWorld_AnchorId> FindNearest(FVector position, int maxCount, float maxDistance,
+			TFunctionRef<bool(FrozenWorld_AnchorId)> filter) const;
+
+		TArray<FrozenWorld_AnchorId> FindInRadius(FVector position, float radius) const;
+
+	private:
+		FIntVector CellOf(FVector position) const;
+
+		void AddToCell(FrozenWorld_AnchorId id, FVector position);
+		void RemoveFromCell(FrozenWorld_AnchorId id, FVector position);
+
+	private:
+		float cellSize = 120.0f;
+
+		TMap<FIntVector, TArray<FrozenWorld_AnchorId>> cells;
+		TMap<FrozenWorld_AnchorId, FVector> positions;
+		TMap<FrozenWorld_AnchorId, TArray<FrozenWorld_AnchorId>> adjacency;
+	};
+}
@@ -10,6 +10,7 @@
 #include "Async/Async.h"
 
 #include "FrozenWorldPlugin.h"
+#include "FrozenWorldPoseExtensions.h"
 #include "WorldLockingToolsModule.h"
 
 namespace WorldLockingTools
@@ -18,6 +19,7 @@ namespace WorldLockingTools
 	{
 		lastAnchorAddTime = std::numeric_limits<float>::min();
 		lastTrackingInactiveTime = std::numeric_limits<float>::min();
+		lastConsolidationTime = std::numeric_limits<float>::min();
 	}
 
 	/// <summary>
@@ -40,19 +42,340 @@ namespace WorldLockingTools
 		}
 	}
 
+	/// <summary>
+	/// Collapse clusters of nearly coincident anchors into a single representative anchor.
+	/// 
+	/// A tracked anchor joins the cluster of a representative within AnchorConsolidationDistance if its spongy and frozen
+	/// distances to the representative, and to the cluster's other members, differ by at most AnchorConsolidationTolerance,
+	/// i.e. tracking and the frozen world agree on their relative placement. The best connected anchors are picked as representatives.
+	/// Edges of removed anchors are moved over to the representative, and attachment points on them are moved to the representative
+	/// without changing their frozen position.
+	/// </summary>
+	void FAnchorManager::ConsolidateAnchors()
+	{
+		if (AnchorConsolidationDistance <= 0
+			|| RestoreState != ERestoreState::Idle
+			|| GWorld->RealTimeSeconds < lastConsolidationTime + AnchorConsolidationInterval)
+		{
+			return;
+		}
+		lastConsolidationTime = GWorld->RealTimeSeconds;
+
+		double startTime = FPlatformTime::Seconds();
+
+		TMap<FrozenWorld_AnchorId, FrozenWorld_Anchor> frozenAnchors;
+		for (const auto& anchor : FFrozenWorldPlugin::Get()->GetFrozenAnchors())
+		{
+			frozenAnchors.Add(anchor.anchorId, anchor);
+		}
+
+		TMap<FrozenWorld_AnchorId, UARPin*> trackedAnchors;
+		TMap<FrozenWorld_AnchorId, FVector> spongyPositions;
+		for (const auto& entry : SpongyAnchors)
+		{
+			if (entry.SpongyAnchor->GetTrackingState() == EARTrackingState::Tracking && frozenAnchors.Contains(entry.AnchorId))
+			{
+				FVector position = entry.SpongyAnchor->GetLocalToTrackingTransform().GetLocation();
+				trackedAnchors.Add(entry.AnchorId, entry.SpongyAnchor);
+				spongyPositions.Add(entry.AnchorId, position);
+				AnchorGraph.UpdateAnchor(entry.AnchorId, position);
+			}
+		}
+
+		auto EdgeKey = [](FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2)
+		{
+			return id1 < id2 ? MakeTuple(id1, id2) : MakeTuple(id2, id1);
+		};
+
+		TMap<FrozenWorld_AnchorId, TArray<FrozenWorld_AnchorId>> frozenNeighbors;
+		TSet<TTuple<FrozenWorld_AnchorId, FrozenWorld_AnchorId>> knownEdges;
+		for (const auto& edge : FFrozenWorldPlugin::Get()->GetFrozenEdges())
+		{
+			frozenNeighbors.FindOrAdd(edge.anchorId1).AddUnique(edge.anchorId2);
+			frozenNeighbors.FindOrAdd(edge.anchorId2).AddUnique(edge.anchorId1);
+			knownEdges.Add(EdgeKey(edge.anchorId1, edge.anchorId2));
+		}
+
+		TArray<FrozenWorld_AnchorId> candidates;
+		spongyPositions.GenerateKeyArray(candidates);
+		candidates.Sort([&frozenNeighbors](FrozenWorld_AnchorId lhs, FrozenWorld_AnchorId rhs)
+		{
+			const TArray<FrozenWorld_AnchorId>* lhsNeighbors = frozenNeighbors.Find(lhs);
+			const TArray<FrozenWorld_AnchorId>* rhsNeighbors = frozenNeighbors.Find(rhs);
+			int lhsDegree = lhsNeighbors != nullptr ? lhsNeighbors->Num() : 0;
+			int rhsDegree = rhsNeighbors != nullptr ? rhsNeighbors->Num() : 0;
+			return lhsDegree != rhsDegree ? lhsDegree > rhsDegree : lhs < rhs;
+		});
+
+		auto ConsolidationError = [&spongyPositions, &frozenAnchors](FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2)
+		{
+			double spongyDistance = FVector::Dist(spongyPositions[id1], spongyPositions[id2]);
+			double frozenDistance = FVector::Dist(
+				FFrozenWorldInterop::FtoU(frozenAnchors[id1].transform.position),
+				FFrozenWorldInterop::FtoU(frozenAnchors[id2].transform.position));
+			return (float)FMath::Abs(spongyDistance - frozenDistance);
+		};
+
+		TSet<FrozenWorld_AnchorId> assigned;
+		// Each removed anchor, mapped to the representative it was consolidated into.
+		TMap<FrozenWorld_AnchorId, FrozenWorld_AnchorId> removed;
+		TArray<FrozenWorld_Edge> movedEdges;
+		float maxError = 0.0f;
+		for (const auto& representative : candidates)
+		{
+			if (assigned.Contains(representative))
+			{
+				continue;
+			}
+			assigned.Add(representative);
+
+			TArray<FrozenWorld_AnchorId> members;
+			for (const auto& candidate : AnchorGraph.FindInRadius(spongyPositions[representative], AnchorConsolidationDistance))
+			{
+				if (assigned.Contains(candidate)
+					|| !spongyPositions.Contains(candidate)
+					|| frozenAnchors[candidate].fragmentId != frozenAnchors[representative].fragmentId)
+				{
+					continue;
+				}
+
+				float error = ConsolidationError(candidate, representative);
+				bool consistent = error <= AnchorConsolidationTolerance;
+				for (int i = 0; consistent && i < members.Num(); ++i)
+				{
+					consistent = ConsolidationError(candidate, members[i]) <= AnchorConsolidationTolerance;
+				}
+
+				if (consistent)
+				{
+					members.Add(candidate);
+					maxError = FMath::Max(maxError, error);
+				}
+			}
+
+			if (members.Num() == 0)
+			{
+				continue;
+			}
+
+			assigned.Append(members);
+			anchorConsolidationStats.NumClustersCollapsed++;
+
+			FTransform representativeFromLocked = FFrozenWorldPoseExtensions::Inverse(FFrozenWorldInterop::FtoU(frozenAnchors[representative].transform));
+			for (const auto& member : members)
+			{
+				for (const auto& neighbor : frozenNeighbors.FindRef(member))
+				{
+					if (neighbor != representative && !members.Contains(neighbor) && !frozenNeighbors.FindOrAdd(representative).Contains(neighbor))
+					{
+						movedEdges.Add(FrozenWorld_Edge{ representative, neighbor });
+						frozenNeighbors.FindOrAdd(representative).Add(neighbor);
+						frozenNeighbors.FindOrAdd(neighbor).Add(representative);
+					}
+				}
+
+				FFragmentManager::Get()->ReassignAnchor(member, representative,
+					FFrozenWorldPoseExtensions::Multiply(representativeFromLocked, FFrozenWorldInterop::FtoU(frozenAnchors[member].transform)));
+
+				if (NewAnchorNeighbors.Remove(member) > 0)
+				{
+					NewAnchorNeighbors.AddUnique(representative);
+				}
+
+				DestroyAnchor(member, trackedAnchors[member]);
+				removed.Add(member, representative);
+			}
+		}
+
+		// Edges moved to an anchor that was itself removed later in the pass move on to its representative.
+		// Only edges that end up on a single anchor, or duplicate another edge, are dropped.
+		auto Surviving = [&removed](FrozenWorld_AnchorId id)
+		{
+			while (const FrozenWorld_AnchorId* representative = removed.Find(id))
+			{
+				id = *representative;
+			}
+			return id;
+		};
+
+		TArray<FrozenWorld_Edge> survivingEdges;
+		for (const auto& edge : movedEdges)
+		{
+			FrozenWorld_AnchorId id1 = Surviving(edge.anchorId1);
+			FrozenWorld_AnchorId id2 = Surviving(edge.anchorId2);
+			bool alreadyKnown = false;
+			knownEdges.Add(EdgeKey(id1, id2), &alreadyKnown);
+			if (id1 != id2 && !alreadyKnown)
+			{
+				survivingEdges.Add(FrozenWorld_Edge{ id1, id2 });
+			}
+		}
+		FFrozenWorldPlugin::Get()->AddFrozenEdges(survivingEdges);
+		for (const auto& edge : survivingEdges)
+		{
+			AnchorGraph.AddEdge(edge.anchorId1, edge.anchorId2);
+		}
+
+		anchorConsolidationStats.NumPasses++;
+		anchorConsolidationStats.NumAnchorsRemoved += removed.Num();
+		anchorConsolidationStats.NumActiveAnchors = spongyPositions.Num() - removed.Num();
+		anchorConsolidationStats.NumVisualSupports = FFrozenWorldPlugin::Get()->GetMetrics().numVisualSupports;
+		anchorConsolidationStats.MaxConsolidationError = maxError;
+		anchorConsolidationStats.LastPassMicroseconds = (float)((FPlatformTime::Seconds() - startTime) * 1000000.0);
+
+		if (removed.Num() > 0)
+		{
+			UE_LOG(LogWLT, Log, TEXT("Consolidated %d anchors, %d tracked anchors left"), removed.Num(), anchorConsolidationStats.NumActiveAnchors);
+		}
+	}
+
+	/// <summary>
+	/// Advance the background repair of the anchor graph by up to MaxGraphRepairsPerFrame anchors.
+	/// 
+	/// Each pass starts by merging the engine's frozen edges into the mirrored graph, and asking
+	/// the engine for edges that would reconnect parts of the graph it considers disconnected.
+	/// It then visits each anchor once, connecting it to its nearest neighbors and dropping
+	/// edges above the per-anchor limit that are not needed to keep the graph connected.
+	/// Only anchors currently tracked are touched, since edges are fed to the engine through the spongy snapshot.
+	/// </summary>
+	/// <param name="activeIds">Anchors in this frame's spongy snapshot.</param>
+	/// <param name="OutNewEdges">List that will have new edges appended by this routine</param>
+	void FAnchorManager::RepairGraph(const TSet<FrozenWorld_AnchorId>& activeIds, TArray<FrozenWorld_Edge>& OutNewEdges)
+	{
+		if (MaxGraphRepairsPerFrame <= 0)
+		{
+			return;
+		}
+
+		if (graphRepairQueue.Num() == 0)
+		{
+			AnchorGraph.AddEdges(FFrozenWorldPlugin::Get()->GetFrozenEdges());
+			for (const auto& edge : FFrozenWorldPlugin::Get()->GuessMissingEdges())
+			{
+				TryAddEdge(edge.anchorId1, edge.anchorId2, activeIds, OutNewEdges);
+			}
+
+			graphRepairQueue = AnchorGraph.GetAnchorIds();
+			return;
+		}
+
+		for (int i = 0; i < MaxGraphRepairsPerFrame && graphRepairQueue.Num() > 0; ++i)
+		{
+			RepairAnchor(graphRepairQueue.Pop(false), activeIds, OutNewEdges);
+		}
+	}
+
+	/// <summary>
+	/// Connect a single anchor to its nearest neighbors, and drop its redundant edges.
+	/// </summary>
+	void FAnchorManager::RepairAnchor(FrozenWorld_AnchorId id, const TSet<FrozenWorld_AnchorId>& activeIds, TArray<FrozenWorld_Edge>& OutNewEdges)
+	{
+		UARPin** Pin = anchorsByTrackableId.Find(id);
+		if (!activeIds.Contains(id) || Pin == nullptr || *Pin == nullptr)
+		{
+			return;
+		}
+
+		FVector position = (*Pin)->GetLocalToTrackingTransform().GetLocation();
+		AnchorGraph.UpdateAnchor(id, position);
+
+		TArray<FrozenWorld_AnchorId> nearest = AnchorGraph.FindNearest(position, MaxAnchorEdgesPerAnchor, MaxAnchorEdgeLength,
+			[id, &activeIds](FrozenWorld_AnchorId other)
+			{
+				return other != id && activeIds.Contains(other);
+			});
+
+		for (const auto& other : nearest)
+		{
+			TryAddEdge(id, other, activeIds, OutNewEdges);
+		}
+
+		if (AnchorGraph.Degree(id) <= MaxAnchorEdgesPerAnchor)
+		{
+			return;
+		}
+
+		// Over the limit. Drop the longest edges to anchors that aren't among the nearest,
+		// as long as both ends stay connected through a common neighbor.
+		TArray<FrozenWorld_AnchorId> neighbors = AnchorGraph.GetNeighbors(id);
+		TMap<FrozenWorld_AnchorId, double> distanceSqrById;
+		for (const auto& neighbor : neighbors)
+		{
+			FVector neighborPosition;
+			distanceSqrById.Add(neighbor, AnchorGraph.GetPosition(neighbor, neighborPosition)
+				? (neighborPosition - position).SquaredLength()
+				: std::numeric_limits<double>::max());
+		}
+		neighbors.Sort([&distanceSqrById](FrozenWorld_AnchorId lhs, FrozenWorld_AnchorId rhs)
+		{
+			return distanceSqrById[lhs] > distanceSqrById[rhs];
+		});
+
+		for (const auto& neighbor : neighbors)
+		{
+			if (AnchorGraph.Degree(id) <= MaxAnchorEdgesPerAnchor)
+			{
+				break;
+			}
+
+			if (!nearest.Contains(neighbor) && AnchorGraph.SharesNeighbor(id, neighbor))
+			{
+				FFrozenWorldPlugin::Get()->RemoveFrozenEdge(id, neighbor);
+				AnchorGraph.RemoveEdge(id, neighbor);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Add an edge between two tracked anchors, unless it exists already or either end is at its edge limit.
+	/// </summary>
+	/// <returns>True if the edge was added.</returns>
+	bool FAnchorManager::TryAddEdge(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2, const TSet<FrozenWorld_AnchorId>& activeIds, TArray<FrozenWorld_Edge>& OutNewEdges)
+	{
+		if (id1 == id2
+			|| !activeIds.Contains(id1)
+			|| !activeIds.Contains(id2)
+			|| AnchorGraph.HasEdge(id1, id2)
+			|| AnchorGraph.Degree(id1) >= MaxAnchorEdgesPerAnchor
+			|| AnchorGraph.Degree(id2) >= MaxAnchorEdgesPerAnchor)
+		{
+			return false;
+		}
+
+		OutNewEdges.Add(FrozenWorld_Edge{ id1, id2 });
+		AnchorGraph.AddEdge(id1, id2);
+		return true;
+	}
+
 	/// <summary>
 	/// Delete all spongy anchor objects and reset internal state
 	/// </summary>
 	void FAnchorManager::Reset()
 	{
+		// Pins and their scene components are released here.
+		check(IsInGameThread());
+
 		for(auto anchor : SpongyAnchors)
 		{
 			DestroyAnchor(FrozenWorld_AnchorId_INVALID, anchor.SpongyAnchor);
 		}
 		
 		SpongyAnchors.Empty();
+		anchorsByTrackableId.Empty();
 		FFrozenWorldPlugin::Get()->ClearFrozenAnchors();
 
+		AnchorGraph.Reset();
+		graphRepairQueue.Empty();
+
+		PendingRestoreIds.Empty();
+		PendingRestorePins.Empty();
+		RestoreState = ERestoreState::Idle;
+
+		RegionStore.Reset();
+		pendingRegionEdges.Empty();
+		ReleasePagedOutPins();
+		headRegionValid = false;
+
 		NewSpongyAnchor = DestroyAnchor(FrozenWorld_AnchorId_INVALID, NewSpongyAnchor);
 	}
 
@@ -67,6 +390,11 @@ namespace WorldLockingTools
 			return false;
 		}
 
+		UpdateRestore();
+
+		bool nearestNeighborEdges = AnchorEdgeMode == EAnchorEdgeMode::NearestNeighbors;
+		AnchorGraph.SetCellSize(MaxAnchorEdgeLength);
+
 		// To communicate spongyHead and spongyAnchor poses to the FrozenWorld engine, they must all be expressed
 		// in the same coordinate system. Here, we do not care where this coordinate
 		// system is defined and how it fluctuates over time, as long as it can be used to express the
@@ -90,7 +418,12 @@ namespace WorldLockingTools
 		FTransform SpongyHead = FTransform(HMDData.Rotation, HMDData.Position) * WorldToTracking;
 		FTransform NewSpongyAnchorPose = FTransform(SpongyHead.GetLocation());
 
+		// Anchors are paged by their frozen position, which is stable across sessions.
+		UpdateRegions(FFrozenWorldPoseExtensions::Multiply(FFrozenWorldPlugin::Get()->LockedFromSpongy(), SpongyHead).GetLocation());
+		ConsolidateAnchors();
+
 		TArray<FrozenWorld_Anchor> ActiveAnchors;
+		TSet<FrozenWorld_AnchorId> ActiveAnchorIds;
 		TArray<FrozenWorld_AnchorId> InnerSphereAnchorIds;
 		TArray<FrozenWorld_AnchorId> OuterSphereAnchorIds;
 
@@ -118,6 +451,10 @@ namespace WorldLockingTools
 				double distSqr = (aSpongyPose.GetLocation() - NewSpongyAnchorPose.GetLocation()).SquaredLength();
 				auto anchorPose = FrozenWorld_Anchor{ id, FrozenWorld_FragmentId_UNKNOWN, FFrozenWorldInterop::UtoF(aSpongyPose) };
 				ActiveAnchors.Add(anchorPose);
+				if (nearestNeighborEdges)
+				{
+					ActiveAnchorIds.Add(id);
+				}
 				if (distSqr < MinDistSqr)
 				{
 					MinDistSqr = distSqr;
@@ -148,6 +485,11 @@ namespace WorldLockingTools
 				// new anchors may still be in transition due to SpatialAnchor easing.
 				//DebugLogExtra($"Skip new anchor creation because only recently gained tracking {Time.unscaledTime - lastTrackingInactiveTime}");
 			}
+			else if (RestoreState == ERestoreState::Restoring)
+			{
+				// Stored anchors are still being restored, nearest first. One of them
+				// is likely to cover this position shortly.
+			}
 			else if (GWorld->RealTimeSeconds < lastAnchorAddTime + AnchorAddOutTime)
 			{
 				// short timeout after creating one anchor to prevent bursts of new, unlocatable anchors
@@ -158,8 +500,18 @@ namespace WorldLockingTools
 			}
 			else
 			{
+				TArray<FrozenWorld_AnchorId> NewAnchorNeighborIds = OuterSphereAnchorIds;
+				if (nearestNeighborEdges)
+				{
+					NewAnchorNeighborIds = AnchorGraph.FindNearest(NewSpongyAnchorPose.GetLocation(), MaxAnchorEdgesPerAnchor, MaxAnchorEdgeLength,
+						[this, &ActiveAnchorIds](FrozenWorld_AnchorId id)
+						{
+							return ActiveAnchorIds.Contains(id) && AnchorGraph.Degree(id) < MaxAnchorEdgesPerAnchor;
+						});
+				}
+
 				// Unreal expects the anchor pose to be in world space.
-				PrepareNewAnchor(NewSpongyAnchorPose * TrackingToWorld, OuterSphereAnchorIds);
+				PrepareNewAnchor(NewSpongyAnchorPose * TrackingToWorld, NewAnchorNeighborIds);
 				lastAnchorAddTime = GWorld->RealTimeSeconds;
 			}
 		}
@@ -171,7 +523,8 @@ namespace WorldLockingTools
 		}
 
 		// create edges between nearby existing anchors
-		if (InnerSphereAnchorIds.Num() >= 2)
+		// (with nearest neighbor edges, the graph repair takes care of this within the edge limit)
+		if (!nearestNeighborEdges && InnerSphereAnchorIds.Num() >= 2)
 		{
 			for (const auto& i : InnerSphereAnchorIds)
 			{
@@ -182,6 +535,16 @@ namespace WorldLockingTools
 			}
 		}
 
+		if (nearestNeighborEdges)
+		{
+			RepairGraph(ActiveAnchorIds, NewEdges);
+		}
+
+		for (const auto& edge : NewEdges)
+		{
+			AnchorGraph.AddEdge(edge.anchorId1, edge.anchorId2);
+		}
+
 		CheckForCull(MaxDistAnchorId, MaxDistSpongyAnchor);
 
 		FFrozenWorldPlugin::Get()->ClearSpongyAnchors();
@@ -202,63 +565,537 @@ namespace WorldLockingTools
 	/// 
 	/// Likewise, when a spongy anchor fails to load, this routine will delete its frozen
 	/// counterpart from the plugin.
+	/// 
+	/// This only requests the restore. The anchors themselves are restored by UpdateRestore()
+	/// once the AR session is running and the pin local store is ready.
+	/// Called on every load, with or without frozen anchors, since it also picks up the paged out regions.
 	/// </summary>
 	void FAnchorManager::LoadAnchors()
 	{
-		// Wait for ARSession to start and anchor store to be ready.
-		// This is called from a background thread, so we can loop until the anchor store is ready.
-		while (UARBlueprintLibrary::GetARSessionStatus().Status != EARSessionStatus::Running)
+		// This is called from a background thread, hand the request over to the game thread which owns the restore state.
+		AsyncTask(ENamedThreads::GameThread, [this]() {
+			BeginRestore();
+		});
+	}
+
+	/// <summary>
+	/// Capture the set of frozen anchors to restore and start waiting for the AR session and anchor store.
+	/// </summary>
+	void FAnchorManager::BeginRestore()
+	{
+		check(IsInGameThread());
+
+		PendingRestoreIds = FFrozenWorldPlugin::Get()->GetFrozenAnchorIds();
+		PendingRestorePins.Empty();
+
+		RegionStore.Scan();
+		headRegionValid = false;
+
+		// Claim ids past every stored anchor up front, so an anchor created while the restore
+		// is still in flight can't collide with one that is about to be restored.
+		for (const auto& id : PendingRestoreIds)
+		{
+			if (NewAnchorId <= id)
+			{
+				NewAnchorId = id + 1;
+			}
+		}
+		if (NewAnchorId <= RegionStore.GetMaxAnchorId())
+		{
+			NewAnchorId = RegionStore.GetMaxAnchorId() + 1;
+		}
+
+		// Even with no resident anchors to restore, the store has the pins of the paged out regions.
+		bool restore = PendingRestoreIds.Num() > 0 || RegionStore.GetStoredCells().Num() > 0;
+		RestoreState = restore ? ERestoreState::WaitingForSession : ERestoreState::Idle;
+		UpdateRestore();
+	}
+
+	/// <summary>
+	/// Advance a pending anchor restore. Called every frame from the game thread.
+	/// 
+	/// Session and store readiness are checked as part of the frame, so the restore starts on the
+	/// first frame both are ready, without a background thread sleeping on them.
+	/// Restored anchors are then registered at most MaxAnchorRestoresPerFrame per frame, nearest to the head first.
+	/// </summary>
+	void FAnchorManager::UpdateRestore()
+	{
+		switch (RestoreState)
 		{
-			// Wait for ARSession to start
-			FPlatformProcess::Sleep(0.1f);
+		case ERestoreState::WaitingForSession:
+			if (UARBlueprintLibrary::GetARSessionStatus().Status != EARSessionStatus::Running)
+			{
+				return;
+			}
+
+			if (!UARBlueprintLibrary::IsARPinLocalStoreSupported())
+			{
+				PendingRestoreIds.Empty();
+				RestoreState = ERestoreState::Idle;
+				return;
+			}
+
+			RestoreState = ERestoreState::WaitingForStore;
+			[[fallthrough]];
+
+		case ERestoreState::WaitingForStore:
+			if (!UARBlueprintLibrary::IsARPinLocalStoreReady())
+			{
+				return;
+			}
+
+			OnRestoreStoreReady();
+			[[fallthrough]];
+
+		case ERestoreState::Restoring:
+			RestoreAnchorSlice();
+			break;
+
+		default:
+			break;
 		}
+	}
+
+	/// <summary>
+	/// The anchor store is ready, load the stored pins and order the restore queue.
+	/// </summary>
+	void FAnchorManager::OnRestoreStoreReady()
+	{
+		PendingRestorePins = UARBlueprintLibrary::LoadARPinsFromLocalStore();
+		SortPendingRestoresByDistance();
+
+		RestoreState = ERestoreState::Restoring;
+	}
 
-		if (!UARBlueprintLibrary::IsARPinLocalStoreSupported())
+	/// <summary>
+	/// Order the restore queue so that popping from the back yields the anchor nearest to the head.
+	/// Anchors missing from the store have nothing to restore and are handled last.
+	/// If the head pose isn't available yet, the stored order is kept.
+	/// </summary>
+	void FAnchorManager::SortPendingRestoresByDistance()
+	{
+		if (GWorld == nullptr)
 		{
 			return;
 		}
 
-		while (!UARBlueprintLibrary::IsARPinLocalStoreReady())
+		FXRHMDData HMDData;
+		UHeadMountedDisplayFunctionLibrary::GetHMDData(GWorld, HMDData);
+		if (!HMDData.bValid)
 		{
-			FPlatformProcess::Sleep(0.1f);
+			return;
 		}
 
-		AsyncTask(ENamedThreads::GameThread, [this]() {
-			auto anchorIds = FFrozenWorldPlugin::Get()->GetFrozenAnchorIds();
+		FTransform WorldToTracking = UHeadMountedDisplayFunctionLibrary::GetTrackingToWorldTransform(GWorld).Inverse();
+		FVector SpongyHeadPosition = (FTransform(HMDData.Rotation, HMDData.Position) * WorldToTracking).GetLocation();
+
+		TMap<FrozenWorld_AnchorId, double> DistanceSqrById;
+		for (const auto& id : PendingRestoreIds)
+		{
+			FName AnchorName = FName("FW_Anchor_" + FString::FromInt((int)id));
+			UARPin** Pin = PendingRestorePins.Find(AnchorName);
+
+			double distSqr = std::numeric_limits<double>::max();
+			if (Pin != nullptr && *Pin != nullptr)
+			{
+				distSqr = ((*Pin)->GetLocalToTrackingTransform().GetLocation() - SpongyHeadPosition).SquaredLength();
+			}
+			DistanceSqrById.Add(id, distSqr);
+		}
+
+		// Furthest first, the restore pops from the back.
+		PendingRestoreIds.Sort([&DistanceSqrById](FrozenWorld_AnchorId lhs, FrozenWorld_AnchorId rhs)
+		{
+			return DistanceSqrById[lhs] > DistanceSqrById[rhs];
+		});
+	}
 
-			FrozenWorld_AnchorId maxId = NewAnchorId;
+	/// <summary>
+	/// Register the next slice of restored anchors, and delete the frozen counterparts of any that failed to load.
+	/// </summary>
+	void FAnchorManager::RestoreAnchorSlice()
+	{
+		int budget = MaxAnchorRestoresPerFrame > 0 ? MaxAnchorRestoresPerFrame : PendingRestoreIds.Num();
+		for (int i = 0; i < budget && PendingRestoreIds.Num() > 0; ++i)
+		{
+			FrozenWorld_AnchorId id = PendingRestoreIds.Pop(false);
 
-			TMap<FName, UARPin*> AnchorMap = UARBlueprintLibrary::LoadARPinsFromLocalStore();
-			for (const auto& id : anchorIds)
+			FName AnchorName = FName("FW_Anchor_" + FString::FromInt((int)id));
+			UARPin** Pin = PendingRestorePins.Find(AnchorName);
+			if (Pin != nullptr && *Pin != nullptr)
 			{
-				FName AnchorName = FName("FW_Anchor_" + FString::FromInt((int)id));
-				if (AnchorMap.Contains(AnchorName))
-				{
-					anchorsByTrackableId.Add(id, AnchorMap[AnchorName]);
-					SpongyAnchors.Add(
-						SpongyAnchorWithId
-						{
-							id,
-							AnchorMap[AnchorName]
-						}
-					);
-				}
-				else
-				{
-					FFrozenWorldPlugin::Get()->RemoveFrozenAnchor(id);
-				}
+				anchorsByTrackableId.Add(id, *Pin);
+				AnchorGraph.AddAnchor(id, (*Pin)->GetLocalToTrackingTransform().GetLocation());
+				SpongyAnchors.Add(
+					SpongyAnchorWithId
+					{
+						id,
+						*Pin
+					}
+				);
+			}
+			else
+			{
+				FFrozenWorldPlugin::Get()->RemoveFrozenAnchor(id);
 			}
+		}
 
-			for (const auto& spongyAnchor : SpongyAnchors)
+		if (PendingRestoreIds.Num() == 0)
+		{
+			ReleaseUnclaimedPins();
+			PendingRestorePins.Empty();
+			RestoreState = ERestoreState::Idle;
+		}
+	}
+
+	/// <summary>
+	/// The pin store loads every stored pin. With region paging, keep the pins of anchors that are
+	/// paged out aside, so paging their regions back in doesn't need to load the whole store again.
+	/// Pins that don't belong to an anchor are released.
+	/// </summary>
+	void FAnchorManager::ReleaseUnclaimedPins()
+	{
+		if (AnchorRegionSize <= 0)
+		{
+			return;
+		}
+
+		TSet<UARPin*> claimedPins;
+		for (const auto& entry : anchorsByTrackableId)
+		{
+			claimedPins.Add(entry.Value);
+		}
+
+		for (const auto& entry : PendingRestorePins)
+		{
+			if (entry.Value == nullptr || claimedPins.Contains(entry.Value))
 			{
-				if (NewAnchorId <= spongyAnchor.AnchorId)
+				continue;
+			}
+
+			FString AnchorName = entry.Key.ToString();
+			if (AnchorName.RemoveFromStart(TEXT("FW_Anchor_")))
+			{
+				pagedOutPins.Add((FrozenWorld_AnchorId)FCString::Strtoui64(*AnchorName, nullptr, 10), entry.Value);
+			}
+			else
+			{
+				UARBlueprintLibrary::RemovePin(entry.Value);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Release the pins kept for paged out anchors. They stay in the store.
+	/// </summary>
+	void FAnchorManager::ReleasePagedOutPins()
+	{
+		for (const auto& entry : pagedOutPins)
+		{
+			DestroyAnchor(FrozenWorld_AnchorId_INVALID, entry.Value);
+		}
+		pagedOutPins.Empty();
+	}
+
+	/// <summary>
+	/// Delete all paged out regions, for a session that doesn't continue a stored one.
+	/// </summary>
+	void FAnchorManager::DiscardStoredRegions()
+	{
+		RegionStore.Discard();
+		pendingRegionEdges.Empty();
+		ReleasePagedOutPins();
+	}
+
+	/// <summary>
+	/// Page regions in and out of the FrozenWorld engine as the head moves between regions.
+	/// 
+	/// Regions are cubes of AnchorRegionSize in frozen space. Regions within AnchorRegionLoadRadius of the
+	/// head's region are paged in, regions beyond AnchorRegionUnloadRadius are paged out, and regions in between
+	/// are left as they are. Work is only done when the head enters another region.
+	/// </summary>
+	/// <param name="lockedHeadPosition">Head position in the engine's frozen space.</param>
+	void FAnchorManager::UpdateRegions(FVector lockedHeadPosition)
+	{
+		if (AnchorRegionSize <= 0 || RestoreState != ERestoreState::Idle)
+		{
+			return;
+		}
+
+		FIntVector region = RegionOf(lockedHeadPosition);
+		if (headRegionValid && region == headRegion)
+		{
+			return;
+		}
+
+		headRegion = region;
+		headRegionValid = true;
+
+		PageOutRegions();
+		PageInRegions();
+	}
+
+	/// <summary>
+	/// Move the frozen anchors beyond AnchorRegionUnloadRadius, along with their edges, from the engine into the region store,
+	/// and release their spongy anchors.
+	/// </summary>
+	void FAnchorManager::PageOutRegions()
+	{
+		int unloadRadius = FMath::Max(AnchorRegionUnloadRadius, AnchorRegionLoadRadius + 1);
+
+		TMap<FIntVector, FAnchorRegion> outgoing;
+		TMap<FrozenWorld_AnchorId, FIntVector> outgoingRegionById;
+		for (const auto& anchor : FFrozenWorldPlugin::Get()->GetFrozenAnchors())
+		{
+			FIntVector region = RegionOf(FFrozenWorldInterop::FtoU(anchor.transform.position));
+			if (RegionDistance(region, headRegion) > unloadRadius)
+			{
+				outgoing.FindOrAdd(region).anchors.Add(anchor);
+				outgoingRegionById.Add(anchor.anchorId, region);
+			}
+		}
+
+		if (outgoing.Num() == 0)
+		{
+			return;
+		}
+
+		// Edges to anchors that stay resident are kept with the outgoing anchor, and restored once both ends are back.
+		auto StoreEdge = [&outgoing, &outgoingRegionById](const FrozenWorld_Edge& edge)
+		{
+			FIntVector* region = outgoingRegionById.Find(edge.anchorId1);
+			if (region == nullptr)
+			{
+				region = outgoingRegionById.Find(edge.anchorId2);
+			}
+			if (region != nullptr)
+			{
+				outgoing[*region].edges.Add(edge);
+			}
+			return region != nullptr;
+		};
+
+		for (const auto& edge : FFrozenWorldPlugin::Get()->GetFrozenEdges())
+		{
+			StoreEdge(edge);
+		}
+		pendingRegionEdges.RemoveAll(StoreEdge);
+
+		for (const auto& entry : outgoing)
+		{
+			UE_LOG(LogWLT, Log, TEXT("Paging out %d anchors of region (%d, %d, %d)"),
+				entry.Value.anchors.Num(), entry.Key.X, entry.Key.Y, entry.Key.Z);
+
+			if (!RegionStore.Write(entry.Key, entry.Value))
+			{
+				// Keep the region resident rather than lose it.
+				continue;
+			}
+
+			for (const auto& anchor : entry.Value.anchors)
+			{
+				ReleaseAnchor(anchor.anchorId);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Move the stored regions within AnchorRegionLoadRadius back into the engine, and restore their spongy anchors.
+	/// 
+	/// Only the pins of the paged in anchors are restored, from those kept when they were paged out. Attachment points
+	/// left on the paged in anchors are then resolved again, since they missed any refits while their anchors were out.
+	/// </summary>
+	void FAnchorManager::PageInRegions()
+	{
+		TArray<FIntVector> incoming;
+		for (const auto& region : RegionStore.GetStoredCells())
+		{
+			if (RegionDistance(region, headRegion) <= AnchorRegionLoadRadius)
+			{
+				incoming.Add(region);
+			}
+		}
+
+		if (incoming.Num() == 0)
+		{
+			return;
+		}
+
+		TSet<FrozenWorld_AnchorId> residentIds(FFrozenWorldPlugin::Get()->GetFrozenAnchorIds());
+		TSet<FrozenWorld_AnchorId> pagedInIds;
+		TArray<FrozenWorld_Anchor> anchors;
+		TArray<FrozenWorld_Edge> edges = MoveTemp(pendingRegionEdges);
+		for (const auto& region : incoming)
+		{
+			FAnchorRegion stored;
+			if (!RegionStore.Take(region, stored))
+			{
+				continue;
+			}
+
+			UE_LOG(LogWLT, Log, TEXT("Paging in %d anchors of region (%d, %d, %d)"),
+				stored.anchors.Num(), region.X, region.Y, region.Z);
+
+			for (const auto& anchor : stored.anchors)
+			{
+				// The region may also be in the last saved engine state, if the application stopped before saving after paging it out.
+				if (!residentIds.Contains(anchor.anchorId))
 				{
-					NewAnchorId = spongyAnchor.AnchorId + 1;
+					residentIds.Add(anchor.anchorId);
+					pagedInIds.Add(anchor.anchorId);
+					anchors.Add(anchor);
+					PendingRestoreIds.Add(anchor.anchorId);
+
+					UARPin* Pin = nullptr;
+					if (pagedOutPins.RemoveAndCopyValue(anchor.anchorId, Pin))
+					{
+						PendingRestorePins.Add(FName("FW_Anchor_" + FString::FromInt((int)anchor.anchorId)), Pin);
+					}
 				}
 			}
+			edges.Append(stored.edges);
+		}
+
+		FFrozenWorldPlugin::Get()->AddFrozenAnchors(anchors);
+
+		TArray<FrozenWorld_Edge> residentEdges;
+		for (const auto& edge : edges)
+		{
+			if (residentIds.Contains(edge.anchorId1) && residentIds.Contains(edge.anchorId2))
+			{
+				residentEdges.Add(edge);
+			}
+			else
+			{
+				pendingRegionEdges.Add(edge);
+			}
+		}
+		FFrozenWorldPlugin::Get()->AddFrozenEdges(residentEdges);
+
+		if (pagedInIds.Num() > 0)
+		{
+			FFragmentManager::Get()->ResolveAttachmentPoints(pagedInIds);
+		}
+
+		if (PendingRestoreIds.Num() > 0)
+		{
+			// Anchors without a kept pin aren't in the store either, and are removed by the restore like any other missing anchor.
+			SortPendingRestoresByDistance();
+			RestoreState = ERestoreState::Restoring;
+		}
+	}
+
+	/// <summary>
+	/// Remove a paged out anchor from the engine and stop tracking it. Its pin is kept, along with its
+	/// scene component, for the anchor to be restored from when its region pages back in.
+	/// </summary>
+	void FAnchorManager::ReleaseAnchor(FrozenWorld_AnchorId id)
+	{
+		UARPin* Pin = nullptr;
+		if (anchorsByTrackableId.RemoveAndCopyValue(id, Pin) && Pin != nullptr)
+		{
+			pagedOutPins.Add(id, Pin);
+		}
+
+		FFrozenWorldPlugin::Get()->RemoveFrozenAnchor(id);
+		AnchorGraph.RemoveAnchor(id);
+		NewAnchorNeighbors.Remove(id);
+
+		SpongyAnchors.RemoveAll([id](const SpongyAnchorWithId& entry)
+		{
+			return entry.AnchorId == id;
 		});
 	}
 
+	FIntVector FAnchorManager::RegionOf(FVector lockedPosition) const
+	{
+		return FIntVector(
+			FMath::FloorToInt(lockedPosition.X / AnchorRegionSize),
+			FMath::FloorToInt(lockedPosition.Y / AnchorRegionSize),
+			FMath::FloorToInt(lockedPosition.Z / AnchorRegionSize));
+	}
+
+	/// <summary>
+	/// Distance between regions in regions along the furthest axis, so that the resident regions form a cube around the head.
+	/// </summary>
+	int FAnchorManager::RegionDistance(const FIntVector& a, const FIntVector& b)
+	{
+		FIntVector d = a - b;
+		return FMath::Max3(FMath::Abs(d.X), FMath::Abs(d.Y), FMath::Abs(d.Z));
+	}
+
+	/// <summary>
+	/// Create pooled anchor components up front, so the first anchors of a session don't allocate.
+	/// </summary>
+	/// <param name="count">Number of free components to have in the pool, capped by MaxPooledAnchorComponents.</param>
+	void FAnchorManager::PrewarmAnchorComponentPool(int count)
+	{
+		count = FMath::Min(count, MaxPooledAnchorComponents);
+		while (freeAnchorComponents.Num() < count)
+		{
+			USceneComponent* AnchorSceneComponent = NewObject<USceneComponent>();
+			AnchorSceneComponent->AddToRoot();
+			freeAnchorComponents.Add(AnchorSceneComponent);
+			anchorComponentPoolStats.NumCreated++;
+		}
+	}
+
+	FAnchorComponentPoolStats FAnchorManager::GetAnchorComponentPoolStats() const
+	{
+		FAnchorComponentPoolStats stats = anchorComponentPoolStats;
+		stats.NumInUse = anchorComponentsInUse.Num();
+		stats.NumFree = freeAnchorComponents.Num();
+		return stats;
+	}
+
+	/// <summary>
+	/// Get a scene component for a new anchor to be pinned to, reusing one released by an earlier anchor if possible.
+	/// </summary>
+	USceneComponent* FAnchorManager::AcquireAnchorComponent()
+	{
+		USceneComponent* AnchorSceneComponent = nullptr;
+		if (freeAnchorComponents.Num() > 0)
+		{
+			AnchorSceneComponent = freeAnchorComponents.Pop(false);
+			anchorComponentPoolStats.NumReused++;
+		}
+		else
+		{
+			AnchorSceneComponent = NewObject<USceneComponent>();
+			AnchorSceneComponent->AddToRoot();
+			anchorComponentPoolStats.NumCreated++;
+		}
+
+		anchorComponentsInUse.Add(AnchorSceneComponent);
+		return AnchorSceneComponent;
+	}
+
+	/// <summary>
+	/// Return the component of an anchor about to be removed to the pool.
+	/// 
+	/// Pins restored from the local store aren't pinned to a pooled component, and are ignored.
+	/// Once the pool is full, components are unrooted and left to the garbage collector.
+	/// </summary>
+	void FAnchorManager::ReleaseAnchorComponent(UARPin* spongyAnchor)
+	{
+		USceneComponent* AnchorSceneComponent = spongyAnchor->GetPinnedComponent();
+		if (AnchorSceneComponent == nullptr || anchorComponentsInUse.Remove(AnchorSceneComponent) == 0)
+		{
+			return;
+		}
+
+		if (freeAnchorComponents.Num() < MaxPooledAnchorComponents)
+		{
+			freeAnchorComponents.Add(AnchorSceneComponent);
+		}
+		else
+		{
+			AnchorSceneComponent->RemoveFromRoot();
+			AnchorSceneComponent->MarkAsGarbage();
+			anchorComponentPoolStats.NumDiscarded++;
+		}
+	}
+
 	/// <summary>
 	/// Platform dependent instantiation of a local anchor at given position.
 	/// </summary>
@@ -292,19 +1129,24 @@ namespace WorldLockingTools
 	{
 		UE_LOG(LogWLT, Log, TEXT("Destroying anchor %d"), id);
 
-		if (spongyAnchor != nullptr && anchorsByTrackableId.Contains(id))
+		if (spongyAnchor != nullptr)
 		{
-			FName AnchorName = FName("FW_Anchor_" + FString::FromInt((int)id));
-			UARBlueprintLibrary::RemoveARPinFromLocalStore(AnchorName);
+			if (anchorsByTrackableId.Contains(id))
+			{
+				FName AnchorName = FName("FW_Anchor_" + FString::FromInt((int)id));
+				UARBlueprintLibrary::RemoveARPinFromLocalStore(AnchorName);
 
-			UARBlueprintLibrary::RemovePin(spongyAnchor);
+				anchorsByTrackableId.Remove(id);
+			}
 
-			anchorsByTrackableId.Remove(id);
+			ReleaseAnchorComponent(spongyAnchor);
+			UARBlueprintLibrary::RemovePin(spongyAnchor);
 		}
 
 		if (id != FrozenWorld_AnchorId_INVALID && id != FrozenWorld_AnchorId_UNKNOWN)
 		{
 			FFrozenWorldPlugin::Get()->RemoveFrozenAnchor(id);
+			AnchorGraph.RemoveAnchor(id);
 
 			int index = 0;
 			for (const auto& entry : SpongyAnchors)
@@ -334,10 +1176,7 @@ namespace WorldLockingTools
 			NewSpongyAnchor = DestroyAnchor(FrozenWorld_AnchorId_INVALID, NewSpongyAnchor);
 		}
 
-		USceneComponent* AnchorSceneComponent = NewObject<USceneComponent>();
-		AnchorSceneComponent->AddToRoot();
-
-		NewSpongyAnchor = CreateAnchor(NextAnchorId(), AnchorSceneComponent, pose);
+		NewSpongyAnchor = CreateAnchor(NextAnchorId(), AcquireAnchorComponent(), pose);
 		NewAnchorNeighbors = neighbors;
 	}
 
@@ -360,6 +1199,8 @@ namespace WorldLockingTools
 			OutNewEdges.Add(FrozenWorld_Edge{ id, NewId });
 		}
 
+		AnchorGraph.AddAnchor(NewId, NewSpongyAnchor->GetLocalToTrackingTransform().GetLocation());
+
 		SpongyAnchors.Add(
 			SpongyAnchorWithId
 			{
@@ -11,6 +11,10 @@
 #include "FrozenWorldEngine.h"
 #pragma warning(pop)
 
+#include "AnchorGraph.h"
+#include "AnchorRegionStore.h"
+#include "WorldLockingToolsTypes.h"
+
 namespace WorldLockingTools
 {
 	struct SpongyAnchorWithId
@@ -30,7 +34,44 @@ namespace WorldLockingTools
 		float TrackingStartDelayTime = 0.3f;
 		float AnchorAddOutTime = 0.4f;
 
+		// Maximum number of stored anchors restored per frame after a load.
+		int MaxAnchorRestoresPerFrame = 16;
+
+		EAnchorEdgeMode AnchorEdgeMode = EAnchorEdgeMode::Radius;
+		// Edge limit per anchor in NearestNeighbors mode.
+		int MaxAnchorEdgesPerAnchor = 6;
+		// Anchors visited per frame by the graph repair in NearestNeighbors mode.
+		int MaxGraphRepairsPerFrame = 4;
+
+		// Size of the regions anchors are paged in and out by, 0 keeps all anchors resident.
+		float AnchorRegionSize = 0.0f;
+		int AnchorRegionLoadRadius = 1;
+		int AnchorRegionUnloadRadius = 2;
+
+		// Unused anchor components kept for reuse, beyond this they are left to GC.
+		int MaxPooledAnchorComponents = 32;
+
+		// Anchor consolidation, disabled with a distance of 0.
+		float AnchorConsolidationDistance = 0.0f;
+		float AnchorConsolidationTolerance = 2.0f;
+		float AnchorConsolidationInterval = 5.0f;
+
 	private:
+		/// <summary>
+		/// Progress of restoring spongy anchors from the local pin store after a load.
+		/// </summary>
+		enum class ERestoreState
+		{
+			Idle,				// Nothing to restore
+			WaitingForSession,	// Restore requested, AR session not running yet
+			WaitingForStore,	// AR session running, pin local store not ready yet
+			Restoring			// Pins loaded from store, registering them in slices
+		};
+
+		ERestoreState RestoreState = ERestoreState::Idle;
+		TArray<FrozenWorld_AnchorId> PendingRestoreIds;
+		TMap<FName, UARPin*> PendingRestorePins;
+
 		static inline FrozenWorld_AnchorId NewAnchorId = FrozenWorld_AnchorId_INVALID + 1;
 		UARPin* NewSpongyAnchor = nullptr;
 		TArray<FrozenWorld_AnchorId> NewAnchorNeighbors;
@@ -41,6 +82,26 @@ namespace WorldLockingTools
 
 		TMap<FrozenWorld_AnchorId, UARPin*> anchorsByTrackableId;
 
+		FAnchorGraph AnchorGraph;
+		TArray<FrozenWorld_AnchorId> graphRepairQueue;
+
+		FAnchorRegionStore RegionStore;
+		// Edges of paged in anchors whose other end is still paged out.
+		TArray<FrozenWorld_Edge> pendingRegionEdges;
+		// Pins of paged out anchors. The pin store only loads all pins at once, so they are kept here
+		// for their anchors to page back in, rather than loading the whole store again on every page in.
+		TMap<FrozenWorld_AnchorId, UARPin*> pagedOutPins;
+		FIntVector headRegion;
+		bool headRegionValid = false;
+
+		// Scene components for new anchors to be pinned to. They stay rooted while pooled or in use.
+		TArray<USceneComponent*> freeAnchorComponents;
+		TSet<USceneComponent*> anchorComponentsInUse;
+		FAnchorComponentPoolStats anchorComponentPoolStats;
+
+		float lastConsolidationTime;
+		FAnchorConsolidationStats anchorConsolidationStats;
+
 	public:
 		FAnchorManager();
 
@@ -49,7 +110,40 @@ namespace WorldLockingTools
 
 		void LoadAnchors();
 
+		bool IsRestoringAnchors() const
+		{
+			return RestoreState != ERestoreState::Idle;
+		}
+
+		void DiscardStoredRegions();
+
+		void PrewarmAnchorComponentPool(int count);
+		FAnchorComponentPoolStats GetAnchorComponentPoolStats() const;
+
+		FAnchorConsolidationStats GetAnchorConsolidationStats() const
+		{
+			return anchorConsolidationStats;
+		}
+
 	private:
+		void BeginRestore();
+		void UpdateRestore();
+		void OnRestoreStoreReady();
+		void RestoreAnchorSlice();
+		void SortPendingRestoresByDistance();
+		void ReleaseUnclaimedPins();
+		void ReleasePagedOutPins();
+
+		void UpdateRegions(FVector lockedHeadPosition);
+		void PageOutRegions();
+		void PageInRegions();
+		void ReleaseAnchor(FrozenWorld_AnchorId id);
+		FIntVector RegionOf(FVector lockedPosition) const;
+		static int RegionDistance(const FIntVector& a, const FIntVector& b);
+
+		USceneComponent* AcquireAnchorComponent();
+		void ReleaseAnchorComponent(UARPin* spongyAnchor);
+
 		UARPin* CreateAnchor(FrozenWorld_AnchorId id, USceneComponent* AnchorSceneComponent, FTransform initialPose);
 		UARPin* DestroyAnchor(FrozenWorld_AnchorId id, UARPin* spongyAnchor);
 
@@ -58,6 +152,12 @@ namespace WorldLockingTools
 
 		void CheckForCull(FrozenWorld_AnchorId maxDistAnchorId, UARPin* maxDistSpongyAnchor);
 
+		void ConsolidateAnchors();
+
+		void RepairGraph(const TSet<FrozenWorld_AnchorId>& activeIds, TArray<FrozenWorld_Edge>& OutNewEdges);
+		void RepairAnchor(FrozenWorld_AnchorId id, const TSet<FrozenWorld_AnchorId>& activeIds, TArray<FrozenWorld_Edge>& OutNewEdges);
+		bool TryAddEdge(FrozenWorld_AnchorId id1, FrozenWorld_AnchorId id2, const TSet<FrozenWorld_AnchorId>& activeIds, TArray<FrozenWorld_Edge>& OutNewEdges);
+
 		FrozenWorld_AnchorId NextAnchorId();
 		FrozenWorld_AnchorId ClaimAnchorId();
 	};
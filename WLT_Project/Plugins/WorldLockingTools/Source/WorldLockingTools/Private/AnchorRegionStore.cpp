@@ -0,0 +1,217 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "AnchorRegionStore.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+namespace WorldLockingTools
+{
+	FAnchorRegionStore::FAnchorRegionStore()
+		: directory(FPlatformProcess::UserDir() / FString("Persistence/AnchorRegions"))
+	{
+	}
+
+	FAnchorRegionStore::FAnchorRegionStore(const FString& directory)
+		: directory(directory)
+	{
+	}
+
+	/// <summary>
+	/// Forget the stored cells, without touching the files.
+	///
+	/// Files of forgotten cells are overwritten when their cell is paged out again.
+	/// The largest stored anchor id is kept, since their anchors may still be found on disk.
+	/// </summary>
+	void FAnchorRegionStore::Reset()
+	{
+		storedCells.Empty();
+	}
+
+	/// <summary>
+	/// Rebuild the set of stored cells from the region files on disk.
+	/// </summary>
+	void FAnchorRegionStore::Scan()
+	{
+		storedCells.Empty();
+		maxAnchorId = FrozenWorld_AnchorId_INVALID;
+
+		FString Directory = GetDirectory();
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (!PlatformFile.DirectoryExists(*Directory))
+		{
+			return;
+		}
+
+		if (IFileHandle* FileHandle = PlatformFile.OpenRead(*GetIndexFileName()))
+		{
+			uint32 v = 0;
+			FileHandle->Read((uint8*)&v, sizeof(uint32));
+			if (v != version || !FileHandle->Read((uint8*)&maxAnchorId, sizeof(FrozenWorld_AnchorId)))
+			{
+				maxAnchorId = FrozenWorld_AnchorId_INVALID;
+			}
+
+			delete FileHandle;
+			FileHandle = nullptr;
+		}
+
+		PlatformFile.IterateDirectory(*Directory, [this](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+		{
+			TArray<FString> parts;
+			FPaths::GetBaseFilename(FilenameOrDirectory).ParseIntoArray(parts, TEXT("_"));
+			if (!bIsDirectory && parts.Num() == 4 && parts[0] == TEXT("Region"))
+			{
+				storedCells.Add(FIntVector(FCString::Atoi(*parts[1]), FCString::Atoi(*parts[2]), FCString::Atoi(*parts[3])));
+			}
+			return true;
+		});
+	}
+
+	/// <summary>
+	/// Delete all region files, for a session that starts from scratch.
+	/// </summary>
+	void FAnchorRegionStore::Discard()
+	{
+		storedCells.Empty();
+		maxAnchorId = FrozenWorld_AnchorId_INVALID;
+
+		FString Directory = GetDirectory();
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (PlatformFile.DirectoryExists(*Directory))
+		{
+			PlatformFile.DeleteDirectoryRecursively(*Directory);
+		}
+	}
+
+	/// <summary>
+	/// Store a region paged out of the engine.
+	/// If the cell is already stored, the region is added to what is stored for it.
+	/// </summary>
+	/// <returns>True if the region was written.</returns>
+	bool FAnchorRegionStore::Write(const FIntVector& cell, const FAnchorRegion& region)
+	{
+		FAnchorRegion merged;
+		if (storedCells.Contains(cell))
+		{
+			Read(cell, merged);
+		}
+		merged.anchors.Append(region.anchors);
+		merged.edges.Append(region.edges);
+
+		FString Directory = GetDirectory();
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (!PlatformFile.DirectoryExists(*Directory))
+		{
+			PlatformFile.CreateDirectory(*Directory);
+		}
+
+		IFileHandle* FileHandle = PlatformFile.OpenWrite(*GetFileName(cell));
+		if (FileHandle == nullptr)
+		{
+			return false;
+		}
+
+		int32 numAnchors = merged.anchors.Num();
+		int32 numEdges = merged.edges.Num();
+		FileHandle->Write((const uint8*)&version, sizeof(uint32));
+		FileHandle->Write((const uint8*)&numAnchors, sizeof(int32));
+		FileHandle->Write((const uint8*)&numEdges, sizeof(int32));
+		FileHandle->Write((const uint8*)merged.anchors.GetData(), numAnchors * sizeof(FrozenWorld_Anchor));
+		FileHandle->Write((const uint8*)merged.edges.GetData(), numEdges * sizeof(FrozenWorld_Edge));
+
+		delete FileHandle;
+		FileHandle = nullptr;
+
+		storedCells.Add(cell);
+
+		FrozenWorld_AnchorId regionMaxAnchorId = maxAnchorId;
+		for (const auto& anchor : region.anchors)
+		{
+			regionMaxAnchorId = FMath::Max(regionMaxAnchorId, anchor.anchorId);
+		}
+		if (regionMaxAnchorId != maxAnchorId)
+		{
+			maxAnchorId = regionMaxAnchorId;
+			if (IFileHandle* IndexHandle = PlatformFile.OpenWrite(*GetIndexFileName()))
+			{
+				IndexHandle->Write((const uint8*)&version, sizeof(uint32));
+				IndexHandle->Write((const uint8*)&maxAnchorId, sizeof(FrozenWorld_AnchorId));
+
+				delete IndexHandle;
+				IndexHandle = nullptr;
+			}
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Read a stored region for paging it into the engine, and forget it.
+	///
+	/// The file itself is left in place until the cell is paged out again, so the region isn't lost
+	/// if the application stops before the engine state containing it is saved.
+	/// </summary>
+	/// <returns>True if the region was read.</returns>
+	bool FAnchorRegionStore::Take(const FIntVector& cell, FAnchorRegion& outRegion)
+	{
+		if (!storedCells.Contains(cell))
+		{
+			return false;
+		}
+
+		storedCells.Remove(cell);
+		return Read(cell, outRegion);
+	}
+
+	bool FAnchorRegionStore::Read(const FIntVector& cell, FAnchorRegion& outRegion) const
+	{
+		IFileHandle* FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*GetFileName(cell));
+		if (FileHandle == nullptr)
+		{
+			return false;
+		}
+
+		bool loaded = false;
+
+		uint32 v = 0;
+		int32 numAnchors = 0;
+		int32 numEdges = 0;
+		FileHandle->Read((uint8*)&v, sizeof(uint32));
+		FileHandle->Read((uint8*)&numAnchors, sizeof(int32));
+		FileHandle->Read((uint8*)&numEdges, sizeof(int32));
+		if (v == version && numAnchors >= 0 && numEdges >= 0)
+		{
+			outRegion.anchors.SetNumUninitialized(numAnchors);
+			outRegion.edges.SetNumUninitialized(numEdges);
+			loaded = FileHandle->Read((uint8*)outRegion.anchors.GetData(), numAnchors * sizeof(FrozenWorld_Anchor))
+				&& FileHandle->Read((uint8*)outRegion.edges.GetData(), numEdges * sizeof(FrozenWorld_Edge));
+		}
+
+		delete FileHandle;
+		FileHandle = nullptr;
+
+		if (!loaded)
+		{
+			outRegion.anchors.Empty();
+			outRegion.edges.Empty();
+		}
+		return loaded;
+	}
+
+	FString FAnchorRegionStore::GetDirectory() const
+	{
+		return directory;
+	}
+
+	FString FAnchorRegionStore::GetFileName(const FIntVector& cell) const
+	{
+		return GetDirectory() / FString::Printf(TEXT("Region_%d_%d_%d.fwr"), cell.X, cell.Y, cell.Z);
+	}
+
+	FString FAnchorRegionStore::GetIndexFileName() const
+	{
+		return GetDirectory() / FString("Regions.fwi");
+	}
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#pragma warning(push)
+#pragma warning(disable: 4996)
+#include "FrozenWorldEngine.h"
+#pragma warning(pop)
+
+#include "CoreMinimal.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Frozen anchors and edges of one region that has been paged out of the FrozenWorld engine.
+	/// </summary>
+	struct FAnchorRegion
+	{
+		TArray<FrozenWorld_Anchor> anchors;
+		TArray<FrozenWorld_Edge> edges;
+	};
+
+	/// <summary>
+	/// Persistent storage for anchor regions paged out of the FrozenWorld engine.
+	///
+	/// Each region is kept in its own file, keyed by its cell in frozen space, so paging a region
+	/// in or out only touches that region's data. Only the set of stored cells is kept in memory.
+	/// Files go to Persistence/AnchorRegions in the user directory, unless another directory is given.
+	/// </summary>
+	class FAnchorRegionStore
+	{
+	public:
+		FAnchorRegionStore();
+		explicit FAnchorRegionStore(const FString& directory);
+
+		void Reset();
+		void Scan();
+		void Discard();
+
+		bool Contains(const FIntVector& cell) const
+		{
+			return storedCells.Contains(cell);
+		}
+
+		const TSet<FIntVector>& GetStoredCells() const
+		{
+			return storedCells;
+		}
+
+		// Largest anchor id ever paged out, so new anchor ids don't collide with stored ones.
+		FrozenWorld_AnchorId GetMaxAnchorId() const
+		{
+			return maxAnchorId;
+		}
+
+		bool Write(const FIntVector& cell, const FAnchorRegion& region);
+		bool Take(const FIntVector& cell, FAnchorRegion& outRegion);
+
+	private:
+		bool Read(const FIntVector& cell, FAnchorRegion& outRegion) const;
+
+		FString GetDirectory() const;
+		FString GetFileName(const FIntVector& cell) const;
+		FString GetIndexFileName() const;
+
+		FString directory;
+		TSet<FIntVector> storedCells;
+		FrozenWorld_AnchorId maxAnchorId = FrozenWorld_AnchorId_INVALID;
+
+		static const uint32 version = 1;
+	};
+}
@@ -2,10 +2,13 @@
 // Licensed under the MIT License.
 
 #include "AttachmentPoint.h"
+#include "AttachmentPointBatchListener.h"
 #include "FrozenWorldPoseExtensions.h"
 
 namespace WorldLockingTools
 {
+	uint64 FAttachmentPoint::LatestEpoch = 0;
+
 	/// <summary>
 	/// Set internals of attachment point to new values.
 	/// </summary>
@@ -32,7 +35,15 @@ namespace WorldLockingTools
 		if (newState != State)
 		{
 			State = newState;
-			StateHandler.ExecuteIfBound(newState);
+			Epoch = ++LatestEpoch;
+			if (BatchListener != nullptr)
+			{
+				BatchListener->AddStateChange(Handle, newState);
+			}
+
+			// The handler may create attachment points, moving this one in the pool, so don't call it through this.
+			FAdjustStateDelegate handler = StateHandler;
+			handler.ExecuteIfBound(newState);
 		}
 	}
 
@@ -44,8 +55,16 @@ namespace WorldLockingTools
 		check(IsInGameThread());
 
 		ObjectPosition = FFrozenWorldPoseExtensions::Multiply(adjustment, ObjectPosition);
-		ObjectAdjustment = FFrozenWorldPoseExtensions::Multiply(ObjectAdjustment, adjustment);
+		ObjectAdjustment = FFrozenWorldPoseExtensions::Multiply(adjustment, ObjectAdjustment);
+		Epoch = ++LatestEpoch;
+
+		if (BatchListener != nullptr)
+		{
+			BatchListener->AddPoseAdjustment(Handle, adjustment, State);
+		}
 
-		LocationHandler.ExecuteIfBound(adjustment);
+		// As for the state handler above.
+		FAdjustLocationDelegate handler = LocationHandler;
+		handler.ExecuteIfBound(adjustment);
 	}
 }
\ No newline at end of file
@@ -12,6 +12,8 @@
 
 namespace WorldLockingTools
 {
+	class FAttachmentPointBatchListener;
+
 	/// <summary>
 	/// The states an attachment point can be in.
 	/// </summary>
@@ -24,6 +26,39 @@ namespace WorldLockingTools
 		Released,	   // Existed, but has been released. Is now garbage.
 	};
 
+	/// <summary>
+	/// Stable handle to an attachment point owned by the FFragmentManager.
+	///
+	/// The handle stays valid while the attachment point moves around in storage, and goes stale
+	/// once the attachment point is released, even if its slot is reused for a new attachment point.
+	/// A default constructed handle refers to no attachment point.
+	/// </summary>
+	struct FAttachmentPointHandle
+	{
+		uint32 Index = 0;
+		uint32 Generation = 0;
+
+		bool IsValid() const
+		{
+			return Generation != 0;
+		}
+
+		bool operator == (const FAttachmentPointHandle& other) const
+		{
+			return Index == other.Index && Generation == other.Generation;
+		}
+
+		bool operator != (const FAttachmentPointHandle& other) const
+		{
+			return !(*this == other);
+		}
+
+		friend uint32 GetTypeHash(const FAttachmentPointHandle& handle)
+		{
+			return HashCombine(handle.Index, handle.Generation);
+		}
+	};
+
 	/// <summary>
 	/// Opaque handle to an attachment point. Create one of these to enable
 	/// WorldLocking to adjust an attached object as corrections to the world locked space 
@@ -32,7 +67,8 @@ namespace WorldLockingTools
 	/// The attachment point gives an interface for notifying the system that you have moved
 	/// the attached object, and the system indicates that it has computed an adjustment
 	/// for the object through the callbacks passed into the creation routine.
-	/// Alternatively, polling is also supported through the State and ObjectAdjustment accessors.
+	/// Alternatively, polling is also supported through the State and ObjectAdjustment accessors,
+	/// with Epoch telling whether either changed since the last poll.
 	/// </summary>
 	class FAttachmentPoint
 	{
@@ -57,16 +93,26 @@ namespace WorldLockingTools
 
 	public:
 		FrozenWorld_AnchorId AnchorId;
-		FrozenWorld_FragmentId FragmentId;
+		FrozenWorld_FragmentId FragmentId = FrozenWorld_FragmentId_INVALID;
 		// Position of attachment point in anchor point's space.
 		FVector LocationFromAnchor;
 		// Internal history cache.
 		FVector CachedPosition;
 		// Current state of this attachment point. 
 		// Positioning information is only valid when state is Normal.
-		AttachmentPointStateType State;
+		AttachmentPointStateType State = AttachmentPointStateType::Invalid;
+		// Position in the attachment list of the fragment holding this attachment point, INDEX_NONE while in none.
+		int32 FragmentIndex = INDEX_NONE;
+		// Handle by which the attachment point is known to its clients.
+		FAttachmentPointHandle Handle;
+		// Whether the adjustment of a refit is still deferred, see FDeferredAdjustments. Its fragment's state is then passed on with the adjustment.
+		bool AdjustmentDeferred = false;
+		// Optional listener receiving this attachment point's updates once per frame, together with those of others.
+		FAttachmentPointBatchListener* BatchListener = nullptr;
 		// Cumulative transform adjustment for object(s) bound to this attachment point.
 		FTransform ObjectAdjustment;
+		// Epoch of the last adjustment or state change of this attachment point.
+		uint64 Epoch = 0;
 		// The position of object(s) bound to this attachment point.
 		FVector ObjectPosition;
 
@@ -75,5 +121,23 @@ namespace WorldLockingTools
 		void HandleStateChange(AttachmentPointStateType newState);
 
 		void HandlePoseAdjustment(FTransform adjustment);
+
+		// Epoch of the latest change of any attachment point. Only ever increases.
+		static uint64 LatestEpoch;
+	};
+
+	/// <summary>
+	/// State of an attachment point as seen by a consumer polling for changes.
+	/// </summary>
+	struct AttachmentPointChange
+	{
+		FAttachmentPointHandle handle;
+		// Cumulative adjustment since the attachment point was created.
+		FTransform adjustment;
+		// Adjusted position of the attached object.
+		FVector position;
+		// Released if the attachment point no longer exists.
+		AttachmentPointStateType state;
+		uint64 epoch;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "AttachmentPointBatchListener.h"
+#include "FragmentManager.h"
+#include "FrozenWorldPoseExtensions.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Unregister from the fragment manager, so neither it nor the attachment points keep pointing at this listener.
+	/// </summary>
+	FAttachmentPointBatchListener::~FAttachmentPointBatchListener()
+	{
+		if (registeredManager != nullptr)
+		{
+			registeredManager->RemoveBatchListener(this);
+		}
+	}
+
+	/// <summary>
+	/// Record a pose adjustment, combined with any earlier adjustment of the attachment point this frame.
+	/// </summary>
+	void FAttachmentPointBatchListener::AddPoseAdjustment(FAttachmentPointHandle handle, FTransform adjustment, AttachmentPointStateType state)
+	{
+		AttachmentPointUpdate& update = FindOrAddUpdate(handle);
+		update.adjustment = FFrozenWorldPoseExtensions::Multiply(adjustment, update.adjustment);
+		update.state = state;
+	}
+
+	/// <summary>
+	/// Record a state change, replacing any earlier state of the attachment point this frame.
+	/// </summary>
+	void FAttachmentPointBatchListener::AddStateChange(FAttachmentPointHandle handle, AttachmentPointStateType state)
+	{
+		FindOrAddUpdate(handle).state = state;
+	}
+
+	/// <summary>
+	/// Hand the updates collected since the last dispatch to the listener.
+	/// 
+	/// Updates recorded while the listener handles the batch go into the next one.
+	/// </summary>
+	void FAttachmentPointBatchListener::Dispatch()
+	{
+		check(IsInGameThread());
+		if (updates.Num() == 0)
+		{
+			return;
+		}
+
+		Swap(updates, dispatching);
+		updates.Reset();
+		updateIndices.Reset();
+
+		OnAttachmentPointsUpdated(dispatching);
+		dispatching.Reset();
+	}
+
+	AttachmentPointUpdate& FAttachmentPointBatchListener::FindOrAddUpdate(FAttachmentPointHandle handle)
+	{
+		int& index = updateIndices.FindOrAdd(handle, INDEX_NONE);
+		if (index == INDEX_NONE)
+		{
+			index = updates.Add(AttachmentPointUpdate{ handle, FTransform::Identity, AttachmentPointStateType::Invalid });
+		}
+		return updates[index];
+	}
+}
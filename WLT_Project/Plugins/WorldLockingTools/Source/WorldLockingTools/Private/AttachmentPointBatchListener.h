@@ -0,0 +1,66 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "AttachmentPoint.h"
+
+namespace WorldLockingTools
+{
+	class FFragmentManager;
+
+	/// <summary>
+	/// Everything that happened to one attachment point in one frame.
+	/// </summary>
+	struct AttachmentPointUpdate
+	{
+		FAttachmentPointHandle handle;
+		// All pose adjustments of the frame combined, identity if there were none.
+		FTransform adjustment;
+		// State at the end of the frame.
+		AttachmentPointStateType state;
+	};
+
+	/// <summary>
+	/// Batch channel for attachment point updates, alongside the per attachment point delegates.
+	///
+	/// Systems managing large numbers of attached objects, like pools of instanced meshes, derive from this
+	/// and create their attachment points with it. Instead of one delegate call per attachment point and event,
+	/// they get a single call per frame, with one entry per updated attachment point in a contiguous array.
+	/// A listener unregisters itself from the fragment manager when destroyed.
+	/// </summary>
+	class FAttachmentPointBatchListener
+	{
+	public:
+		FAttachmentPointBatchListener() = default;
+		FAttachmentPointBatchListener(const FAttachmentPointBatchListener&) = delete;
+		FAttachmentPointBatchListener& operator=(const FAttachmentPointBatchListener&) = delete;
+		virtual ~FAttachmentPointBatchListener();
+
+		// Called on the game thread at the end of a frame's fragment update, if any attachment point of this listener was updated.
+		virtual void OnAttachmentPointsUpdated(TArrayView<const AttachmentPointUpdate> updates) = 0;
+
+		void AddPoseAdjustment(FAttachmentPointHandle handle, FTransform adjustment, AttachmentPointStateType state);
+		void AddStateChange(FAttachmentPointHandle handle, AttachmentPointStateType state);
+		void Dispatch();
+
+		int NumPendingUpdates() const
+		{
+			return updates.Num();
+		}
+
+	private:
+		friend class FFragmentManager;
+
+		AttachmentPointUpdate& FindOrAddUpdate(FAttachmentPointHandle handle);
+
+		// The fragment manager this listener is registered with, if any.
+		FFragmentManager* registeredManager = nullptr;
+
+		TArray<AttachmentPointUpdate> updates;
+		TMap<FAttachmentPointHandle, int> updateIndices;
+
+		// Kept between frames, so dispatching doesn't allocate.
+		TArray<AttachmentPointUpdate> dispatching;
+	};
+}
@@ -0,0 +1,257 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "AttachmentPointIndex.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Forget all attachment points.
+	/// </summary>
+	void FAttachmentPointIndex::Reset()
+	{
+		cells.Empty();
+		positions.Empty();
+	}
+
+	/// <summary>
+	/// Set the size of the grid cells, and rebucket any existing attachment points.
+	///
+	/// Queries are cheapest when the cell size is close to the typical query radius.
+	/// </summary>
+	void FAttachmentPointIndex::SetCellSize(float InCellSize)
+	{
+		InCellSize = FMath::Max(InCellSize, 1.0f);
+		if (InCellSize == cellSize)
+		{
+			return;
+		}
+
+		cellSize = InCellSize;
+		cells.Empty();
+		for (const auto& entry : positions)
+		{
+			AddToCell(entry.Key, entry.Value);
+		}
+	}
+
+	/// <summary>
+	/// Add an attachment point at a position, or move it there if already indexed.
+	/// </summary>
+	void FAttachmentPointIndex::Update(FAttachmentPointHandle handle, FVector position)
+	{
+		FVector* oldPosition = positions.Find(handle);
+		if (oldPosition == nullptr)
+		{
+			positions.Add(handle, position);
+			AddToCell(handle, position);
+			return;
+		}
+
+		if (CellOf(*oldPosition) != CellOf(position))
+		{
+			RemoveFromCell(handle, *oldPosition);
+			AddToCell(handle, position);
+		}
+		*oldPosition = position;
+	}
+
+	void FAttachmentPointIndex::Remove(FAttachmentPointHandle handle)
+	{
+		FVector position;
+		if (positions.RemoveAndCopyValue(handle, position))
+		{
+			RemoveFromCell(handle, position);
+		}
+	}
+
+	/// <summary>
+	/// Call visit on each occupied cell between minCell and maxCell inclusive.
+	/// </summary>
+	template<typename FunctionType>
+	void FAttachmentPointIndex::ForEachCell(const FIntVector& minCell, const FIntVector& maxCell, FunctionType visit) const
+	{
+		int64 numCells = (int64)(maxCell.X - minCell.X + 1) * (maxCell.Y - minCell.Y + 1) * (maxCell.Z - minCell.Z + 1);
+		if (numCells > cells.Num())
+		{
+			for (const auto& entry : cells)
+			{
+				const FIntVector& key = entry.Key;
+				if (key.X >= minCell.X && key.X <= maxCell.X
+					&& key.Y >= minCell.Y && key.Y <= maxCell.Y
+					&& key.Z >= minCell.Z && key.Z <= maxCell.Z)
+				{
+					visit(entry.Value);
+				}
+			}
+			return;
+		}
+
+		for (int x = minCell.X; x <= maxCell.X; ++x)
+		{
+			for (int y = minCell.Y; y <= maxCell.Y; ++y)
+			{
+				for (int z = minCell.Z; z <= maxCell.Z; ++z)
+				{
+					if (const TArray<FAttachmentPointHandle>* cell = cells.Find(FIntVector(x, y, z)))
+					{
+						visit(*cell);
+					}
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Find all attachment points within radius of the position, in no particular order.
+	/// </summary>
+	/// <param name="filter">Attachment points for which this returns false are skipped.</param>
+	/// <param name="outHandles">Found attachment points are appended to this.</param>
+	void FAttachmentPointIndex::FindInRadius(FVector position, float radius, TFunctionRef<bool(FAttachmentPointHandle)> filter,
+		TArray<FAttachmentPointHandle>& outHandles) const
+	{
+		if (radius < 0)
+		{
+			return;
+		}
+
+		double radiusSqr = (double)radius * radius;
+		FVector extent(radius);
+		ForEachCell(CellOf(position - extent), CellOf(position + extent), [&](const TArray<FAttachmentPointHandle>& cell)
+		{
+			for (const auto& handle : cell)
+			{
+				if ((positions[handle] - position).SquaredLength() <= radiusSqr && filter(handle))
+				{
+					outHandles.Add(handle);
+				}
+			}
+		});
+	}
+
+	/// <summary>
+	/// Find all attachment points inside the box, in no particular order.
+	/// </summary>
+	/// <param name="filter">Attachment points for which this returns false are skipped.</param>
+	/// <param name="outHandles">Found attachment points are appended to this.</param>
+	void FAttachmentPointIndex::FindInBox(const FBox& box, TFunctionRef<bool(FAttachmentPointHandle)> filter,
+		TArray<FAttachmentPointHandle>& outHandles) const
+	{
+		if (!box.IsValid)
+		{
+			return;
+		}
+
+		ForEachCell(CellOf(box.Min), CellOf(box.Max), [&](const TArray<FAttachmentPointHandle>& cell)
+		{
+			for (const auto& handle : cell)
+			{
+				if (box.IsInsideOrOn(positions[handle]) && filter(handle))
+				{
+					outHandles.Add(handle);
+				}
+			}
+		});
+	}
+
+	/// <summary>
+	/// Find the attachment point nearest to the position.
+	///
+	/// Cells are searched in growing shells around the position's cell, until no unvisited cell can hold anything nearer
+	/// than what has been found.
+	/// </summary>
+	/// <param name="maxDistance">Attachment points further away are ignored, zero or negative for no limit.</param>
+	/// <param name="filter">Attachment points for which this returns false are skipped.</param>
+	/// <returns>The nearest attachment point, or an invalid handle if there is none.</returns>
+	FAttachmentPointHandle FAttachmentPointIndex::FindNearest(FVector position, float maxDistance,
+		TFunctionRef<bool(FAttachmentPointHandle)> filter) const
+	{
+		FAttachmentPointHandle nearest;
+		double nearestDistSqr = maxDistance > 0 ? (double)maxDistance * maxDistance : MAX_dbl;
+
+		auto visit = [&](const TArray<FAttachmentPointHandle>& cell)
+		{
+			for (const auto& handle : cell)
+			{
+				double distSqr = (positions[handle] - position).SquaredLength();
+				if (distSqr <= nearestDistSqr && filter(handle))
+				{
+					nearest = handle;
+					nearestDistSqr = distSqr;
+				}
+			}
+		};
+
+		FIntVector center = CellOf(position);
+		for (int range = 0; cells.Num() > 0; ++range)
+		{
+			// Everything in shells beyond this one is at least this far away.
+			double shellDistance = (double)range * cellSize;
+			if (nearest.IsValid() && nearestDistSqr <= shellDistance * shellDistance)
+			{
+				break;
+			}
+			if (maxDistance > 0 && shellDistance > maxDistance)
+			{
+				break;
+			}
+
+			int side = 2 * range + 1;
+			if ((int64)side * side * side > cells.Num())
+			{
+				// Past here, visiting the occupied cells is cheaper than growing the shell.
+				for (const auto& entry : cells)
+				{
+					visit(entry.Value);
+				}
+				break;
+			}
+
+			for (int x = -range; x <= range; ++x)
+			{
+				for (int y = -range; y <= range; ++y)
+				{
+					for (int z = -range; z <= range; ++z)
+					{
+						if (FMath::Max3(FMath::Abs(x), FMath::Abs(y), FMath::Abs(z)) != range)
+						{
+							continue;
+						}
+
+						if (const TArray<FAttachmentPointHandle>* cell = cells.Find(center + FIntVector(x, y, z)))
+						{
+							visit(*cell);
+						}
+					}
+				}
+			}
+		}
+		return nearest;
+	}
+
+	FIntVector FAttachmentPointIndex::CellOf(FVector position) const
+	{
+		return FIntVector(
+			FMath::FloorToInt(position.X / cellSize),
+			FMath::FloorToInt(position.Y / cellSize),
+			FMath::FloorToInt(position.Z / cellSize));
+	}
+
+	void FAttachmentPointIndex::AddToCell(FAttachmentPointHandle handle, FVector position)
+	{
+		cells.FindOrAdd(CellOf(position)).Add(handle);
+	}
+
+	void FAttachmentPointIndex::RemoveFromCell(FAttachmentPointHandle handle, FVector position)
+	{
+		FIntVector cellKey = CellOf(position);
+		if (TArray<FAttachmentPointHandle>* cell = cells.Find(cellKey))
+		{
+			cell->RemoveSwap(handle);
+			if (cell->Num() == 0)
+			{
+				cells.Remove(cellKey);
+			}
+		}
+	}
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "AttachmentPoint.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Spatial index of attachment points by the frozen position of their attached objects.
+	///
+	/// Positions are bucketed in a uniform grid, like FAnchorGraph does for anchors, so a query only visits the
+	/// attachment points in the cells it overlaps. A query covering more cells than are occupied visits the occupied cells instead.
+	/// Positions are whatever was last passed to Update, the owner is expected to update them as attachment points move or are adjusted.
+	/// </summary>
+	class FAttachmentPointIndex
+	{
+	public:
+		void Reset();
+
+		void SetCellSize(float InCellSize);
+
+		float GetCellSize() const
+		{
+			return cellSize;
+		}
+
+		void Update(FAttachmentPointHandle handle, FVector position);
+		void Remove(FAttachmentPointHandle handle);
+
+		bool Contains(FAttachmentPointHandle handle) const
+		{
+			return positions.Contains(handle);
+		}
+
+		int Num() const
+		{
+			return positions.Num();
+		}
+
+		void FindInRadius(FVector position, float radius, TFunctionRef<bool(FAttachmentPointHandle)> filter,
+			TArray<FAttachmentPointHandle>& outHandles) const;
+
+		void FindInBox(const FBox& box, TFunctionRef<bool(FAttachmentPointHandle)> filter,
+			TArray<FAttachmentPointHandle>& outHandles) const;
+
+		FAttachmentPointHandle FindNearest(FVector position, float maxDistance, TFunctionRef<bool(FAttachmentPointHandle)> filter) const;
+
+	private:
+		FIntVector CellOf(FVector position) const;
+
+		void AddToCell(FAttachmentPointHandle handle, FVector position);
+		void RemoveFromCell(FAttachmentPointHandle handle, FVector position);
+
+		template<typename FunctionType>
+		void ForEachCell(const FIntVector& minCell, const FIntVector& maxCell, FunctionType visit) const;
+
+	private:
+		float cellSize = 200.0f;
+
+		TMap<FIntVector, TArray<FAttachmentPointHandle>> cells;
+		TMap<FAttachmentPointHandle, FVector> positions;
+	};
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "AttachmentPointPool.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Create a new attachment point, reusing a released slot if there is one.
+	/// </summary>
+	/// <returns>Handle to the new attachment point.</returns>
+	FAttachmentPointHandle FAttachmentPointPool::Allocate(FAttachmentPoint::FAdjustLocationDelegate locationHandler, FAttachmentPoint::FAdjustStateDelegate stateHandler)
+	{
+		uint32 slotIndex;
+		if (freeSlots.Num() > 0)
+		{
+			slotIndex = freeSlots.Pop(false);
+		}
+		else
+		{
+			slotIndex = slots.AddDefaulted();
+		}
+
+		FSlot& slot = slots[slotIndex];
+		slot.DenseIndex = points.Emplace(locationHandler, stateHandler);
+		slotOfPoint.Add(slotIndex);
+
+		FAttachmentPointHandle handle{ slotIndex, slot.Generation };
+		points[slot.DenseIndex].Handle = handle;
+		return handle;
+	}
+
+	/// <summary>
+	/// Destroy an attachment point, invalidating all handles to it.
+	///
+	/// The last attachment point in storage takes the released one's place, so this is constant time.
+	/// </summary>
+	/// <returns>False if the handle was already stale.</returns>
+	bool FAttachmentPointPool::Release(FAttachmentPointHandle handle)
+	{
+		if (!Contains(handle))
+		{
+			return false;
+		}
+
+		FSlot& slot = slots[handle.Index];
+		int32 denseIndex = slot.DenseIndex;
+		int32 lastIndex = points.Num() - 1;
+		if (denseIndex != lastIndex)
+		{
+			slots[slotOfPoint[lastIndex]].DenseIndex = denseIndex;
+		}
+		points.RemoveAtSwap(denseIndex, 1, false);
+		slotOfPoint.RemoveAtSwap(denseIndex, 1, false);
+
+		slot.DenseIndex = INDEX_NONE;
+		// Skip generation zero, which marks a default constructed handle.
+		slot.Generation = FMath::Max(slot.Generation + 1, 1u);
+		freeSlots.Add(handle.Index);
+
+		return true;
+	}
+
+	/// <summary>
+	/// Destroy all attachment points, invalidating all outstanding handles.
+	/// </summary>
+	void FAttachmentPointPool::Reset()
+	{
+		for (int32 i = points.Num() - 1; i >= 0; --i)
+		{
+			FSlot& slot = slots[slotOfPoint[i]];
+			slot.DenseIndex = INDEX_NONE;
+			slot.Generation = FMath::Max(slot.Generation + 1, 1u);
+			freeSlots.Add(slotOfPoint[i]);
+		}
+		points.Reset();
+		slotOfPoint.Reset();
+	}
+
+	/// <summary>
+	/// Poll attachment points for adjustments and state changes.
+	/// 
+	/// Only the attachment points asked for are looked at, so objects that aren't needed this frame cost nothing.
+	/// Released attachment points are always reported, with state Released.
+	/// </summary>
+	/// <param name="sinceEpoch">Epoch returned by the previous poll, zero to get all.</param>
+	/// <param name="handles">The attachment points of interest.</param>
+	/// <param name="outChanges">Receives the attachment points changed since the epoch.</param>
+	/// <returns>Epoch to pass to the next poll.</returns>
+	uint64 FAttachmentPointPool::GetChangesSince(uint64 sinceEpoch, TArrayView<const FAttachmentPointHandle> handles, TArray<AttachmentPointChange>& outChanges) const
+	{
+		for (const FAttachmentPointHandle& handle : handles)
+		{
+			const FAttachmentPoint* attachPoint = Get(handle);
+			if (attachPoint == nullptr)
+			{
+				outChanges.Add(AttachmentPointChange{ handle, FTransform::Identity, FVector::ZeroVector, AttachmentPointStateType::Released, FAttachmentPoint::LatestEpoch });
+			}
+			else if (attachPoint->Epoch > sinceEpoch)
+			{
+				outChanges.Add(AttachmentPointChange{ handle, attachPoint->ObjectAdjustment, attachPoint->ObjectPosition, attachPoint->State, attachPoint->Epoch });
+			}
+		}
+		return FAttachmentPoint::LatestEpoch;
+	}
+
+	/// <summary>
+	/// Resolve a handle.
+	/// </summary>
+	/// <returns>The attachment point, or null if the handle is stale or was never valid.</returns>
+	FAttachmentPoint* FAttachmentPointPool::Get(FAttachmentPointHandle handle)
+	{
+		return const_cast<FAttachmentPoint*>(static_cast<const FAttachmentPointPool*>(this)->Get(handle));
+	}
+
+	const FAttachmentPoint* FAttachmentPointPool::Get(FAttachmentPointHandle handle) const
+	{
+		if (!handle.IsValid() || !slots.IsValidIndex(handle.Index))
+		{
+			return nullptr;
+		}
+
+		const FSlot& slot = slots[handle.Index];
+		if (slot.Generation != handle.Generation || slot.DenseIndex == INDEX_NONE)
+		{
+			return nullptr;
+		}
+		return &points[slot.DenseIndex];
+	}
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "AttachmentPoint.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Generational slot map owning all attachment points.
+	///
+	/// Attachment points are stored contiguously, so walking over them doesn't chase pointers,
+	/// and released by swapping the last attachment point into the released one's place.
+	/// Handles go through a slot table, which follows attachment points as they move.
+	/// Each slot carries a generation, bumped on release, so a stale handle never resolves to
+	/// the attachment point that later reuses its slot.
+	///
+	/// Pointers returned by Get are only valid until the next Allocate or Release.
+	/// </summary>
+	class FAttachmentPointPool
+	{
+	public:
+		FAttachmentPointHandle Allocate(FAttachmentPoint::FAdjustLocationDelegate locationHandler, FAttachmentPoint::FAdjustStateDelegate stateHandler);
+		bool Release(FAttachmentPointHandle handle);
+		void Reset();
+
+		FAttachmentPoint* Get(FAttachmentPointHandle handle);
+		const FAttachmentPoint* Get(FAttachmentPointHandle handle) const;
+
+		bool Contains(FAttachmentPointHandle handle) const
+		{
+			return Get(handle) != nullptr;
+		}
+
+		int Num() const
+		{
+			return points.Num();
+		}
+
+		uint64 GetChangesSince(uint64 sinceEpoch, TArrayView<const FAttachmentPointHandle> handles, TArray<AttachmentPointChange>& outChanges) const;
+
+		// Live attachment points, in no particular order.
+		TArrayView<FAttachmentPoint> GetAttachmentPoints()
+		{
+			return points;
+		}
+
+	private:
+		struct FSlot
+		{
+			int32 DenseIndex = INDEX_NONE;
+			uint32 Generation = 1;
+		};
+
+		TArray<FAttachmentPoint> points;
+		TArray<uint32> slotOfPoint;
+		TArray<FSlot> slots;
+		TArray<uint32> freeSlots;
+	};
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "DeferredAdjustments.h"
+#include "FragmentManager.h"
+
+namespace WorldLockingTools
+{
+	FDeferredAdjustments::FDeferredAdjustments(FAttachmentPointPool& attachmentPointPool, const TMap<FrozenWorld_FragmentId, TSharedPtr<FFragment>>& fragmentsById) :
+		attachmentPoints(attachmentPointPool),
+		fragments(fragmentsById)
+	{
+	}
+
+	/// <summary>
+	/// Drop the adjustments not applied yet, leaving their attachment points to their fragments' state changes again.
+	/// </summary>
+	void FDeferredAdjustments::Reset()
+	{
+		for (int i = next; i < adjustments.Num(); ++i)
+		{
+			if (FAttachmentPoint* attach = attachmentPoints.Get(adjustments[i].target))
+			{
+				attach->AdjustmentDeferred = false;
+			}
+		}
+		adjustments.Empty();
+		next = 0;
+	}
+
+	/// <summary>
+	/// Start collecting the adjustments of a refit.
+	///
+	/// Whatever is left of the previous refit's adjustments must have been applied first, so that each attachment point
+	/// has at most one adjustment outstanding.
+	/// </summary>
+	/// <returns>The list to add the deferred adjustments to.</returns>
+	TArray<DeferredAdjustment>* FDeferredAdjustments::Begin()
+	{
+		check(Num() == 0);
+		return &adjustments;
+	}
+
+	/// <summary>
+	/// Order the adjustments not applied yet so those the user is most likely to notice are applied first.
+	///
+	/// Attachment points are ordered by FFragmentManager::GetPriority.
+	/// </summary>
+	void FDeferredAdjustments::Prioritize(const FTransform& lockedHead)
+	{
+		TArrayView<DeferredAdjustment> remaining(adjustments.GetData() + next, Num());
+		for (auto& entry : remaining)
+		{
+			const FAttachmentPoint* attach = attachmentPoints.Get(entry.target);
+			entry.priority = attach != nullptr ? FFragmentManager::GetPriority(attach->ObjectPosition, lockedHead) : MAX_flt;
+		}
+
+		remaining.Sort([](const DeferredAdjustment& a, const DeferredAdjustment& b)
+		{
+			return a.priority < b.priority;
+		});
+	}
+
+	/// <summary>
+	/// Apply the adjustments to their attachment points, notifying their clients of the adjustment and of their fragment's state,
+	/// until out of time.
+	/// </summary>
+	/// <param name="budgetMicroseconds">CPU time to spend, zero or negative for no limit.</param>
+	/// <param name="applied">Called for each attachment point adjusted, after its clients have been notified.</param>
+	void FDeferredAdjustments::Apply(float budgetMicroseconds, TFunctionRef<void(FAttachmentPointHandle)> applied)
+	{
+		if (next >= adjustments.Num())
+		{
+			return;
+		}
+
+		const int checkTimeInterval = 16;
+		double endTime = FPlatformTime::Seconds() + budgetMicroseconds * 1e-6;
+		int count = adjustments.Num();
+		while (next < count)
+		{
+			// Copy the entry, client handlers might release attachment points and so on while being notified.
+			DeferredAdjustment entry = adjustments[next++];
+
+			FAttachmentPoint* attach = attachmentPoints.Get(entry.target);
+			if (attach != nullptr)
+			{
+				attach->AdjustmentDeferred = false;
+			}
+
+			const TSharedPtr<FFragment>* fragment = attach != nullptr ? fragments.Find(attach->FragmentId) : nullptr;
+			if (fragment != nullptr)
+			{
+				AttachmentPointStateType state = (*fragment)->State;
+				if (entry.adjusted)
+				{
+					attach->HandlePoseAdjustment(entry.adjustment);
+				}
+
+				// The handler may have released it.
+				if (FAttachmentPoint* notified = attachmentPoints.Get(entry.target))
+				{
+					notified->HandleStateChange(state);
+				}
+				applied(entry.target);
+			}
+
+			if (budgetMicroseconds > 0
+				&& next % checkTimeInterval == 0
+				&& FPlatformTime::Seconds() >= endTime)
+			{
+				break;
+			}
+		}
+
+		if (next >= count)
+		{
+			adjustments.Reset();
+			next = 0;
+		}
+	}
+}
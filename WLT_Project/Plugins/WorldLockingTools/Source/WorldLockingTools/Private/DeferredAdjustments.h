@@ -0,0 +1,45 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "AttachmentPoint.h"
+#include "AttachmentPointPool.h"
+#include "Fragment.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Refit adjustments of attachment points, put off to be applied over the following frames.
+	///
+	/// A refit adds the adjustments it defers to the list from Begin, marking their attachment points as AdjustmentDeferred.
+	/// Fragments leave marked attachment points out of their state changes, they get their fragment's state
+	/// when their adjustment is applied, so clients never see an attachment point connected before it is adjusted.
+	/// </summary>
+	class FDeferredAdjustments
+	{
+	public:
+		FDeferredAdjustments(FAttachmentPointPool& attachmentPointPool, const TMap<FrozenWorld_FragmentId, TSharedPtr<FFragment>>& fragmentsById);
+
+		void Reset();
+
+		// Attachment points still waiting for their adjustment.
+		int Num() const
+		{
+			return adjustments.Num() - next;
+		}
+
+		TArray<DeferredAdjustment>* Begin();
+		void Prioritize(const FTransform& lockedHead);
+		void Apply(float budgetMicroseconds, TFunctionRef<void(FAttachmentPointHandle)> applied);
+
+	private:
+		FAttachmentPointPool& attachmentPoints;
+		const TMap<FrozenWorld_FragmentId, TSharedPtr<FFragment>>& fragments;
+
+		TArray<DeferredAdjustment> adjustments;
+		int next = 0;
+	};
+}
@@ -4,18 +4,22 @@
 #include "Fragment.h"
 #include "FrozenWorldInterop.h"
 #include "FrozenWorldPlugin.h"
+#include "FrozenWorldPoseExtensions.h"
 
 #include "WorldLockingToolsModule.h"
 
 namespace WorldLockingTools
 {
-	FFragment::FFragment(FrozenWorld_FragmentId fragmentId) :
-		FragmentId(fragmentId)
+	FFragment::FFragment(FrozenWorld_FragmentId fragmentId, FAttachmentPointPool& attachmentPointPool) :
+		FragmentId(fragmentId),
+		attachmentPoints(attachmentPointPool)
 	{
 	}
 
 	/// <summary>
 	/// Set the state of the contents of this fragment.
+	/// 
+	/// Attachment points whose refit adjustment is deferred are left alone, they get the state along with their adjustment.
 	/// </summary>
 	void FFragment::UpdateState(AttachmentPointStateType attachmentState)
 	{
@@ -24,11 +28,14 @@ namespace WorldLockingTools
 		{
 			State = attachmentState;
 
-			for (const auto& updateStateAttachment : updateStateAllAttachments)
+			// Client handlers may release or teleport attachment points while being notified, so work on a copy.
+			TArray<FAttachmentPointHandle> handles = attachmentList;
+			for (const auto& handle : handles)
 			{
-				if (updateStateAttachment.IsBound())
+				FAttachmentPoint* att = attachmentPoints.Get(handle);
+				if (att != nullptr && !att->AdjustmentDeferred)
 				{
-					updateStateAttachment.ExecuteIfBound(attachmentState);
+					att->HandleStateChange(attachmentState);
 				}
 			}
 		}
@@ -38,70 +45,148 @@ namespace WorldLockingTools
 	/// Add an existing attachment point to this fragment.
 	/// 
 	/// The attachment point might currently belong to another fragment, if
-	/// it is being moved from the other to this.
-	/// Since this is only used internally, it operates directly on an AttachmentPoint
-	/// rather than an interface to avoid an unnecessary downcast.
+	/// it is being moved from the other to this, in which case it must have been removed from the other first.
 	/// </summary>
-	void FFragment::AddAttachmentPoint(TSharedPtr<FAttachmentPoint> attachPoint)
+	void FFragment::AddAttachmentPoint(FAttachmentPointHandle attachPoint)
 	{
-		if (attachPoint->StateHandler.IsBound())
+		FAttachmentPoint* att = attachmentPoints.Get(attachPoint);
+		if (att == nullptr)
 		{
-			updateStateAllAttachments.Add(attachPoint->StateHandler);
+			UE_LOG(LogWLT, Error, TEXT("Adding a released attachment point to fragment %d."), FragmentId);
+			return;
 		}
+		check(att->FragmentIndex == INDEX_NONE); // Attachment point still held by another fragment.
+
+		att->FragmentIndex = attachmentList.Add(attachPoint);
+		ExpandBounds(att->ObjectPosition);
+		att->HandleStateChange(State);
+	}
 
-		attachPoint->HandleStateChange(State);
-		attachmentList.Add(attachPoint);
+	/// <summary>
+	/// Take an attachment point out of this fragment, without notifying it.
+	/// 
+	/// The last attachment point in the list takes its place, so this is constant time.
+	/// </summary>
+	void FFragment::RemoveAttachmentPoint(FAttachmentPointHandle attachPoint)
+	{
+		FAttachmentPoint* att = attachmentPoints.Get(attachPoint);
+		if (att == nullptr || !attachmentList.IsValidIndex(att->FragmentIndex) || attachmentList[att->FragmentIndex] != attachPoint)
+		{
+			return;
+		}
+
+		int index = att->FragmentIndex;
+		attachmentList.RemoveAtSwap(index, 1, false);
+		if (index < attachmentList.Num())
+		{
+			attachmentPoints.Get(attachmentList[index])->FragmentIndex = index;
+		}
+		att->FragmentIndex = INDEX_NONE;
 	}
 
 	/// <summary>
 	/// Notify system attachment point is no longer needed. See FAttachmentPointManager::ReleaseAttachmentPoint
 	/// </summary>
-	void FFragment::ReleaseAttachmentPoint(TSharedPtr<FAttachmentPoint> attachmentPoint)
+	void FFragment::ReleaseAttachmentPoint(FAttachmentPointHandle attachmentPoint)
 	{
-		if (attachmentPoint != nullptr)
+		if (FAttachmentPoint* att = attachmentPoints.Get(attachmentPoint))
 		{
-			if (attachmentPoint->StateHandler.IsBound())
+			if (att->StateHandler.IsBound())
 			{
-				attachmentPoint->StateHandler.Unbind();
+				att->StateHandler.Unbind();
 			}
-			attachmentPoint->HandleStateChange(AttachmentPointStateType::Released);
-			attachmentList.Remove(attachmentPoint);
+			att->HandleStateChange(AttachmentPointStateType::Released);
+			RemoveAttachmentPoint(attachmentPoint);
 		}
 		else
 		{
-			UE_LOG(LogWLT, Error, TEXT("On release, IAttachmentPoint isn't AttachmentPoint."));
+			UE_LOG(LogWLT, Error, TEXT("On release, attachment point was already released."));
 		}
 	}
 
 	/// <summary>
 	/// Release all resources for this fragment.
+	/// 
+	/// The attachment points themselves are left in the pool, they belong to the clients that created them.
 	/// </summary>
 	void FFragment::ReleaseAll()
 	{
-		updateStateAllAttachments.Empty();
+		for (const auto& handle : attachmentList)
+		{
+			if (FAttachmentPoint* att = attachmentPoints.Get(handle))
+			{
+				att->FragmentIndex = INDEX_NONE;
+			}
+		}
 		attachmentList.Empty();
+		Bounds = FBox(ForceInit);
+	}
+
+	/// <summary>
+	/// Move the attachment points of another fragment's list into this one.
+	/// 
+	/// The larger of the two lists is kept and the smaller appended to it, so only the smaller list's
+	/// elements are relocated.
+	/// The order of attachment points within a fragment is not significant.
+	/// </summary>
+	/// <param name="otherList">The list to splice in, left empty.</param>
+	/// <returns>Index in attachmentList of the first attachment point spliced in, the spliced in points follow it contiguously.</returns>
+	int FFragment::SpliceAttachmentPoints(TArray<FAttachmentPointHandle>&& otherList)
+	{
+		int ownCount = attachmentList.Num();
+		int first = ownCount;
+		if (otherList.Num() > ownCount)
+		{
+			// Keep the other storage, with the spliced in points at the front, and put our own points after it.
+			Swap(attachmentList, otherList);
+			first = 0;
+		}
+
+		int relocated = attachmentList.Num();
+		attachmentList.Append(MoveTemp(otherList));
+		otherList.Empty();
+
+		for (int i = relocated; i < attachmentList.Num(); ++i)
+		{
+			attachmentPoints.Get(attachmentList[i])->FragmentIndex = i;
+		}
+		return first;
 	}
 
 	/// <summary>
 	/// Absorb the contents of another fragment, emptying it.
 	/// </summary>
 	/// <param name="other">The fragment to lose all its contents to this.</param>
-	void FFragment::AbsorbOtherFragment(FFragment other)
+	/// <param name="deferred">
+	/// If given, the absorbed attachment points aren't notified of their new state,
+	/// that is left to the adjustments AdjustAll defers for them.
+	/// </param>
+	void FFragment::AbsorbOtherFragment(FFragment&& other, TArray<DeferredAdjustment>* deferred)
 	{
 		check(&other != this); // Trying to merge to and from the same fragment
+		check(&other.attachmentPoints == &attachmentPoints); // Fragments from different managers
 		int otherCount = other.attachmentList.Num();
-		for (int i = 0; i < otherCount; ++i)
+		int first = SpliceAttachmentPoints(MoveTemp(other.attachmentList));
+		// Client handlers may release or teleport attachment points while being notified, so work on a copy.
+		TArray<FAttachmentPointHandle> handles(attachmentList.GetData() + first, otherCount);
+		for (const auto& handle : handles)
 		{
-			TSharedPtr<FAttachmentPoint> att = other.attachmentList[i];
+			FAttachmentPoint* att = attachmentPoints.Get(handle);
 			att->Set(FragmentId, att->CachedPosition, att->AnchorId, att->LocationFromAnchor);
-			if (att->StateHandler.IsBound())
+			ExpandBounds(att->ObjectPosition);
+		}
+		other.ReleaseAll();
+
+		if (deferred == nullptr)
+		{
+			for (const auto& handle : handles)
 			{
-				updateStateAllAttachments.Add(att->StateHandler);
+				if (FAttachmentPoint* att = attachmentPoints.Get(handle))
+				{
+					att->HandleStateChange(State);
+				}
 			}
-			att->HandleStateChange(State);
-			attachmentList.Add(att);
 		}
-		other.ReleaseAll();
 	}
 
 	/// <summary>
@@ -109,51 +194,155 @@ namespace WorldLockingTools
 	/// </summary>
 	/// <param name="other">The fragment to lose all its contents to this.</param>
 	/// <param name="adjustment">Pose adjustment to apply to contents of other on transition.</param>
-	void FFragment::AbsorbOtherFragment(FFragment other, FTransform adjustment)
+	/// <param name="deferred">If given, applying the adjustment and notifying the absorbed attachment points is added to it instead of done here.</param>
+	void FFragment::AbsorbOtherFragment(FFragment&& other, FTransform adjustment, TArray<DeferredAdjustment>* deferred)
 	{
 		check(&other != this); // Trying to merge to and from the same fragment
+		check(&other.attachmentPoints == &attachmentPoints); // Fragments from different managers
 		int otherCount = other.attachmentList.Num();
-		for (int i = 0; i < otherCount; ++i)
+		int first = SpliceAttachmentPoints(MoveTemp(other.attachmentList));
+		// Client handlers may release or teleport attachment points while being notified, so work on a copy.
+		TArray<FAttachmentPointHandle> handles(attachmentList.GetData() + first, otherCount);
+		for (const auto& handle : handles)
 		{
-			TSharedPtr<FAttachmentPoint> att = other.attachmentList[i];
+			FAttachmentPoint* att = attachmentPoints.Get(handle);
 			att->Set(FragmentId, att->CachedPosition, att->AnchorId, att->LocationFromAnchor);
-			att->HandlePoseAdjustment(adjustment);
-			if (att->StateHandler.IsBound())
+			if (deferred != nullptr)
 			{
-				updateStateAllAttachments.Add(att->StateHandler);
+				// Until the adjustment is applied, the attached object stays where it was.
+				ExpandBounds(att->ObjectPosition);
+				att->AdjustmentDeferred = true;
+				deferred->Add(DeferredAdjustment{ handle, adjustment, true, 0.0f });
 			}
-			att->HandleStateChange(State);
-			attachmentList.Add(att);
 		}
 		other.ReleaseAll();
+
+		if (deferred != nullptr)
+		{
+			return;
+		}
+		for (const auto& handle : handles)
+		{
+			if (FAttachmentPoint* att = attachmentPoints.Get(handle))
+			{
+				att->HandlePoseAdjustment(adjustment);
+			}
+
+			// The handler may have released it.
+			if (FAttachmentPoint* att = attachmentPoints.Get(handle))
+			{
+				ExpandBounds(att->ObjectPosition);
+				att->HandleStateChange(State);
+			}
+		}
 	}
 
 	/// <summary>
 	/// Run through all attachment points, get their adjustments from the plugin and apply them.
 	/// 
+	/// The adjustments are computed in one batch, optionally spread over worker threads, and then applied on the game thread,
+	/// since applying them calls back into client code.
 	/// This must be called between FFrozenWorldPlugin::Refreeze() and FFrozenWorldPlugin::RefreezeFinish().
 	/// </summary>
-	void FFragment::AdjustAll()
+	/// <param name="batchSize">Attachment points per worker task, zero or negative to compute all on the game thread.</param>
+	/// <param name="deferred">
+	/// If given, only the anchoring of the attachment points is updated here, applying their adjustments
+	/// and notifying them is added to it.
+	/// </param>
+	void FFragment::AdjustAll(int batchSize, TArray<DeferredAdjustment>* deferred)
+	{
+		AdjustAll([batchSize](TArrayView<AttachmentPointAdjustment> adjustments)
+		{
+			FFrozenWorldPlugin::Get()->ComputeAttachmentPointAdjustments(adjustments, batchSize);
+		}, deferred);
+	}
+
+	/// <summary>
+	/// Run through all attachment points, and apply the adjustments computed for them by the given function.
+	/// 
+	/// See AdjustAll above, which has the FrozenWorld engine compute them. This allows running the refit
+	/// bookkeeping against a stand-in for the engine.
+	/// </summary>
+	/// <param name="computeAdjustments">Fills in the adjustment and new anchoring of each attachment point passed in.</param>
+	/// <param name="deferred">See AdjustAll above.</param>
+	void FFragment::AdjustAll(TFunctionRef<void(TArrayView<AttachmentPointAdjustment>)> computeAdjustments, TArray<DeferredAdjustment>* deferred)
 	{
-		int count = attachmentList.Num();
+		// Client handlers may teleport attachment points between fragments while adjustments are applied, so work on a copy.
+		TArray<FAttachmentPointHandle> handles = attachmentList;
+		int count = handles.Num();
+
+		TArray<AttachmentPointAdjustment> adjustments;
+		adjustments.SetNumUninitialized(count);
 		for (int i = 0; i < count; ++i)
 		{
-			TSharedPtr<FAttachmentPoint> attach = attachmentList[i];
+			const FAttachmentPoint* attach = attachmentPoints.Get(handles[i]);
+			adjustments[i].anchorId = attach->AnchorId;
+			adjustments[i].locationFromAnchor = attach->LocationFromAnchor;
+		}
+
+		computeAdjustments(adjustments);
 
-			FrozenWorld_AnchorId newAnchorId;
-			FVector newLocationFromAnchor;
-			FTransform adjustment;
-			if (FFrozenWorldPlugin::Get()->ComputeAttachmentPointAdjustment(attach->AnchorId, attach->LocationFromAnchor,
-				newAnchorId, newLocationFromAnchor, adjustment))
+		for (int i = 0; i < count; ++i)
+		{
+			FAttachmentPoint* attach = attachmentPoints.Get(handles[i]);
+			if (attach == nullptr)
 			{
-				attach->Set(FragmentId, attach->CachedPosition, newAnchorId, newLocationFromAnchor);
+				continue;
+			}
 
-				attach->HandlePoseAdjustment(adjustment);
+			const AttachmentPointAdjustment& result = adjustments[i];
+			if (result.adjusted)
+			{
+				attach->Set(FragmentId, attach->CachedPosition, result.anchorId, result.locationFromAnchor);
 			}
 			else
 			{
 				UE_LOG(LogWLT, Warning, TEXT("No adjustment during refreeze for %d"), attach->AnchorId);
 			}
+
+			if (deferred != nullptr)
+			{
+				attach->AdjustmentDeferred = true;
+				deferred->Add(DeferredAdjustment{ handles[i], result.adjustment, result.adjusted, 0.0f });
+			}
+			else if (result.adjusted)
+			{
+				attach->HandlePoseAdjustment(result.adjustment);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Fit the bounds tightly around the attached objects of this fragment's attachment points.
+	/// </summary>
+	void FFragment::RecomputeBounds()
+	{
+		Bounds = FBox(ForceInit);
+		for (const auto& handle : attachmentList)
+		{
+			if (const FAttachmentPoint* attach = attachmentPoints.Get(handle))
+			{
+				Bounds += attach->ObjectPosition;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Move the attachment points on an anchor that is going away to another anchor, without moving them.
+	/// </summary>
+	/// <param name="oldAnchorId">The anchor going away.</param>
+	/// <param name="newAnchorId">The anchor taking over its attachment points.</param>
+	/// <param name="newAnchorFromOldAnchor">Frozen pose of the old anchor relative to the new one.</param>
+	void FFragment::ReassignAnchor(FrozenWorld_AnchorId oldAnchorId, FrozenWorld_AnchorId newAnchorId, FTransform newAnchorFromOldAnchor)
+	{
+		for (const auto& handle : attachmentList)
+		{
+			FAttachmentPoint* attach = attachmentPoints.Get(handle);
+			if (attach->AnchorId == oldAnchorId)
+			{
+				attach->Set(FragmentId, attach->CachedPosition, newAnchorId,
+					FFrozenWorldPoseExtensions::Multiply(newAnchorFromOldAnchor, attach->LocationFromAnchor));
+			}
 		}
 	}
-}
\ No newline at end of file
+}
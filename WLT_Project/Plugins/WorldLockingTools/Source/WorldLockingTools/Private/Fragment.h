@@ -9,37 +9,83 @@
 #pragma warning(pop)
 
 #include "AttachmentPoint.h"
+#include "AttachmentPointPool.h"
+#include "FrozenWorldInterop.h"
 
 namespace WorldLockingTools
 {
+	/// <summary>
+	/// Adjustment of an attachment point from a refit, whose application has been put off.
+	/// 
+	/// The attachment point's anchoring is already up to date, what is left is adjusting the
+	/// attached object and notifying the client of the adjustment and of its fragment's state.
+	/// </summary>
+	struct DeferredAdjustment
+	{
+		FAttachmentPointHandle target;
+		FTransform adjustment;
+		bool adjusted;
+		float priority;
+	};
+
 	/// <summary>
 	/// Fragment class is a container for attachment points in the same WorldLocking Fragment.
 	/// It manages their update and adjustment, including merging in the attachment points from
 	/// another fragment.
+	///
+	/// The attachment points themselves live in the FAttachmentPointPool shared by all fragments,
+	/// the fragment only keeps handles to its own.
 	/// </summary>
 	class FFragment
 	{
 	public:
-		FFragment(FrozenWorld_FragmentId fragmentId);
+		FFragment(FrozenWorld_FragmentId fragmentId, FAttachmentPointPool& attachmentPointPool);
 
 		void UpdateState(AttachmentPointStateType attachmentState);
-		void AddAttachmentPoint(TSharedPtr<FAttachmentPoint> attachPoint);
-		void ReleaseAttachmentPoint(TSharedPtr<FAttachmentPoint> attachmentPoint);
+		void AddAttachmentPoint(FAttachmentPointHandle attachPoint);
+		void RemoveAttachmentPoint(FAttachmentPointHandle attachPoint);
+		void ReleaseAttachmentPoint(FAttachmentPointHandle attachmentPoint);
 
 		void ReleaseAll();
 
-		void AbsorbOtherFragment(FFragment other);
-		void AbsorbOtherFragment(FFragment other, FTransform adjustment);
+		void AbsorbOtherFragment(FFragment&& other, TArray<DeferredAdjustment>* deferred = nullptr);
+		void AbsorbOtherFragment(FFragment&& other, FTransform adjustment, TArray<DeferredAdjustment>* deferred = nullptr);
+
+		void AdjustAll(int batchSize, TArray<DeferredAdjustment>* deferred = nullptr);
+		void AdjustAll(TFunctionRef<void(TArrayView<AttachmentPointAdjustment>)> computeAdjustments, TArray<DeferredAdjustment>* deferred = nullptr);
 
-		void AdjustAll();
+		void ReassignAnchor(FrozenWorld_AnchorId oldAnchorId, FrozenWorld_AnchorId newAnchorId, FTransform newAnchorFromOldAnchor);
+
+		void ExpandBounds(FVector position)
+		{
+			Bounds += position;
+		}
+
+		void RecomputeBounds();
 
 	public:
 		FrozenWorld_FragmentId FragmentId;
-		AttachmentPointStateType State;
+		AttachmentPointStateType State = AttachmentPointStateType::Unconnected;
+
+		// Box around the attached objects of this fragment's attachment points in frozen space.
+		// Conservative, it grows as attachment points join or move, and only shrinks when recomputed after a refit.
+		FBox Bounds = FBox(ForceInit);
+
+		int NumAttachmentPoints() const
+		{
+			return attachmentList.Num();
+		}
+
+		TArrayView<const FAttachmentPointHandle> GetAttachmentPoints() const
+		{
+			return attachmentList;
+		}
 
 	private:
-		TArray<TSharedPtr<FAttachmentPoint>> attachmentList;
+		int SpliceAttachmentPoints(TArray<FAttachmentPointHandle>&& otherList);
+
+		FAttachmentPointPool& attachmentPoints;
 
-		TArray<FAttachmentPoint::FAdjustStateDelegate> updateStateAllAttachments;
+		TArray<FAttachmentPointHandle> attachmentList;
 	};
 }
\ No newline at end of file
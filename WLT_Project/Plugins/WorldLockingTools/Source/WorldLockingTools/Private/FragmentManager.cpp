@@ -10,13 +10,19 @@
 
 namespace WorldLockingTools
 {
-	FFragmentManager::FFragmentManager()
+	FFragmentManager::FFragmentManager() :
+		deferredAdjustments(attachmentPoints, fragments)
 	{
 		IModularFeatures::Get().RegisterModularFeature(GetModularFeatureName(), this);
 	}
 
 	FFragmentManager::~FFragmentManager()
 	{
+		for (FAttachmentPointBatchListener* batchListener : batchListeners)
+		{
+			batchListener->registeredManager = nullptr;
+		}
+
 		IModularFeatures::Get().UnregisterModularFeature(GetModularFeatureName(), this);
 	}
 
@@ -40,6 +46,8 @@ namespace WorldLockingTools
 			CurrentFragmentId = FrozenWorld_FragmentId_INVALID;
 			ApplyActiveCurrentFragment();
 		}
+
+		DispatchBatchUpdates();
 	}
 
 	/// <summary>
@@ -72,7 +80,13 @@ namespace WorldLockingTools
 		// There are multiple mergeable fragments with valid adjustments, but we show only the current one
 		ApplyActiveCurrentFragment();
 
+		ApplyDeferredAdjustments(RefitBudgetMicroseconds);
+
+		ProcessQueuedMoves();
+
 		ProcessPendingAttachmentPoints();
+
+		DispatchBatchUpdates();
 	}
 
 	/// <summary>
@@ -80,62 +94,414 @@ namespace WorldLockingTools
 	/// </summary>
 	void FFragmentManager::Reset()
 	{
+		for (const auto& fragment : fragments)
+		{
+			fragment.Value->ReleaseAll();
+		}
 		fragments.Empty();
+		queuedMoves.Empty();
+		deferredAdjustments.Reset();
+		pendingAttachments.Empty();
+
+		// All attachment points go, so handles still held by clients resolve to nothing from here on.
+		attachmentPointIndex.Reset();
+		attachmentPoints.Reset();
+
+		for (FAttachmentPointBatchListener* batchListener : batchListeners)
+		{
+			batchListener->registeredManager = nullptr;
+		}
+		batchListeners.Empty();
+
 		CurrentFragmentId = FrozenWorld_FragmentId_INVALID;
+		appliedFragmentId = FrozenWorld_FragmentId_INVALID;
 		
 		TArray<FrozenWorld_FragmentId> empty;
 		refitNotifications.ExecuteIfBound(FrozenWorld_FragmentId_INVALID, empty);
 	}
 
+	/// <summary>
+	/// Start collecting the adjustments of a refit, if they are to be spread over frames.
+	/// 
+	/// Whatever is left of the previous refit's adjustments is applied first, so that each attachment point
+	/// has at most one adjustment outstanding.
+	/// </summary>
+	/// <returns>The list to collect deferred adjustments in, or null to apply them immediately.</returns>
+	TArray<DeferredAdjustment>* FFragmentManager::BeginDeferredAdjustments()
+	{
+		FlushDeferredAdjustments();
+
+		return RefitBudgetMicroseconds > 0 ? deferredAdjustments.Begin() : nullptr;
+	}
+
+	/// <summary>
+	/// Order the deferred adjustments so those the user is most likely to notice are applied first.
+	/// </summary>
+	void FFragmentManager::PrioritizeDeferredAdjustments()
+	{
+		if (deferredAdjustments.Num() > 0)
+		{
+			deferredAdjustments.Prioritize(FFrozenWorldPlugin::Get()->LockedFromCamera());
+		}
+	}
+
+	/// <summary>
+	/// Apply deferred refit adjustments to their attachment points, notifying their clients, until out of time.
+	/// </summary>
+	/// <param name="budgetMicroseconds">CPU time to spend, zero or negative for no limit.</param>
+	void FFragmentManager::ApplyDeferredAdjustments(float budgetMicroseconds)
+	{
+		deferredAdjustments.Apply(budgetMicroseconds, [this](FAttachmentPointHandle attachPoint)
+		{
+			IndexAttachmentPoint(attachPoint);
+		});
+	}
+
+	/// <summary>
+	/// Hand this frame's attachment point updates to the batch listeners, one call per listener.
+	/// 
+	/// Listeners may add or remove listeners, and even be destroyed, while handling their batch. So the listeners
+	/// are dispatched from a copy, skipping any that are no longer registered by the time they are reached.
+	/// </summary>
+	void FFragmentManager::DispatchBatchUpdates()
+	{
+		dispatchingListeners.Reset();
+		for (FAttachmentPointBatchListener* batchListener : batchListeners)
+		{
+			dispatchingListeners.Add(batchListener);
+		}
+
+		for (FAttachmentPointBatchListener* batchListener : dispatchingListeners)
+		{
+			if (batchListeners.Contains(batchListener))
+			{
+				batchListener->Dispatch();
+			}
+		}
+		dispatchingListeners.Reset();
+	}
+
+	/// <summary>
+	/// Stop sending updates to a batch listener, typically because it is going away.
+	/// 
+	/// Its attachment points stay valid, but their updates are no longer reported in batches.
+	/// </summary>
+	void FFragmentManager::RemoveBatchListener(FAttachmentPointBatchListener* batchListener)
+	{
+		if (batchListeners.Remove(batchListener) == 0)
+		{
+			return;
+		}
+		batchListener->registeredManager = nullptr;
+
+		for (FAttachmentPoint& attachPoint : attachmentPoints.GetAttachmentPoints())
+		{
+			if (attachPoint.BatchListener == batchListener)
+			{
+				attachPoint.BatchListener = nullptr;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Bring an attachment point's entry in the spatial index, and its fragment's bounds, up to date with the position of its attached object.
+	/// </summary>
+	void FFragmentManager::IndexAttachmentPoint(FAttachmentPointHandle attachPoint)
+	{
+		const FAttachmentPoint* attach = attachmentPoints.Get(attachPoint);
+		if (attach == nullptr)
+		{
+			return;
+		}
+
+		attachmentPointIndex.Update(attachPoint, attach->ObjectPosition);
+		if (attach->FragmentIndex != INDEX_NONE)
+		{
+			if (const TSharedPtr<FFragment>* fragment = fragments.Find(attach->FragmentId))
+			{
+				(*fragment)->ExpandBounds(attach->ObjectPosition);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Reindex all attachment points of a fragment and refit its bounds, after a refit adjusted them all at once.
+	/// </summary>
+	void FFragmentManager::IndexFragment(FFragment& fragment)
+	{
+		for (const auto& handle : fragment.GetAttachmentPoints())
+		{
+			attachmentPointIndex.Update(handle, attachmentPoints.Get(handle)->ObjectPosition);
+		}
+		fragment.RecomputeBounds();
+	}
+
+	/// <summary>
+	/// The fragment a query is restricted to.
+	/// </summary>
+	/// <returns>The fragment, or null if there is no such fragment.</returns>
+	const FFragment* FFragmentManager::FindQueryFragment(FrozenWorld_FragmentId fragmentId) const
+	{
+		const TSharedPtr<FFragment>* fragment = fragments.Find(fragmentId);
+		return fragment != nullptr ? fragment->Get() : nullptr;
+	}
+
+	/// <summary>
+	/// Find the attachment points whose attached objects are within radius of a frozen position, in no particular order.
+	/// 
+	/// When restricted to a fragment, nothing is searched if the position is outside of the fragment's bounds by more than the radius.
+	/// </summary>
+	/// <param name="frozenPosition">Center of the search.</param>
+	/// <param name="radius">Radius of the search.</param>
+	/// <param name="outHandles">Found attachment points are appended to this.</param>
+	/// <param name="fragmentId">The fragment to restrict the search to, or FrozenWorld_FragmentId_INVALID to search all attachment points.</param>
+	void FFragmentManager::FindAttachmentPointsInRadius(FVector frozenPosition, float radius, TArray<FAttachmentPointHandle>& outHandles,
+		FrozenWorld_FragmentId fragmentId) const
+	{
+		if (fragmentId == FrozenWorld_FragmentId_INVALID)
+		{
+			attachmentPointIndex.FindInRadius(frozenPosition, radius, [](FAttachmentPointHandle) { return true; }, outHandles);
+			return;
+		}
+
+		const FFragment* fragment = FindQueryFragment(fragmentId);
+		if (fragment == nullptr || !fragment->Bounds.IsValid
+			|| fragment->Bounds.ComputeSquaredDistanceToPoint(frozenPosition) > (double)radius * radius)
+		{
+			return;
+		}
+
+		attachmentPointIndex.FindInRadius(frozenPosition, radius, [this, fragmentId](FAttachmentPointHandle handle)
+		{
+			const FAttachmentPoint* attach = attachmentPoints.Get(handle);
+			return attach->FragmentId == fragmentId && attach->FragmentIndex != INDEX_NONE;
+		}, outHandles);
+	}
+
+	/// <summary>
+	/// Find the attachment points whose attached objects are inside a box in frozen space, in no particular order.
+	/// 
+	/// When restricted to a fragment, nothing is searched if the box misses the fragment's bounds.
+	/// </summary>
+	/// <param name="frozenBox">The box to search.</param>
+	/// <param name="outHandles">Found attachment points are appended to this.</param>
+	/// <param name="fragmentId">The fragment to restrict the search to, or FrozenWorld_FragmentId_INVALID to search all attachment points.</param>
+	void FFragmentManager::FindAttachmentPointsInBox(const FBox& frozenBox, TArray<FAttachmentPointHandle>& outHandles,
+		FrozenWorld_FragmentId fragmentId) const
+	{
+		if (fragmentId == FrozenWorld_FragmentId_INVALID)
+		{
+			attachmentPointIndex.FindInBox(frozenBox, [](FAttachmentPointHandle) { return true; }, outHandles);
+			return;
+		}
+
+		const FFragment* fragment = FindQueryFragment(fragmentId);
+		if (fragment == nullptr || !fragment->Bounds.IsValid || !fragment->Bounds.Intersect(frozenBox))
+		{
+			return;
+		}
+
+		attachmentPointIndex.FindInBox(frozenBox, [this, fragmentId](FAttachmentPointHandle handle)
+		{
+			const FAttachmentPoint* attach = attachmentPoints.Get(handle);
+			return attach->FragmentId == fragmentId && attach->FragmentIndex != INDEX_NONE;
+		}, outHandles);
+	}
+
+	/// <summary>
+	/// Find the attachment point whose attached object is nearest to a frozen position.
+	/// </summary>
+	/// <param name="frozenPosition">Center of the search.</param>
+	/// <param name="maxDistance">Attachment points further away are ignored, zero or negative for no limit.</param>
+	/// <param name="fragmentId">The fragment to restrict the search to, or FrozenWorld_FragmentId_INVALID to search all attachment points.</param>
+	/// <returns>The nearest attachment point, or an invalid handle if none was found.</returns>
+	FAttachmentPointHandle FFragmentManager::FindNearestAttachmentPoint(FVector frozenPosition, float maxDistance,
+		FrozenWorld_FragmentId fragmentId) const
+	{
+		if (fragmentId == FrozenWorld_FragmentId_INVALID)
+		{
+			return attachmentPointIndex.FindNearest(frozenPosition, maxDistance, [](FAttachmentPointHandle) { return true; });
+		}
+
+		const FFragment* fragment = FindQueryFragment(fragmentId);
+		if (fragment == nullptr || !fragment->Bounds.IsValid
+			|| (maxDistance > 0 && fragment->Bounds.ComputeSquaredDistanceToPoint(frozenPosition) > (double)maxDistance * maxDistance))
+		{
+			return FAttachmentPointHandle();
+		}
+
+		return attachmentPointIndex.FindNearest(frozenPosition, maxDistance, [this, fragmentId](FAttachmentPointHandle handle)
+		{
+			const FAttachmentPoint* attach = attachmentPoints.Get(handle);
+			return attach->FragmentId == fragmentId && attach->FragmentIndex != INDEX_NONE;
+		});
+	}
+
+	/// <summary>
+	/// Find the fragments whose bounds come within radius of a frozen position.
+	/// </summary>
+	/// <param name="frozenPosition">Center of the search.</param>
+	/// <param name="radius">Radius of the search.</param>
+	/// <param name="outFragmentIds">Ids of the fragments found are appended to this.</param>
+	void FFragmentManager::FindFragmentsInRadius(FVector frozenPosition, float radius, TArray<FrozenWorld_FragmentId>& outFragmentIds) const
+	{
+		double radiusSqr = (double)radius * radius;
+		for (const auto& entry : fragments)
+		{
+			const FBox& bounds = entry.Value->Bounds;
+			if (bounds.IsValid && bounds.ComputeSquaredDistanceToPoint(frozenPosition) <= radiusSqr)
+			{
+				outFragmentIds.Add(entry.Key);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Apply all deferred refit adjustments now.
+	/// </summary>
+	void FFragmentManager::FlushDeferredAdjustments()
+	{
+		ApplyDeferredAdjustments(0);
+	}
+
 	/// <summary>
 	/// If conditions have changed to allow finalizing creation of any pending attachment points, do it now.
+	/// 
+	/// With a per frame budget, the pending attachment points nearest the head are set up first,
+	/// and the rest wait for following frames.
 	/// </summary>
 	void FFragmentManager::ProcessPendingAttachmentPoints()
 	{
+		pendingAttachmentPointStats.NumProcessedLastFrame = 0;
+
 		if (CurrentFragmentId != FrozenWorld_FragmentId_UNKNOWN
 			&& CurrentFragmentId != FrozenWorld_FragmentId_INVALID
 			&& pendingAttachments.Num() > 0)
 		{
-			// We have a valid destination fragment. Note that since this queue is in order of submission,
+			bool budgeted = MaxPendingAttachmentPointsPerFrame > 0 || PendingAttachmentPointBudgetMicroseconds > 0;
+			if (budgeted)
+			{
+				PrioritizePendingAttachmentPoints(pendingAttachments, attachmentPoints, FFrozenWorldPlugin::Get()->LockedFromCamera());
+			}
+
+			const int checkTimeInterval = 8;
+			double endTime = FPlatformTime::Seconds() + PendingAttachmentPointBudgetMicroseconds * 1e-6;
+			int maxCount = MaxPendingAttachmentPointsPerFrame > 0 ? MaxPendingAttachmentPointsPerFrame : MAX_int32;
+
+			// We have a valid destination fragment. Without a budget, the queue is in order of submission, so
 			// if an attachment point depends on a second attachment point for context,
 			// that second will be either earlier in the list (because there was no valid current fragment when it was
-			// created) or it will have a valid fragment. So by the time we get to the one with a dependency (pending.context != null),
-			// its dependency will have a valid fragment id.
+			// created) or it will have a valid fragment. Once reordered by priority, that no longer holds, so attachment
+			// points whose context is still pending are left in the queue until their context has been set up.
+			TArray<PendingAttachmentPoint> waiting;
 			int pendingCount = pendingAttachments.Num();
-			for (int i = 0; i < pendingCount; ++i)
+			int numProcessed = 0;
+			int i = 0;
+			for (; i < pendingCount && numProcessed < maxCount; ++i)
 			{
-				TSharedPtr<FAttachmentPoint> target = pendingAttachments[i].target;
-				FVector frozenPosition = target->ObjectPosition;
-				TSharedPtr<FAttachmentPoint> context = pendingAttachments[i].context;
+				FAttachmentPointHandle target = pendingAttachments[i].target;
+				FAttachmentPointHandle context = pendingAttachments[i].context;
+				if (!attachmentPoints.Contains(target))
+				{
+					continue;
+				}
 
-				SetupAttachmentPoint(target, context);
+				FrozenWorld_FragmentId fragmentId = GetTargetFragmentId(context);
+				if (fragmentId == FrozenWorld_FragmentId_UNKNOWN || fragmentId == FrozenWorld_FragmentId_INVALID)
+				{
+					waiting.Add(pendingAttachments[i]);
+					continue;
+				}
 
-				FrozenWorld_FragmentId fragmentId = CurrentFragmentId;
-				if (context != nullptr)
+				// An attachment point teleported while there was no valid fragment is still held by its old fragment.
+				FrozenWorld_FragmentId oldFragmentId = attachmentPoints.Get(target)->FragmentId;
+				if (attachmentPoints.Get(target)->FragmentIndex != INDEX_NONE)
 				{
-					fragmentId = context->FragmentId;
+					EnsureFragment(oldFragmentId)->RemoveAttachmentPoint(target);
 				}
-				check(fragmentId != FrozenWorld_FragmentId_UNKNOWN && fragmentId != FrozenWorld_FragmentId_INVALID); // Invalid fragmentId
+
+				SetupAttachmentPoint(target, context);
+
 				TSharedPtr<FFragment> fragment = EnsureFragment(fragmentId);
 				check(fragment != nullptr); //Valid fragmentId but no fragment found.
 				fragment->AddAttachmentPoint(target);
+
+				double latency = FPlatformTime::Seconds() - pendingAttachments[i].queuedTime;
+				totalPendingLatency += latency;
+				pendingAttachmentPointStats.MaxLatencyMilliseconds = FMath::Max(pendingAttachmentPointStats.MaxLatencyMilliseconds, (float)(latency * 1000.0));
+				++numProcessed;
+
+				if (PendingAttachmentPointBudgetMicroseconds > 0
+					&& numProcessed % checkTimeInterval == 0
+					&& FPlatformTime::Seconds() >= endTime)
+				{
+					++i;
+					break;
+				}
 			}
 
-			// Update space pins now that a valid fragment exists.
-			FAlignmentManager::OnAlignmentManagerLoad.Broadcast();
+			// Whatever wasn't reached stays queued, behind those waiting on their context.
+			waiting.Append(pendingAttachments.GetData() + i, pendingCount - i);
+			pendingAttachments = MoveTemp(waiting);
 
-			// All pending must now be in a good home fragment, clear the to-do list.
-			pendingAttachments.Empty();
+			pendingAttachmentPointStats.NumProcessedLastFrame = numProcessed;
+			pendingAttachmentPointStats.NumProcessed += numProcessed;
+			if (pendingAttachmentPointStats.NumProcessed > 0)
+			{
+				pendingAttachmentPointStats.AverageLatencyMilliseconds = (float)(totalPendingLatency * 1000.0 / pendingAttachmentPointStats.NumProcessed);
+			}
+
+			if (pendingAttachments.Num() == 0)
+			{
+				// Update space pins now that all pending attachment points have a good home fragment.
+				FAlignmentManager::OnAlignmentManagerLoad.Broadcast();
+			}
 		}
+
+		pendingAttachmentPointStats.QueueDepth = pendingAttachments.Num();
+	}
+
+	/// <summary>
+	/// Priority of an attachment point at a position, lower is more urgent.
+	/// 
+	/// This is the distance from the head, with positions behind the head counting as twice as far away as they are.
+	/// </summary>
+	float FFragmentManager::GetPriority(FVector position, const FTransform& lockedHead)
+	{
+		FVector toObject = position - lockedHead.GetLocation();
+		float distance = toObject.Size();
+		return FVector::DotProduct(toObject, lockedHead.GetRotation().GetForwardVector()) >= 0 ? distance : 2.0f * distance;
+	}
+
+	/// <summary>
+	/// Order pending attachment points so those nearest the head are set up first.
+	/// 
+	/// Attachment points at the same priority keep their order of submission, released ones go last.
+	/// </summary>
+	void FFragmentManager::PrioritizePendingAttachmentPoints(TArray<PendingAttachmentPoint>& pending, const FAttachmentPointPool& pool, const FTransform& lockedHead)
+	{
+		for (auto& entry : pending)
+		{
+			const FAttachmentPoint* attach = pool.Get(entry.target);
+			entry.priority = attach != nullptr ? GetPriority(attach->ObjectPosition, lockedHead) : MAX_flt;
+		}
+
+		pending.StableSort([](const PendingAttachmentPoint& a, const PendingAttachmentPoint& b)
+		{
+			return a.priority < b.priority;
+		});
 	}
 
 	/// <summary>
 	/// Helper function for setting up the internals of an AttachmentPoint
 	/// </summary>
-	/// <param name="target">The attachment point to setup</param>
-	/// <param name="context">The optional context <see cref="CreateAttachmentPoint"/></param>
-	void FFragmentManager::SetupAttachmentPoint(TSharedPtr<FAttachmentPoint> target, TSharedPtr<FAttachmentPoint> context)
+	/// <param name="targetHandle">The attachment point to setup</param>
+	/// <param name="contextHandle">The optional context <see cref="CreateAttachmentPoint"/></param>
+	void FFragmentManager::SetupAttachmentPoint(FAttachmentPointHandle targetHandle, FAttachmentPointHandle contextHandle)
 	{
+		FAttachmentPoint* target = attachmentPoints.Get(targetHandle);
+		const FAttachmentPoint* context = attachmentPoints.Get(contextHandle);
+		check(target != nullptr); // Setting up a released attachment point.
 		if (context != nullptr)
 		{
 			FrozenWorld_AnchorId anchorId;
@@ -162,17 +528,22 @@ namespace WorldLockingTools
 	/// </summary>
 	/// <param name="attachPoint">Attachment point to process later.</param>
 	/// <param name="context">Optional spawning attachment point, may be null.</param>
-	void FFragmentManager::AddPendingAttachmentPoint(TSharedPtr<FAttachmentPoint> attachPoint, TSharedPtr<FAttachmentPoint> context)
+	void FFragmentManager::AddPendingAttachmentPoint(FAttachmentPointHandle attachPoint, FAttachmentPointHandle context)
 	{
-		attachPoint->HandleStateChange(AttachmentPointStateType::Pending);
+		attachmentPoints.Get(attachPoint)->HandleStateChange(AttachmentPointStateType::Pending);
 
 		pendingAttachments.Add(
 			PendingAttachmentPoint
 			{
 				attachPoint,
-				context
+				context,
+				FPlatformTime::Seconds(),
+				0.0f
 			}
 		);
+
+		pendingAttachmentPointStats.QueueDepth = pendingAttachments.Num();
+		pendingAttachmentPointStats.MaxQueueDepth = FMath::Max(pendingAttachmentPointStats.MaxQueueDepth, pendingAttachments.Num());
 	}
 
 	/// <summary>
@@ -188,17 +559,26 @@ namespace WorldLockingTools
 	/// <param name="context">The optional context into which to create the attachment point (may be null)</param>
 	/// <param name="locationHandler">Delegate to handle WorldLocking system adjustments to position</param>
 	/// <param name="stateHandler">Delegate to handle WorldLocking connectivity changes</param>
-	/// <returns>The new attachment point interface.</returns>
-	TSharedPtr<FAttachmentPoint> FFragmentManager::CreateAttachmentPoint(
+	/// <param name="batchListener">Optional listener to report adjustments and connectivity changes to in per frame batches</param>
+	/// <returns>Handle to the new attachment point.</returns>
+	FAttachmentPointHandle FFragmentManager::CreateAttachmentPoint(
 		FVector frozenPosition, 
-		TSharedPtr<FAttachmentPoint> context,
+		FAttachmentPointHandle context,
 		FAttachmentPoint::FAdjustLocationDelegate LocationHandler,
-		FAttachmentPoint::FAdjustStateDelegate StateHandler)
+		FAttachmentPoint::FAdjustStateDelegate StateHandler,
+		FAttachmentPointBatchListener* BatchListener)
 	{
 		FrozenWorld_FragmentId fragmentId = GetTargetFragmentId(context);
-		TSharedPtr<FAttachmentPoint> attachPoint = MakeShared<FAttachmentPoint>(LocationHandler, StateHandler);
+		FAttachmentPointHandle attachPoint = attachmentPoints.Allocate(LocationHandler, StateHandler);
 
-		attachPoint->ObjectPosition = frozenPosition;
+		attachmentPoints.Get(attachPoint)->ObjectPosition = frozenPosition;
+		if (BatchListener != nullptr)
+		{
+			check(BatchListener->registeredManager == nullptr || BatchListener->registeredManager == this); // Listener of another fragment manager
+			attachmentPoints.Get(attachPoint)->BatchListener = BatchListener;
+			batchListeners.Add(BatchListener);
+			BatchListener->registeredManager = this;
+		}
 		if (fragmentId != FrozenWorld_FragmentId_UNKNOWN 
 			&& fragmentId != FrozenWorld_FragmentId_INVALID)
 		{
@@ -212,6 +592,7 @@ namespace WorldLockingTools
 		{
 			AddPendingAttachmentPoint(attachPoint, context);
 		}
+		attachmentPointIndex.Update(attachPoint, frozenPosition);
 		return attachPoint;
 	}
 
@@ -225,14 +606,14 @@ namespace WorldLockingTools
 	/// <param name="attachPointIface">The attachment point to teleport</param>
 	/// <param name="newFrozenPosition">The position to teleport to.</param>
 	/// <param name="context">The optional context.</param>
-	void FFragmentManager::TeleportAttachmentPoint(TSharedPtr<FAttachmentPoint> attachPointIface, FVector newFrozenPosition, TSharedPtr<FAttachmentPoint> context)
+	void FFragmentManager::TeleportAttachmentPoint(FAttachmentPointHandle attachPointIface, FVector newFrozenPosition, FAttachmentPointHandle context)
 	{
-		if (attachPointIface != nullptr)
+		if (FAttachmentPoint* attachPoint = attachmentPoints.Get(attachPointIface))
 		{
-			attachPointIface->ObjectPosition = newFrozenPosition;
+			attachPoint->ObjectPosition = newFrozenPosition;
 
 			// Save the fragment it's currently in, in case it changes here.
-			FrozenWorld_FragmentId oldFragmentId = attachPointIface->FragmentId;
+			FrozenWorld_FragmentId oldFragmentId = attachPoint->FragmentId;
 
 			// If it's not in a valid fragment, it is still pending and will get processed when the system is ready.
 			if (oldFragmentId != FrozenWorld_FragmentId_UNKNOWN
@@ -246,7 +627,7 @@ namespace WorldLockingTools
 					// Fill it in with a new one.
 					SetupAttachmentPoint(attachPointIface, context);
 
-					if (attachPointIface->FragmentId != oldFragmentId)
+					if (attachPoint->FragmentId != oldFragmentId)
 					{
 						ChangeAttachmentPointFragment(oldFragmentId, attachPointIface);
 					}
@@ -256,9 +637,120 @@ namespace WorldLockingTools
 					AddPendingAttachmentPoint(attachPointIface, context);
 				}
 			}
+
+			IndexAttachmentPoint(attachPointIface);
+		}
+	}
+
+	/// <summary>
+	/// Move (as opposed to Teleport) means that the object is meant to have traveled from its old position
+	/// to its new position in frozen space, so the attachment point follows the anchor graph from where it was,
+	/// joining the fragment of the anchor it ends up on.
+	/// 
+	/// An attachment point still pending only has its position updated, it is set up at the new position when the system is ready.
+	/// </summary>
+	/// <param name="attachPoint">The attachment point to move</param>
+	/// <param name="newFrozenPosition">The position moved to.</param>
+	void FFragmentManager::MoveAttachmentPoint(FAttachmentPointHandle attachPoint, FVector newFrozenPosition)
+	{
+		MoveAttachmentPoints(MakeArrayView(&attachPoint, 1), MakeArrayView(&newFrozenPosition, 1));
+	}
+
+	/// <summary>
+	/// Move many attachment points at once, crossing into the engine once for all of them.
+	/// See MoveAttachmentPoint.
+	/// </summary>
+	/// <param name="attachPoints">The attachment points to move</param>
+	/// <param name="newFrozenPositions">The position each attachment point moved to.</param>
+	void FFragmentManager::MoveAttachmentPoints(TArrayView<const FAttachmentPointHandle> attachPoints, TArrayView<const FVector> newFrozenPositions)
+	{
+		check(attachPoints.Num() == newFrozenPositions.Num());
+
+		moveBuffer.Reset();
+		moveBufferHandles.Reset();
+		for (int i = 0; i < attachPoints.Num(); ++i)
+		{
+			FAttachmentPoint* attach = attachmentPoints.Get(attachPoints[i]);
+			if (attach == nullptr)
+			{
+				continue;
+			}
+
+			attach->ObjectPosition = newFrozenPositions[i];
+			IndexAttachmentPoint(attachPoints[i]);
+			if (attach->FragmentId != FrozenWorld_FragmentId_UNKNOWN
+				&& attach->FragmentId != FrozenWorld_FragmentId_INVALID)
+			{
+				moveBuffer.Add(AttachmentPointMove{ attach->AnchorId, attach->LocationFromAnchor, newFrozenPositions[i], attach->FragmentId });
+				moveBufferHandles.Add(attachPoints[i]);
+			}
+		}
+
+		if (moveBuffer.Num() == 0)
+		{
+			return;
+		}
+
+		FFrozenWorldPlugin::Get()->MoveAttachmentPoints(moveBuffer);
+
+		for (int i = 0; i < moveBuffer.Num(); ++i)
+		{
+			// Joining another fragment notifies clients, who may release attachment points still to be updated.
+			FAttachmentPoint* attach = attachmentPoints.Get(moveBufferHandles[i]);
+			if (attach == nullptr)
+			{
+				continue;
+			}
+			FrozenWorld_FragmentId oldFragmentId = attach->FragmentId;
+			const AttachmentPointMove& move = moveBuffer[i];
+			bool changesFragment = move.fragmentId != oldFragmentId
+				&& move.fragmentId != FrozenWorld_FragmentId_UNKNOWN
+				&& move.fragmentId != FrozenWorld_FragmentId_INVALID;
+			attach->Set(changesFragment ? move.fragmentId : oldFragmentId, move.targetFrozenPosition, move.anchorId, move.locationFromAnchor);
+			if (changesFragment)
+			{
+				ChangeAttachmentPointFragment(oldFragmentId, moveBufferHandles[i]);
+			}
 		}
 	}
 
+	/// <summary>
+	/// Move an attachment point with the next update, together with all other moves queued this frame.
+	/// 
+	/// Meant for many dynamic objects updating their positions every frame. Only the last position queued
+	/// for an attachment point in a frame is moved to.
+	/// </summary>
+	/// <param name="attachPoint">The attachment point to move</param>
+	/// <param name="newFrozenPosition">The position moved to.</param>
+	void FFragmentManager::QueueAttachmentPointMove(FAttachmentPointHandle attachPoint, FVector newFrozenPosition)
+	{
+		queuedMoves.Add(attachPoint, newFrozenPosition);
+	}
+
+	/// <summary>
+	/// Apply the moves queued since the last update in one batch.
+	/// </summary>
+	void FFragmentManager::ProcessQueuedMoves()
+	{
+		if (queuedMoves.Num() == 0)
+		{
+			return;
+		}
+
+		TArray<FAttachmentPointHandle> handles;
+		TArray<FVector> positions;
+		handles.Reserve(queuedMoves.Num());
+		positions.Reserve(queuedMoves.Num());
+		for (const auto& move : queuedMoves)
+		{
+			handles.Add(move.Key);
+			positions.Add(move.Value);
+		}
+		queuedMoves.Reset();
+
+		MoveAttachmentPoints(handles, positions);
+	}
+
 	/// <summary>
 	/// Release an attachment point for disposal. The attachment point is no longer valid after this call.
 	/// 
@@ -268,11 +760,11 @@ namespace WorldLockingTools
 	/// finally processed, it will be as if it was created with a null context.
 	/// </summary>
 	/// <param name="attachPointIface">The attachment point to release.</param>
-	void FFragmentManager::ReleaseAttachmentPoint(TSharedPtr<FAttachmentPoint> AttachmentPoint)
+	void FFragmentManager::ReleaseAttachmentPoint(FAttachmentPointHandle AttachmentPoint)
 	{
-		if (AttachmentPoint != nullptr)
+		if (FAttachmentPoint* attachPoint = attachmentPoints.Get(AttachmentPoint))
 		{
-			TSharedPtr<FFragment> fragment = EnsureFragment(AttachmentPoint->FragmentId);
+			TSharedPtr<FFragment> fragment = EnsureFragment(attachPoint->FragmentId);
 			if (fragment != nullptr)
 			{
 				// Fragment handles notification.
@@ -281,7 +773,7 @@ namespace WorldLockingTools
 			else
 			{
 				// Notify of the state change to released.
-				AttachmentPoint->HandleStateChange(AttachmentPointStateType::Released);
+				attachPoint->HandleStateChange(AttachmentPointStateType::Released);
 				// The list of pending attachments is expected to be small, and release of an attachment
 				// point while there are pending attachments is expected to be rare. So brute force it here.
 				// If the attachment point being released is a target in the pending list, remove it.
@@ -294,7 +786,7 @@ namespace WorldLockingTools
 					if (pendingAttachments[i].context == AttachmentPoint)
 					{
 						auto p = pendingAttachments[i];
-						p.context = nullptr;
+						p.context = FAttachmentPointHandle();
 						pendingAttachments[i] = p;
 					}
 					else if (pendingAttachments[i].target == AttachmentPoint)
@@ -304,20 +796,60 @@ namespace WorldLockingTools
 					}
 				}
 			}
+
+			attachmentPointIndex.Remove(AttachmentPoint);
+			attachmentPoints.Release(AttachmentPoint);
 		}
 	}
 
+	/// <summary>
+	/// Move all attachment points on an anchor that is being removed to another anchor, keeping their frozen positions.
+	/// </summary>
+	/// <param name="oldAnchorId">The anchor being removed.</param>
+	/// <param name="newAnchorId">The anchor taking over its attachment points.</param>
+	/// <param name="newAnchorFromOldAnchor">Frozen pose of the old anchor relative to the new one.</param>
+	void FFragmentManager::ReassignAnchor(FrozenWorld_AnchorId oldAnchorId, FrozenWorld_AnchorId newAnchorId, FTransform newAnchorFromOldAnchor)
+	{
+		for (const auto& entry : fragments)
+		{
+			entry.Value->ReassignAnchor(oldAnchorId, newAnchorId, newAnchorFromOldAnchor);
+		}
+	}
+
+	/// <summary>
+	/// Resolve the attachment points on anchors that are back in the engine, after being paged out.
+	/// 
+	/// They missed any refits while their anchors were out, so they are walked again from their anchor to
+	/// their attached object, which moves them onto the nearest anchor and into that anchor's fragment.
+	/// </summary>
+	/// <param name="anchorIds">The anchors paged back in.</param>
+	void FFragmentManager::ResolveAttachmentPoints(const TSet<FrozenWorld_AnchorId>& anchorIds)
+	{
+		TArray<FAttachmentPointHandle> handles;
+		TArray<FVector> positions;
+		for (const auto& attach : attachmentPoints.GetAttachmentPoints())
+		{
+			if (anchorIds.Contains(attach.AnchorId))
+			{
+				handles.Add(attach.Handle);
+				positions.Add(attach.ObjectPosition);
+			}
+		}
+
+		MoveAttachmentPoints(handles, positions);
+	}
+
 	/// <summary>
 	/// Establish which fragment a new attachment point should join.
 	/// </summary>
 	/// <param name="context">Optional spawning attachment point. May be null to "spawn from head".</param>
 	/// <returns>Id of fragment to join. May be FragmentId_Invalid if not currently tracking.</returns>
-	FrozenWorld_FragmentId FFragmentManager::GetTargetFragmentId(TSharedPtr<FAttachmentPoint> context)
+	FrozenWorld_FragmentId FFragmentManager::GetTargetFragmentId(FAttachmentPointHandle context)
 	{
 		FrozenWorld_FragmentId fragmentId = CurrentFragmentId;
-		if (context != nullptr)
+		if (const FAttachmentPoint* contextPoint = attachmentPoints.Get(context))
 		{
-			fragmentId = context->FragmentId;
+			fragmentId = contextPoint->FragmentId;
 		}
 		return fragmentId;
 	}
@@ -329,20 +861,21 @@ namespace WorldLockingTools
 	/// </summary>
 	/// <param name="oldFragmentId">Source fragment</param>
 	/// <param name="attachPoint">The attachment point</param>
-	void FFragmentManager::ChangeAttachmentPointFragment(FrozenWorld_FragmentId oldFragmentId, TSharedPtr<FAttachmentPoint> attachPoint)
+	void FFragmentManager::ChangeAttachmentPointFragment(FrozenWorld_FragmentId oldFragmentId, FAttachmentPointHandle attachPoint)
 	{
-		check(oldFragmentId != attachPoint->FragmentId); //Moving attachment point from and to same fragment
+		FrozenWorld_FragmentId newFragmentId = attachmentPoints.Get(attachPoint)->FragmentId;
+		check(oldFragmentId != newFragmentId); //Moving attachment point from and to same fragment
 
 		TSharedPtr<FFragment> oldFragment = EnsureFragment(oldFragmentId);
-		TSharedPtr<FFragment> newFragment = EnsureFragment(attachPoint->FragmentId);
+		TSharedPtr<FFragment> newFragment = EnsureFragment(newFragmentId);
 		check(oldFragment != nullptr); //Valid fragmentId's but null source fragment
 		check(newFragment != nullptr); //Valid fragmentId's but null destination fragment
 
+		// Remove from the old fragment, without releasing it, since it lives on in the new fragment.
+		oldFragment->RemoveAttachmentPoint(attachPoint);
+
 		// Add to the new fragment
 		newFragment->AddAttachmentPoint(attachPoint);
-
-		// Remove from the old fragment
-		oldFragment->ReleaseAttachmentPoint(attachPoint);
 	}
 
 	/// <summary>
@@ -360,23 +893,33 @@ namespace WorldLockingTools
 		
 		if (!fragments.Contains(id))
 		{
-			fragments.Add(id, MakeShared<FFragment>(id));
+			TSharedPtr<FFragment> fragment = MakeShared<FFragment>(id, attachmentPoints);
+			fragment->State = id == appliedFragmentId ? AttachmentPointStateType::Normal : AttachmentPointStateType::Unconnected;
+			fragments.Add(id, fragment);
 		}
 		return fragments[id];
 	}
 
 	/// <summary>
 	/// Notify all fragments of their current state.
+	/// 
+	/// Only the current fragment is Normal, so only the fragment that was current before and the one current now
+	/// can change state, and the others aren't visited.
 	/// </summary>
 	void FFragmentManager::ApplyActiveCurrentFragment()
 	{
-		for (const auto& fragment : fragments)
+		if (appliedFragmentId != CurrentFragmentId)
 		{
-			AttachmentPointStateType state = fragment.Value->FragmentId == CurrentFragmentId
-				? AttachmentPointStateType::Normal
-				: AttachmentPointStateType::Unconnected;
-			
-			fragment.Value->UpdateState(state);
+			if (const TSharedPtr<FFragment>* previous = fragments.Find(appliedFragmentId))
+			{
+				(*previous)->UpdateState(AttachmentPointStateType::Unconnected);
+			}
+			appliedFragmentId = CurrentFragmentId;
+		}
+
+		if (const TSharedPtr<FFragment>* current = fragments.Find(CurrentFragmentId))
+		{
+			(*current)->UpdateState(AttachmentPointStateType::Normal);
 		}
 	}
 
@@ -405,15 +948,17 @@ namespace WorldLockingTools
 			return false;
 		}
 
+		TArray<DeferredAdjustment>* deferred = BeginDeferredAdjustments();
+
 		int numAbsorbed = mergeAdjustments.Num();
 		for (int i = 0; i < numAbsorbed; ++i)
 		{
 			FrozenWorld_FragmentId sourceId = mergeAdjustments[i].fragmentId;
 			FTransform adjustment = mergeAdjustments[i].pose;
-			if (fragments.Contains(sourceId))
+			TSharedPtr<FFragment> sourceFragment;
+			if (fragments.RemoveAndCopyValue(sourceId, sourceFragment))
 			{
-				targetFragment->AbsorbOtherFragment(*fragments[sourceId], adjustment);
-				fragments.Remove(sourceId);
+				targetFragment->AbsorbOtherFragment(MoveTemp(*sourceFragment), adjustment, deferred);
 			}
 			else
 			{
@@ -424,6 +969,13 @@ namespace WorldLockingTools
 
 		ApplyActiveCurrentFragment();
 
+		if (deferred == nullptr)
+		{
+			IndexFragment(*targetFragment);
+		}
+
+		PrioritizeDeferredAdjustments();
+
 		refitNotifications.ExecuteIfBound(targetFragment->FragmentId, ExtractFragmentIds(mergeAdjustments));
 
 		return true;
@@ -463,15 +1015,17 @@ namespace WorldLockingTools
 			return false;
 		}
 
+		TArray<DeferredAdjustment>* deferred = BeginDeferredAdjustments();
+
 		for (int i = 0; i < absorbedIds.Num(); ++i)
 		{
 			FrozenWorld_FragmentId sourceId = absorbedIds[i];
 			if (sourceId != targetFragmentId)
 			{
-				if (fragments.Contains(sourceId))
+				TSharedPtr<FFragment> sourceFragment;
+				if (fragments.RemoveAndCopyValue(sourceId, sourceFragment))
 				{
-					targetFragment->AbsorbOtherFragment(*fragments[sourceId]);
-					fragments.Remove(sourceId);
+					targetFragment->AbsorbOtherFragment(MoveTemp(*sourceFragment), deferred);
 				}
 				else
 				{
@@ -482,11 +1036,19 @@ namespace WorldLockingTools
 		CurrentFragmentId = targetFragmentId;
 
 		// now apply individual adjustments to each attachment point.
-		targetFragment->AdjustAll();
+		// Their anchoring is updated right away, applying the adjustments to the attached objects may be left for later frames.
+		targetFragment->AdjustAll(AdjustmentBatchSize, deferred);
 
 		// now that all adjustments have been made, notify the plugin to finish up the operation.
 		FFrozenWorldPlugin::Get()->RefreezeFinish();
 
+		if (deferred == nullptr)
+		{
+			IndexFragment(*targetFragment);
+		}
+
+		PrioritizeDeferredAdjustments();
+
 		check(IsInGameThread());
 		refitNotifications.ExecuteIfBound(targetFragment->FragmentId, absorbedIds);
 
@@ -10,7 +10,12 @@
 
 #include "Fragment.h"
 #include "AttachmentPoint.h"
+#include "AttachmentPointBatchListener.h"
+#include "AttachmentPointIndex.h"
+#include "AttachmentPointPool.h"
+#include "DeferredAdjustments.h"
 #include "FrozenWorldInterop.h"
+#include "WorldLockingToolsTypes.h"
 
 #include "Features/IModularFeatures.h"
 
@@ -18,8 +23,10 @@ namespace WorldLockingTools
 {
 	struct PendingAttachmentPoint
 	{
-		TSharedPtr<FAttachmentPoint> target;
-		TSharedPtr<FAttachmentPoint> context;
+		FAttachmentPointHandle target;
+		FAttachmentPointHandle context;
+		double queuedTime;
+		float priority;
 	};
 
 	/// <summary>
@@ -39,20 +46,80 @@ namespace WorldLockingTools
 		void Reset();
 
 		void ApplyActiveCurrentFragment();
-		void SetupAttachmentPoint(TSharedPtr<FAttachmentPoint> target, TSharedPtr<FAttachmentPoint> context);
-		void AddPendingAttachmentPoint(TSharedPtr<FAttachmentPoint> attachPoint, TSharedPtr<FAttachmentPoint> context);
+		void SetupAttachmentPoint(FAttachmentPointHandle target, FAttachmentPointHandle context);
+		void AddPendingAttachmentPoint(FAttachmentPointHandle attachPoint, FAttachmentPointHandle context);
 
-		TSharedPtr<FAttachmentPoint> CreateAttachmentPoint(
+		FAttachmentPointHandle CreateAttachmentPoint(
 			FVector frozenPosition,
-			TSharedPtr<FAttachmentPoint> context,
+			FAttachmentPointHandle context,
 			FAttachmentPoint::FAdjustLocationDelegate LocationHandler,
-			FAttachmentPoint::FAdjustStateDelegate StateHandler);
-		void TeleportAttachmentPoint(TSharedPtr<FAttachmentPoint> attachPointIface, FVector newFrozenPosition, TSharedPtr<FAttachmentPoint> context);
-		void ReleaseAttachmentPoint(TSharedPtr<FAttachmentPoint> AttachmentPoint);
+			FAttachmentPoint::FAdjustStateDelegate StateHandler,
+			FAttachmentPointBatchListener* BatchListener = nullptr);
+		void TeleportAttachmentPoint(FAttachmentPointHandle attachPointIface, FVector newFrozenPosition, FAttachmentPointHandle context);
+		void MoveAttachmentPoint(FAttachmentPointHandle attachPoint, FVector newFrozenPosition);
+		void MoveAttachmentPoints(TArrayView<const FAttachmentPointHandle> attachPoints, TArrayView<const FVector> newFrozenPositions);
+		void QueueAttachmentPointMove(FAttachmentPointHandle attachPoint, FVector newFrozenPosition);
+		void ReleaseAttachmentPoint(FAttachmentPointHandle AttachmentPoint);
+
+		// Adjustments and state changes of the given attachment points since an epoch, see FAttachmentPointPool::GetChangesSince.
+		uint64 GetAttachmentPointChanges(uint64 sinceEpoch, TArrayView<const FAttachmentPointHandle> handles, TArray<AttachmentPointChange>& outChanges) const
+		{
+			return attachmentPoints.GetChangesSince(sinceEpoch, handles, outChanges);
+		}
+
+		// The attachment point behind a handle, for polling its state and adjustment. Null once released.
+		// Only valid until the next attachment point is created or released.
+		const FAttachmentPoint* GetAttachmentPoint(FAttachmentPointHandle attachPoint) const
+		{
+			return attachmentPoints.Get(attachPoint);
+		}
+		void RemoveBatchListener(FAttachmentPointBatchListener* batchListener);
+
+		void FindAttachmentPointsInRadius(FVector frozenPosition, float radius, TArray<FAttachmentPointHandle>& outHandles,
+			FrozenWorld_FragmentId fragmentId = FrozenWorld_FragmentId_INVALID) const;
+		void FindAttachmentPointsInBox(const FBox& frozenBox, TArray<FAttachmentPointHandle>& outHandles,
+			FrozenWorld_FragmentId fragmentId = FrozenWorld_FragmentId_INVALID) const;
+		FAttachmentPointHandle FindNearestAttachmentPoint(FVector frozenPosition, float maxDistance,
+			FrozenWorld_FragmentId fragmentId = FrozenWorld_FragmentId_INVALID) const;
+		void FindFragmentsInRadius(FVector frozenPosition, float radius, TArray<FrozenWorld_FragmentId>& outFragmentIds) const;
+
+		// Grid cell size of the attachment point spatial index, best close to the typical query radius.
+		void SetAttachmentPointIndexCellSize(float cellSize)
+		{
+			attachmentPointIndex.SetCellSize(cellSize);
+		}
+		void ReassignAnchor(FrozenWorld_AnchorId oldAnchorId, FrozenWorld_AnchorId newAnchorId, FTransform newAnchorFromOldAnchor);
+		void ResolveAttachmentPoints(const TSet<FrozenWorld_AnchorId>& anchorIds);
 
 		bool Merge();
 		bool Refreeze();
 
+		// Attachment points per worker task when computing refreeze adjustments, zero or negative for the game thread only.
+		int AdjustmentBatchSize = 0;
+
+		// CPU time per frame for applying refit adjustments to attachment points, zero or negative to apply all at once.
+		float RefitBudgetMicroseconds = 0.0f;
+
+		// Attachment points still waiting for the adjustment of the last refit.
+		int NumDeferredAdjustments() const
+		{
+			return deferredAdjustments.Num();
+		}
+
+		void FlushDeferredAdjustments();
+
+		// Pending attachment points set up per frame and CPU time for it, zero or negative for no limit.
+		int MaxPendingAttachmentPointsPerFrame = 0;
+		float PendingAttachmentPointBudgetMicroseconds = 0.0f;
+
+		FPendingAttachmentPointStats GetPendingAttachmentPointStats() const
+		{
+			return pendingAttachmentPointStats;
+		}
+
+		static float GetPriority(FVector position, const FTransform& lockedHead);
+		static void PrioritizePendingAttachmentPoints(TArray<PendingAttachmentPoint>& pending, const FAttachmentPointPool& pool, const FTransform& lockedHead);
+
 		DECLARE_DELEGATE_TwoParams(FRefitNotificationDelegate, FrozenWorld_FragmentId, TArray<FrozenWorld_FragmentId>);
 		FRefitNotificationDelegate refitNotifications;
 
@@ -65,10 +132,22 @@ namespace WorldLockingTools
 	private:
 		TSharedPtr<FFragment> EnsureFragment(FrozenWorld_FragmentId id);
 		void ProcessPendingAttachmentPoints();
+		void DispatchBatchUpdates();
+		void ProcessQueuedMoves();
+
+		TArray<DeferredAdjustment>* BeginDeferredAdjustments();
+		void PrioritizeDeferredAdjustments();
+		void ApplyDeferredAdjustments(float budgetMicroseconds);
+
+		void IndexAttachmentPoint(FAttachmentPointHandle attachPoint);
+		void IndexFragment(FFragment& fragment);
+		const FFragment* FindQueryFragment(FrozenWorld_FragmentId fragmentId) const;
 
 		TArray<FrozenWorld_FragmentId> ExtractFragmentIds(TArray<FragmentPose> source);
 
 		FrozenWorld_FragmentId CurrentFragmentId;
+		// The fragment last made Normal by ApplyActiveCurrentFragment, all others are Unconnected.
+		FrozenWorld_FragmentId appliedFragmentId = FrozenWorld_FragmentId_INVALID;
 
 	public:
 		FrozenWorld_FragmentId GetCurrentFragmentId()
@@ -77,10 +156,23 @@ namespace WorldLockingTools
 		}
 
 	private:
+		FAttachmentPointPool attachmentPoints;
+		FAttachmentPointIndex attachmentPointIndex;
 		TMap<FrozenWorld_FragmentId, TSharedPtr<FFragment>> fragments;
 		TArray<PendingAttachmentPoint> pendingAttachments;
+		FPendingAttachmentPointStats pendingAttachmentPointStats;
+		double totalPendingLatency = 0;
+		TSet<FAttachmentPointBatchListener*> batchListeners;
+		// Kept between frames, so dispatching doesn't allocate.
+		TArray<FAttachmentPointBatchListener*> dispatchingListeners;
+
+		TMap<FAttachmentPointHandle, FVector> queuedMoves;
+		TArray<AttachmentPointMove> moveBuffer;
+		TArray<FAttachmentPointHandle> moveBufferHandles;
+
+		FDeferredAdjustments deferredAdjustments;
 
-		FrozenWorld_FragmentId GetTargetFragmentId(TSharedPtr<FAttachmentPoint> context);
-		void ChangeAttachmentPointFragment(FrozenWorld_FragmentId oldFragmentId, TSharedPtr<FAttachmentPoint> attachPoint);
+		FrozenWorld_FragmentId GetTargetFragmentId(FAttachmentPointHandle context);
+		void ChangeAttachmentPointFragment(FrozenWorld_FragmentId oldFragmentId, FAttachmentPointHandle attachPoint);
 	};
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "FrozenWorldInterop.h"
 
+#include "Async/ParallelFor.h"
 #include "Interfaces/IPluginManager.h"
 #include "Misc/Paths.h"
 
@@ -156,6 +157,104 @@ namespace WorldLockingTools
 		return adjusted;
 	}
 
+	/// <summary>
+	/// Compute the refreeze adjustments of many attachment points at once.
+	/// 
+	/// By default all of them are computed on the calling thread. Given a batch size, they are split into batches
+	/// computed on worker threads, on the assumption that the engine only reads the prepared refreeze while computing
+	/// adjustments. The engine doesn't guarantee that, so this is opt-in. The engine keeps only its latest error, so errors
+	/// are checked after every adjustment on the calling thread, but only once all batches are done on worker threads,
+	/// where checking would race on that error.
+	/// </summary>
+	/// <param name="adjustmentsInOut">Anchoring of each attachment point, replaced by its adjusted anchoring and adjustment.</param>
+	/// <param name="batchSize">Attachment points per worker task. Zero or negative computes all of them on the calling thread.</param>
+	void FFrozenWorldInterop::ComputeAttachmentPointAdjustments(TArrayView<AttachmentPointAdjustment> adjustmentsInOut, int batchSize)
+	{
+		auto computeRange = [this, adjustmentsInOut](int begin, int end, bool checkEach)
+		{
+			for (int i = begin; i < end; ++i)
+			{
+				AttachmentPointAdjustment& entry = adjustmentsInOut[i];
+
+				FrozenWorld_AttachmentPoint attachmentPoint;
+				attachmentPoint.anchorId = entry.anchorId;
+				attachmentPoint.locationFromAnchor = UtoF(entry.locationFromAnchor);
+
+				FrozenWorld_Transform fwAdjustment;
+				entry.adjusted = FW_RefitRefreeze_CalcAdjustment(&attachmentPoint, &fwAdjustment);
+				if (checkEach)
+				{
+					checkError();
+				}
+				if (entry.adjusted)
+				{
+					entry.anchorId = attachmentPoint.anchorId;
+					entry.locationFromAnchor = FtoU(attachmentPoint.locationFromAnchor);
+					entry.adjustment = FtoU(fwAdjustment);
+				}
+			}
+		};
+
+		int count = adjustmentsInOut.Num();
+		if (batchSize <= 0 || count <= batchSize)
+		{
+			computeRange(0, count, true);
+		}
+		else
+		{
+			int numBatches = FMath::DivideAndRoundUp(count, batchSize);
+			ParallelFor(numBatches, [&computeRange, count, batchSize](int32 batch)
+			{
+				computeRange(batch * batchSize, FMath::Min(count, (batch + 1) * batchSize), false);
+			});
+			checkError();
+		}
+	}
+
+	/// <summary>
+	/// Move attachment points along with the objects they are attached to.
+	/// 
+	/// Unlike creating an attachment point at the target position, this walks the anchor graph from
+	/// the attachment point's current anchor, so moving objects keep their continuity.
+	/// </summary>
+	/// <param name="movesInOut">Anchoring, fragment and target position of each attachment point, anchoring and fragment replaced by those at the target.</param>
+	void FFrozenWorldInterop::MoveAttachmentPoints(TArrayView<AttachmentPointMove> movesInOut)
+	{
+		bool anchorChanged = false;
+		for (AttachmentPointMove& move : movesInOut)
+		{
+			FrozenWorld_AttachmentPoint attachmentPoint;
+			attachmentPoint.anchorId = move.anchorId;
+			attachmentPoint.locationFromAnchor = UtoF(move.locationFromAnchor);
+
+			FrozenWorld_Vector v = UtoF(move.targetFrozenPosition);
+			FW_Tracking_Move(&v, &attachmentPoint);
+			checkError();
+
+			anchorChanged |= attachmentPoint.anchorId != move.anchorId;
+			move.anchorId = attachmentPoint.anchorId;
+			move.locationFromAnchor = FtoU(attachmentPoint.locationFromAnchor);
+		}
+
+		// The engine has no lookup of a single anchor's fragment, so read them all, only when some attachment point changed anchor.
+		if (!anchorChanged)
+		{
+			return;
+		}
+		TMap<FrozenWorld_AnchorId, FrozenWorld_FragmentId> anchorFragments;
+		for (const FrozenWorld_Anchor& anchor : GetFrozenAnchors())
+		{
+			anchorFragments.Add(anchor.anchorId, anchor.fragmentId);
+		}
+		for (AttachmentPointMove& move : movesInOut)
+		{
+			if (const FrozenWorld_FragmentId* fragmentId = anchorFragments.Find(move.anchorId))
+			{
+				move.fragmentId = *fragmentId;
+			}
+		}
+	}
+
 	bool FFrozenWorldInterop::Merge(FrozenWorld_FragmentId& outTargetFragment, TArray<FragmentPose> outMergedFragments)
 	{
 		outTargetFragment = FrozenWorld_FragmentId_INVALID;
@@ -343,6 +442,87 @@ namespace WorldLockingTools
 		return res;
 	}
 
+	TArray<FrozenWorld_Anchor> FFrozenWorldInterop::GetFrozenAnchors()
+	{
+		int numAnchors = FW_GetNumAnchors(FrozenWorld_Snapshot_FROZEN);
+		checkError();
+
+		TArray<FrozenWorld_Anchor> res;
+		if (numAnchors > 0)
+		{
+			res.AddUninitialized(numAnchors);
+			int numRead = FW_GetAnchors(FrozenWorld_Snapshot_FROZEN, numAnchors, &res[0]);
+			checkError();
+			res.SetNum(FMath::Clamp(numRead, 0, numAnchors));
+		}
+
+		return res;
+	}
+
+	void FFrozenWorldInterop::AddFrozenAnchors(TArray<FrozenWorld_Anchor> anchors)
+	{
+		if (anchors.Num() == 0)
+		{
+			return;
+		}
+
+		FW_AddAnchors(FrozenWorld_Snapshot_FROZEN, anchors.Num(), &anchors[0]);
+		checkError();
+	}
+
+	void FFrozenWorldInterop::AddFrozenEdges(TArray<FrozenWorld_Edge> edges)
+	{
+		if (edges.Num() == 0)
+		{
+			return;
+		}
+
+		FW_AddEdges(FrozenWorld_Snapshot_FROZEN, edges.Num(), &edges[0]);
+		checkError();
+	}
+
+	TArray<FrozenWorld_Edge> FFrozenWorldInterop::GetFrozenEdges()
+	{
+		int numEdges = FW_GetNumEdges(FrozenWorld_Snapshot_FROZEN);
+		checkError();
+
+		TArray<FrozenWorld_Edge> res;
+		if (numEdges > 0)
+		{
+			res.AddUninitialized(numEdges);
+			int numRead = FW_GetEdges(FrozenWorld_Snapshot_FROZEN, numEdges, &res[0]);
+			checkError();
+			res.SetNum(FMath::Clamp(numRead, 0, numEdges));
+		}
+
+		return res;
+	}
+
+	void FFrozenWorldInterop::RemoveFrozenEdge(FrozenWorld_AnchorId anchorId1, FrozenWorld_AnchorId anchorId2)
+	{
+		FW_RemoveEdge(FrozenWorld_Snapshot_FROZEN, anchorId1, anchorId2);
+		checkError();
+	}
+
+	TArray<FrozenWorld_Edge> FFrozenWorldInterop::GuessMissingEdges()
+	{
+		// Guessed edges reconnect otherwise disconnected parts of the graph,
+		// so there can't be more of them than there are anchors.
+		int bufSize = FW_GetNumAnchors(FrozenWorld_Snapshot_FROZEN);
+		checkError();
+
+		TArray<FrozenWorld_Edge> res;
+		if (bufSize > 0)
+		{
+			res.AddUninitialized(bufSize);
+			int numGuessed = FW_GuessMissingEdges(FrozenWorld_Snapshot_FROZEN, bufSize, &res[0]);
+			checkError();
+			res.SetNum(FMath::Clamp(numGuessed, 0, bufSize));
+		}
+
+		return res;
+	}
+
 	void FFrozenWorldInterop::LoadFrozenWorld()
 	{
 #if defined(USING_FROZEN_WORLD)
@@ -18,6 +18,29 @@ namespace WorldLockingTools
 		FTransform pose;
 	};
 
+	/// <summary>
+	/// An attachment point's anchoring going into a refreeze adjustment, replaced by its new anchoring coming out.
+	/// </summary>
+	struct AttachmentPointAdjustment
+	{
+		FrozenWorld_AnchorId anchorId;
+		FVector locationFromAnchor;
+		FTransform adjustment;
+		bool adjusted;
+	};
+
+	/// <summary>
+	/// An attachment point's anchoring going into a move, replaced by its anchoring at the target position coming out,
+	/// with the fragment of the anchor it ends up on.
+	/// </summary>
+	struct AttachmentPointMove
+	{
+		FrozenWorld_AnchorId anchorId;
+		FVector locationFromAnchor;
+		FVector targetFrozenPosition;
+		FrozenWorld_FragmentId fragmentId;
+	};
+
 	class FFrozenWorldInterop
 	{
 	public:
@@ -81,6 +104,8 @@ namespace WorldLockingTools
 
 		bool ComputeAttachmentPointAdjustment(FrozenWorld_AnchorId oldAnchorId, FVector oldLocationFromAnchor,
 			FrozenWorld_AnchorId& outNewAnchorId, FVector& outNewLocationFromAnchor, FTransform& outAdjustment);
+		void ComputeAttachmentPointAdjustments(TArrayView<AttachmentPointAdjustment> adjustmentsInOut, int batchSize);
+		void MoveAttachmentPoints(TArrayView<AttachmentPointMove> movesInOut);
 
 		bool Merge(FrozenWorld_FragmentId& outTargetFragment, TArray<FragmentPose> outMergedFragments);
 		bool Refreeze(FrozenWorld_FragmentId& outMergedId, TArray<FrozenWorld_FragmentId> outAbsorbedFragments);
@@ -103,6 +128,12 @@ namespace WorldLockingTools
 		void DeserializeClose(FrozenWorld_Deserialize_Stream* streamInOut);
 
 		TArray<FrozenWorld_AnchorId> GetFrozenAnchorIds();
+		TArray<FrozenWorld_Anchor> GetFrozenAnchors();
+		void AddFrozenAnchors(TArray<FrozenWorld_Anchor> anchors);
+		void AddFrozenEdges(TArray<FrozenWorld_Edge> edges);
+		TArray<FrozenWorld_Edge> GetFrozenEdges();
+		void RemoveFrozenEdge(FrozenWorld_AnchorId anchorId1, FrozenWorld_AnchorId anchorId2);
+		TArray<FrozenWorld_Edge> GuessMissingEdges();
 
 	public:
 		// Version
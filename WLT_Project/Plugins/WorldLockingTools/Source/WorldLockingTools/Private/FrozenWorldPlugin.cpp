@@ -57,6 +57,26 @@ namespace WorldLockingTools
 		FrozenWorldAnchorManager.MinNewAnchorDistance = Configuration.MinNewAnchorDistance;
 		FrozenWorldAnchorManager.MaxAnchorEdgeLength = Configuration.MaxAnchorEdgeLength;
 		FrozenWorldAnchorManager.MaxLocalAnchors = Configuration.MaxLocalAnchors;
+		FrozenWorldAnchorManager.MaxAnchorRestoresPerFrame = Configuration.MaxAnchorRestoresPerFrame;
+		FrozenWorldAnchorManager.AnchorEdgeMode = Configuration.AnchorEdgeMode;
+		FrozenWorldAnchorManager.MaxAnchorEdgesPerAnchor = Configuration.MaxAnchorEdgesPerAnchor;
+		FrozenWorldAnchorManager.MaxGraphRepairsPerFrame = Configuration.MaxGraphRepairsPerFrame;
+		FrozenWorldAnchorManager.AnchorRegionSize = Configuration.AnchorRegionSize;
+		FrozenWorldAnchorManager.AnchorRegionLoadRadius = Configuration.AnchorRegionLoadRadius;
+		FrozenWorldAnchorManager.AnchorRegionUnloadRadius = Configuration.AnchorRegionUnloadRadius;
+		FrozenWorldAnchorManager.MaxPooledAnchorComponents = Configuration.MaxPooledAnchorComponents;
+		FrozenWorldAnchorManager.PrewarmAnchorComponentPool(Configuration.PrewarmAnchorComponents);
+		FrozenWorldAnchorManager.AnchorConsolidationDistance = Configuration.AnchorConsolidationDistance;
+		FrozenWorldAnchorManager.AnchorConsolidationTolerance = Configuration.AnchorConsolidationTolerance;
+		FrozenWorldAnchorManager.AnchorConsolidationInterval = Configuration.AnchorConsolidationInterval;
+		FrozenWorldFragmentManager.AdjustmentBatchSize = Configuration.AdjustmentBatchSize;
+		FrozenWorldFragmentManager.RefitBudgetMicroseconds = Configuration.RefitBudgetMicroseconds;
+		FrozenWorldFragmentManager.MaxPendingAttachmentPointsPerFrame = Configuration.MaxPendingAttachmentPointsPerFrame;
+		FrozenWorldFragmentManager.PendingAttachmentPointBudgetMicroseconds = Configuration.PendingAttachmentPointBudgetMicroseconds;
+		FrozenWorldFragmentManager.SetAttachmentPointIndexCellSize(Configuration.AttachmentPointIndexCellSize);
+		FrozenWorldAlignmentManager.SetDelaunayTriangulation(Configuration.DelaunayTriangulation);
+		FrozenWorldAlignmentManager.SetEigenRotationAveraging(Configuration.EigenRotationAveraging);
+		FrozenWorldAlignmentManager.SetAlignmentLevels(Configuration.AlignmentLevelSeparation, Configuration.AlignmentLevelBlendHeight);
 
 		Enabled = true;
 
@@ -84,6 +104,7 @@ namespace WorldLockingTools
 			else
 			{
 				Reset();
+				FrozenWorldAnchorManager.DiscardStoredRegions();
 				initializationState = InitializationState::Running;
 			}
 		}
@@ -234,6 +255,11 @@ namespace WorldLockingTools
 		return FFrozenWorldPoseExtensions::Multiply(lockedFromPlayspace, PlayspaceFromSpongy());
 	}
 
+	FTransform FFrozenWorldPlugin::LockedFromCamera()
+	{
+		return FFrozenWorldPoseExtensions::Multiply(LockedFromSpongy(), spongyFromCamera);
+	}
+
 	void FFrozenWorldPlugin::Update()
 	{
 		if (CameraParent == nullptr || AdjustmentFrame == nullptr)
@@ -363,6 +389,9 @@ namespace WorldLockingTools
 			return;
 		}
 
+		// Releasing the anchors' pins and scene components, and the attachment points, has to be done on the game thread.
+		Reset();
+
 		TSharedPtr<BackgroundOperation> LoadTask = MakeShared<BackgroundOperation>();
 		LoadTask->QueueBackgroundTask([WeakThis{ TWeakPtr<FFrozenWorldPlugin, ESPMode::ThreadSafe>(AsShared()) }, LoadTask]()
 		{
@@ -370,8 +399,6 @@ namespace WorldLockingTools
 			{
 				This->hasPendingLoadTask = true;
 
-				This->Reset();
-
 				FString tryFileNames[] = { This->stateFileNameBase, This->stateFileNameBase + ".old" };
 
 				for (FString fileName : tryFileNames)
@@ -399,7 +426,6 @@ namespace WorldLockingTools
 						This->FrozenWorldInterop.DeserializeApply(&ps);
 						This->FrozenWorldInterop.DeserializeClose(&ps);
 
-						This->FrozenWorldAnchorManager.LoadAnchors();
 						This->FrozenWorldAlignmentManager.Load();
 
 						// finish when reading was successful
@@ -409,6 +435,9 @@ namespace WorldLockingTools
 					}
 				}
 
+				// Also without a saved state, so regions paged out by an earlier session are found and their anchor ids aren't reused.
+				This->FrozenWorldAnchorManager.LoadAnchors();
+
 				This->hasPendingLoadTask = false;
 				This->initializationState = InitializationState::Running;
 			}
@@ -520,11 +549,64 @@ namespace WorldLockingTools
 		return FrozenWorldInterop.GetMetrics();
 	}
 
+	FAnchorComponentPoolStats FFrozenWorldPlugin::GetAnchorComponentPoolStats()
+	{
+		return FrozenWorldAnchorManager.GetAnchorComponentPoolStats();
+	}
+
+	FAnchorConsolidationStats FFrozenWorldPlugin::GetAnchorConsolidationStats()
+	{
+		return FrozenWorldAnchorManager.GetAnchorConsolidationStats();
+	}
+
+	FPendingAttachmentPointStats FFrozenWorldPlugin::GetPendingAttachmentPointStats()
+	{
+		return FrozenWorldFragmentManager.GetPendingAttachmentPointStats();
+	}
+
+	TArray<FTransform> FFrozenWorldPlugin::ComputePinnedFromLockedPoses(const TArray<FVector>& lockedPositions, int batchSize)
+	{
+		TArray<FTransform> pinnedFromLockedPoses;
+		pinnedFromLockedPoses.SetNumUninitialized(lockedPositions.Num());
+		FrozenWorldAlignmentManager.ComputePinnedPoses(lockedPositions, pinnedFromLockedPoses, batchSize);
+		return pinnedFromLockedPoses;
+	}
+
 	void FFrozenWorldPlugin::RemoveFrozenAnchor(FrozenWorld_AnchorId anchorId)
 	{
 		FrozenWorldInterop.RemoveFrozenAnchor(anchorId);
 	}
 
+	TArray<FrozenWorld_Edge> FFrozenWorldPlugin::GetFrozenEdges()
+	{
+		return FrozenWorldInterop.GetFrozenEdges();
+	}
+
+	void FFrozenWorldPlugin::RemoveFrozenEdge(FrozenWorld_AnchorId anchorId1, FrozenWorld_AnchorId anchorId2)
+	{
+		FrozenWorldInterop.RemoveFrozenEdge(anchorId1, anchorId2);
+	}
+
+	TArray<FrozenWorld_Edge> FFrozenWorldPlugin::GuessMissingEdges()
+	{
+		return FrozenWorldInterop.GuessMissingEdges();
+	}
+
+	TArray<FrozenWorld_Anchor> FFrozenWorldPlugin::GetFrozenAnchors()
+	{
+		return FrozenWorldInterop.GetFrozenAnchors();
+	}
+
+	void FFrozenWorldPlugin::AddFrozenAnchors(TArray<FrozenWorld_Anchor> anchors)
+	{
+		FrozenWorldInterop.AddFrozenAnchors(anchors);
+	}
+
+	void FFrozenWorldPlugin::AddFrozenEdges(TArray<FrozenWorld_Edge> edges)
+	{
+		FrozenWorldInterop.AddFrozenEdges(edges);
+	}
+
 	FrozenWorld_FragmentId FFrozenWorldPlugin::GetMostSignificantFragmentId()
 	{
 		return FrozenWorldInterop.GetMostSignificantFragmentId();
@@ -549,6 +631,16 @@ namespace WorldLockingTools
 			outNewAnchorId, outNewLocationFromAnchor, outAdjustment);
 	}
 
+	void FFrozenWorldPlugin::ComputeAttachmentPointAdjustments(TArrayView<AttachmentPointAdjustment> adjustmentsInOut, int batchSize)
+	{
+		FrozenWorldInterop.ComputeAttachmentPointAdjustments(adjustmentsInOut, batchSize);
+	}
+
+	void FFrozenWorldPlugin::MoveAttachmentPoints(TArrayView<AttachmentPointMove> movesInOut)
+	{
+		FrozenWorldInterop.MoveAttachmentPoints(movesInOut);
+	}
+
 	bool FFrozenWorldPlugin::Merge(FrozenWorld_FragmentId& outTargetFragment, TArray<FragmentPose> outMergedFragments)
 	{
 		return FrozenWorldInterop.Merge(outTargetFragment, outMergedFragments);
@@ -96,6 +96,7 @@ namespace WorldLockingTools
 		FTransform PinnedFromLocked();
 		FTransform PinnedFromFrozen();
 		FTransform LockedFromSpongy();
+		FTransform LockedFromCamera();
 
 		TArray<FrozenWorld_AnchorId> GetFrozenAnchorIds();
 
@@ -109,9 +110,21 @@ namespace WorldLockingTools
 		void Step_Finish();
 
 		FrozenWorld_Metrics GetMetrics();
+		FAnchorComponentPoolStats GetAnchorComponentPoolStats();
+		FAnchorConsolidationStats GetAnchorConsolidationStats();
+		FPendingAttachmentPointStats GetPendingAttachmentPointStats();
+		TArray<FTransform> ComputePinnedFromLockedPoses(const TArray<FVector>& lockedPositions, int batchSize);
 
 		void RemoveFrozenAnchor(FrozenWorld_AnchorId anchorId);
 
+		TArray<FrozenWorld_Edge> GetFrozenEdges();
+		void RemoveFrozenEdge(FrozenWorld_AnchorId anchorId1, FrozenWorld_AnchorId anchorId2);
+		TArray<FrozenWorld_Edge> GuessMissingEdges();
+
+		TArray<FrozenWorld_Anchor> GetFrozenAnchors();
+		void AddFrozenAnchors(TArray<FrozenWorld_Anchor> anchors);
+		void AddFrozenEdges(TArray<FrozenWorld_Edge> edges);
+
 		FrozenWorld_FragmentId GetMostSignificantFragmentId();
 
 		void CreateAttachmentPointFromHead(FVector frozenPosition, FrozenWorld_AnchorId& outAnchorId, FVector outLocationFromAnchor);
@@ -120,6 +133,8 @@ namespace WorldLockingTools
 
 		bool ComputeAttachmentPointAdjustment(FrozenWorld_AnchorId oldAnchorId, FVector oldLocationFromAnchor,
 			FrozenWorld_AnchorId& outNewAnchorId, FVector& outNewLocationFromAnchor, FTransform& outAdjustment);
+		void ComputeAttachmentPointAdjustments(TArrayView<AttachmentPointAdjustment> adjustmentsInOut, int batchSize);
+		void MoveAttachmentPoints(TArrayView<AttachmentPointMove> movesInOut);
 
 		bool Merge(FrozenWorld_FragmentId& outTargetFragment, TArray<FragmentPose> outMergedFragments);
 		bool Refreeze(FrozenWorld_FragmentId& outMergedId, TArray<FrozenWorld_FragmentId> outAbsorbedFragments);
@@ -0,0 +1,278 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "GeometricPredicates.h"
+
+#include <cmath>
+
+// The exact arithmetic depends on every operation being rounded as written, which fast floating point modes don't guarantee.
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma float_control(precise, on, push)
+#endif
+
+namespace WorldLockingTools
+{
+	namespace
+	{
+		/// A number represented exactly as the sum of its components, which don't overlap and grow in magnitude.
+		using FExpansion = TArray<double, TInlineAllocator<32>>;
+
+		/// Half the distance from 1 to the next double.
+		const double PredicateEpsilon = 1.1102230246251565e-16;
+		const double OrientErrorBound = (3.0 + 16.0 * PredicateEpsilon) * PredicateEpsilon;
+		const double InCircleErrorBound = (10.0 + 96.0 * PredicateEpsilon) * PredicateEpsilon;
+
+		/// x + y == a + b exactly, where x is the rounded sum. Requires |a| >= |b|.
+		void FastTwoSum(double a, double b, double& x, double& y)
+		{
+			x = a + b;
+			double bVirtual = x - a;
+			y = b - bVirtual;
+		}
+
+		/// x + y == a + b exactly, where x is the rounded sum.
+		void TwoSum(double a, double b, double& x, double& y)
+		{
+			x = a + b;
+			double bVirtual = x - a;
+			double aVirtual = x - bVirtual;
+			y = (a - aVirtual) + (b - bVirtual);
+		}
+
+		/// x + y == a * b exactly, where x is the rounded product.
+		void TwoProduct(double a, double b, double& x, double& y)
+		{
+			x = a * b;
+			y = std::fma(a, b, -x);
+		}
+
+		/// The exact difference a - b.
+		FExpansion ExpansionDifference(double a, double b)
+		{
+			double x, y;
+			TwoSum(a, -b, x, y);
+			FExpansion result;
+			if (y != 0)
+			{
+				result.Add(y);
+			}
+			result.Add(x);
+			return result;
+		}
+
+		/// The exact sum of two expansions, merging their components by magnitude (fast_expansion_sum_zeroelim).
+		FExpansion ExpansionSum(const FExpansion& e, const FExpansion& f)
+		{
+			FExpansion result;
+			result.Reserve(e.Num() + f.Num());
+
+			int eIndex = 0;
+			int fIndex = 0;
+			auto nextIsE = [&]()
+			{
+				if (fIndex >= f.Num())
+				{
+					return true;
+				}
+				if (eIndex >= e.Num())
+				{
+					return false;
+				}
+				return (f[fIndex] > e[eIndex]) == (f[fIndex] > -e[eIndex]);
+			};
+			auto next = [&]()
+			{
+				return nextIsE() ? e[eIndex++] : f[fIndex++];
+			};
+
+			double q = next();
+			if (eIndex < e.Num() && fIndex < f.Num())
+			{
+				double x, y;
+				FastTwoSum(next(), q, x, y);
+				q = x;
+				if (y != 0)
+				{
+					result.Add(y);
+				}
+			}
+			while (eIndex < e.Num() || fIndex < f.Num())
+			{
+				double x, y;
+				TwoSum(q, next(), x, y);
+				q = x;
+				if (y != 0)
+				{
+					result.Add(y);
+				}
+			}
+			if (q != 0 || result.Num() == 0)
+			{
+				result.Add(q);
+			}
+			return result;
+		}
+
+		/// The exact product of an expansion and a double (scale_expansion_zeroelim).
+		FExpansion ExpansionScale(const FExpansion& e, double b)
+		{
+			FExpansion result;
+			result.Reserve(e.Num() * 2);
+
+			double q, y;
+			TwoProduct(e[0], b, q, y);
+			if (y != 0)
+			{
+				result.Add(y);
+			}
+			for (int i = 1; i < e.Num(); ++i)
+			{
+				double product1, product0, sum;
+				TwoProduct(e[i], b, product1, product0);
+				TwoSum(q, product0, sum, y);
+				if (y != 0)
+				{
+					result.Add(y);
+				}
+				FastTwoSum(product1, sum, q, y);
+				if (y != 0)
+				{
+					result.Add(y);
+				}
+			}
+			if (q != 0 || result.Num() == 0)
+			{
+				result.Add(q);
+			}
+			return result;
+		}
+
+		FExpansion ExpansionProduct(const FExpansion& e, const FExpansion& f)
+		{
+			FExpansion result = ExpansionScale(e, f[0]);
+			for (int i = 1; i < f.Num(); ++i)
+			{
+				result = ExpansionSum(result, ExpansionScale(e, f[i]));
+			}
+			return result;
+		}
+
+		FExpansion ExpansionNegate(FExpansion e)
+		{
+			for (double& component : e)
+			{
+				component = -component;
+			}
+			return e;
+		}
+
+		/// The largest component, which has the sign of the whole expansion.
+		double ExpansionEstimate(const FExpansion& e)
+		{
+			return e.Last();
+		}
+
+		double Orient2DExact(const FVector& a, const FVector& b, const FVector& c)
+		{
+			FExpansion acx = ExpansionDifference(a.X, c.X);
+			FExpansion acy = ExpansionDifference(a.Y, c.Y);
+			FExpansion bcx = ExpansionDifference(b.X, c.X);
+			FExpansion bcy = ExpansionDifference(b.Y, c.Y);
+			return ExpansionEstimate(ExpansionSum(ExpansionProduct(acx, bcy), ExpansionNegate(ExpansionProduct(acy, bcx))));
+		}
+
+		double InCircleExact(const FVector& a, const FVector& b, const FVector& c, const FVector& d)
+		{
+			FExpansion adx = ExpansionDifference(a.X, d.X);
+			FExpansion ady = ExpansionDifference(a.Y, d.Y);
+			FExpansion bdx = ExpansionDifference(b.X, d.X);
+			FExpansion bdy = ExpansionDifference(b.Y, d.Y);
+			FExpansion cdx = ExpansionDifference(c.X, d.X);
+			FExpansion cdy = ExpansionDifference(c.Y, d.Y);
+
+			FExpansion aLift = ExpansionSum(ExpansionProduct(adx, adx), ExpansionProduct(ady, ady));
+			FExpansion bLift = ExpansionSum(ExpansionProduct(bdx, bdx), ExpansionProduct(bdy, bdy));
+			FExpansion cLift = ExpansionSum(ExpansionProduct(cdx, cdx), ExpansionProduct(cdy, cdy));
+
+			FExpansion bcDet = ExpansionSum(ExpansionProduct(bdx, cdy), ExpansionNegate(ExpansionProduct(cdx, bdy)));
+			FExpansion caDet = ExpansionSum(ExpansionProduct(cdx, ady), ExpansionNegate(ExpansionProduct(adx, cdy)));
+			FExpansion abDet = ExpansionSum(ExpansionProduct(adx, bdy), ExpansionNegate(ExpansionProduct(bdx, ady)));
+
+			return ExpansionEstimate(ExpansionSum(ExpansionSum(ExpansionProduct(aLift, bcDet), ExpansionProduct(bLift, caDet)), ExpansionProduct(cLift, abDet)));
+		}
+	}
+
+	double FGeometricPredicates::Orient2D(const FVector& a, const FVector& b, const FVector& c)
+	{
+		double detLeft = (a.X - c.X) * (b.Y - c.Y);
+		double detRight = (a.Y - c.Y) * (b.X - c.X);
+		double det = detLeft - detRight;
+
+		double detSum;
+		if (detLeft > 0)
+		{
+			if (detRight <= 0)
+			{
+				return det;
+			}
+			detSum = detLeft + detRight;
+		}
+		else if (detLeft < 0)
+		{
+			if (detRight >= 0)
+			{
+				return det;
+			}
+			detSum = -detLeft - detRight;
+		}
+		else
+		{
+			return det;
+		}
+
+		double errorBound = OrientErrorBound * detSum;
+		if (det >= errorBound || -det >= errorBound)
+		{
+			return det;
+		}
+		return Orient2DExact(a, b, c);
+	}
+
+	double FGeometricPredicates::InCircle(const FVector& a, const FVector& b, const FVector& c, const FVector& d)
+	{
+		double adx = a.X - d.X;
+		double ady = a.Y - d.Y;
+		double bdx = b.X - d.X;
+		double bdy = b.Y - d.Y;
+		double cdx = c.X - d.X;
+		double cdy = c.Y - d.Y;
+
+		double bdxcdy = bdx * cdy;
+		double cdxbdy = cdx * bdy;
+		double aLift = adx * adx + ady * ady;
+
+		double cdxady = cdx * ady;
+		double adxcdy = adx * cdy;
+		double bLift = bdx * bdx + bdy * bdy;
+
+		double adxbdy = adx * bdy;
+		double bdxady = bdx * ady;
+		double cLift = cdx * cdx + cdy * cdy;
+
+		double det = aLift * (bdxcdy - cdxbdy) + bLift * (cdxady - adxcdy) + cLift * (adxbdy - bdxady);
+		double permanent = (FMath::Abs(bdxcdy) + FMath::Abs(cdxbdy)) * aLift
+			+ (FMath::Abs(cdxady) + FMath::Abs(adxcdy)) * bLift
+			+ (FMath::Abs(adxbdy) + FMath::Abs(bdxady)) * cLift;
+
+		double errorBound = InCircleErrorBound * permanent;
+		if (det > errorBound || -det > errorBound)
+		{
+			return det;
+		}
+		return InCircleExact(a, b, c, d);
+	}
+}
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma float_control(pop)
+#endif
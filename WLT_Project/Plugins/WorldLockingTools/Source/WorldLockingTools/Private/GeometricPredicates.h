@@ -0,0 +1,31 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Orientation and in-circle tests on the horizontal plane, whose sign is exact for any input.
+	///
+	/// Each test is first evaluated in double precision. Only when the result is within its rounding error of zero is it
+	/// evaluated again exactly, with the expansion arithmetic from Shewchuk's "Adaptive Precision Floating-Point Arithmetic
+	/// and Fast Robust Geometric Predicates". Z is ignored throughout.
+	/// </summary>
+	class FGeometricPredicates
+	{
+	public:
+		/// <summary>
+		/// Positive if (b - a) x (c - a) points up, negative if down, zero if a, b and c are collinear.
+		/// </summary>
+		static double Orient2D(const FVector& a, const FVector& b, const FVector& c);
+
+		/// <summary>
+		/// Positive if d is inside the circle through a, b and c, when Orient2D(a, b, c) is positive.
+		/// The sign flips when Orient2D(a, b, c) is negative, and it is zero if d is on the circle.
+		/// </summary>
+		static double InCircle(const FVector& a, const FVector& b, const FVector& c, const FVector& d);
+	};
+}
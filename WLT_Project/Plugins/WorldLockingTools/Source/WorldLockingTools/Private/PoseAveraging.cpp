@@ -0,0 +1,140 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "PoseAveraging.h"
+
+namespace WorldLockingTools
+{
+	namespace
+	{
+		/// Power iteration steps after which the eigenvector is taken as found, however slowly it is still moving.
+		const int MaxEigenIterations = 32;
+
+		/// Change in any component of the unit eigenvector below which it is taken as converged.
+		const double EigenTolerance = 1.0e-12;
+
+		VectorRegister4Double LoadQuat(const FQuat& quat)
+		{
+			return VectorLoad(&quat.X);
+		}
+
+		/// Scale to unit length, returning false if the length is too small to.
+		bool Normalize(VectorRegister4Double vec, double outComponents[4])
+		{
+			VectorStore(vec, outComponents);
+			double lengthSquared = outComponents[0] * outComponents[0] + outComponents[1] * outComponents[1]
+				+ outComponents[2] * outComponents[2] + outComponents[3] * outComponents[3];
+			if (lengthSquared <= UE_DOUBLE_SMALL_NUMBER)
+			{
+				return false;
+			}
+			double invLength = 1.0 / FMath::Sqrt(lengthSquared);
+			for (int i = 0; i < 4; ++i)
+			{
+				outComponents[i] *= invLength;
+			}
+			return true;
+		}
+
+		int HeaviestIndex(TArrayView<const float> weights)
+		{
+			int heaviest = 0;
+			for (int i = 1; i < weights.Num(); ++i)
+			{
+				if (weights[i] > weights[heaviest])
+				{
+					heaviest = i;
+				}
+			}
+			return heaviest;
+		}
+	}
+
+	FQuat FPoseAveraging::AverageRotations(TArrayView<const FQuat> rotations, TArrayView<const float> weights)
+	{
+		check(rotations.Num() == weights.Num());
+		if (rotations.Num() == 0)
+		{
+			return FQuat::Identity;
+		}
+
+		// q and -q are the same rotation, so take each on the side of the heaviest, or opposite ones would cancel out.
+		const FQuat& reference = rotations[HeaviestIndex(weights)];
+		VectorRegister4Double sum = VectorZeroDouble();
+		for (int i = 0; i < rotations.Num(); ++i)
+		{
+			double weight = (rotations[i] | reference) < 0 ? -weights[i] : weights[i];
+			sum = VectorMultiplyAdd(LoadQuat(rotations[i]), VectorSetFloat1(weight), sum);
+		}
+
+		double components[4];
+		if (!Normalize(sum, components))
+		{
+			return FQuat::Identity;
+		}
+		return FQuat(components[0], components[1], components[2], components[3]);
+	}
+
+	FQuat FPoseAveraging::AverageRotationsEigen(TArrayView<const FQuat> rotations, TArrayView<const float> weights)
+	{
+		check(rotations.Num() == weights.Num());
+		FQuat estimate = AverageRotations(rotations, weights);
+		if (rotations.Num() < 2)
+		{
+			return estimate;
+		}
+
+		// The rows of the symmetric matrix sum(weight * q * q^T), whose largest eigenvector is the average.
+		VectorRegister4Double rows[4] = { VectorZeroDouble(), VectorZeroDouble(), VectorZeroDouble(), VectorZeroDouble() };
+		for (int i = 0; i < rotations.Num(); ++i)
+		{
+			const FQuat& rotation = rotations[i];
+			VectorRegister4Double quat = LoadQuat(rotation);
+			double weight = weights[i];
+			rows[0] = VectorMultiplyAdd(quat, VectorSetFloat1(weight * rotation.X), rows[0]);
+			rows[1] = VectorMultiplyAdd(quat, VectorSetFloat1(weight * rotation.Y), rows[1]);
+			rows[2] = VectorMultiplyAdd(quat, VectorSetFloat1(weight * rotation.Z), rows[2]);
+			rows[3] = VectorMultiplyAdd(quat, VectorSetFloat1(weight * rotation.W), rows[3]);
+		}
+
+		// The estimate is already close to the eigenvector unless the rotations are far apart, so few iterations are needed.
+		double current[4] = { estimate.X, estimate.Y, estimate.Z, estimate.W };
+		for (int iteration = 0; iteration < MaxEigenIterations; ++iteration)
+		{
+			VectorRegister4Double product = VectorMultiply(rows[0], VectorSetFloat1(current[0]));
+			product = VectorMultiplyAdd(rows[1], VectorSetFloat1(current[1]), product);
+			product = VectorMultiplyAdd(rows[2], VectorSetFloat1(current[2]), product);
+			product = VectorMultiplyAdd(rows[3], VectorSetFloat1(current[3]), product);
+
+			double next[4];
+			if (!Normalize(product, next))
+			{
+				break;
+			}
+			double change = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				change = FMath::Max(change, FMath::Abs(next[i] - current[i]));
+				current[i] = next[i];
+			}
+			if (change < EigenTolerance)
+			{
+				break;
+			}
+		}
+		return FQuat(current[0], current[1], current[2], current[3]);
+	}
+
+	FVector FPoseAveraging::AveragePositions(TArrayView<const FVector> positions, TArrayView<const float> weights)
+	{
+		check(positions.Num() == weights.Num());
+		FVector sum = FVector::ZeroVector;
+		double totalWeight = 0;
+		for (int i = 0; i < positions.Num(); ++i)
+		{
+			sum += positions[i] * weights[i];
+			totalWeight += weights[i];
+		}
+		return totalWeight > 0 ? sum / totalWeight : FVector::ZeroVector;
+	}
+}
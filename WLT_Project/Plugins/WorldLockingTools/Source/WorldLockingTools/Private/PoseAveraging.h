@@ -0,0 +1,39 @@
+// Copyright (c) 2022 Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace WorldLockingTools
+{
+	/// <summary>
+	/// Weighted averages of poses in closed form, independent of the order of the contributors.
+	///
+	/// Rotations are averaged as quaternions, either by summing them and normalizing the sum, or as the eigenvector of
+	/// the largest eigenvalue of their weighted outer product sum (Markley et al., "Averaging Quaternions"). The sum is
+	/// the cheaper and, for rotations close together, a close approximation of the eigenvector, which minimizes the
+	/// weighted squared chordal distance to the rotations. Negative weights are not supported.
+	/// </summary>
+	class FPoseAveraging
+	{
+	public:
+		/// <summary>
+		/// Sum of the rotations each scaled by its weight, with signs aligned to the most heavily weighted, normalized.
+		/// Identity if the weights sum to zero.
+		/// </summary>
+		static FQuat AverageRotations(TArrayView<const FQuat> rotations, TArrayView<const float> weights);
+
+		/// <summary>
+		/// The rotation minimizing the weighted sum of squared chordal distances to the rotations.
+		/// Found by power iteration, starting from AverageRotations. Identity if the weights sum to zero.
+		/// </summary>
+		static FQuat AverageRotationsEigen(TArrayView<const FQuat> rotations, TArrayView<const float> weights);
+
+		/// <summary>
+		/// Sum of the positions each scaled by its weight, divided by the sum of the weights.
+		/// Zero if the weights sum to zero.
+		/// </summary>
+		static FVector AveragePositions(TArrayView<const FVector> positions, TArrayView<const float> weights);
+	};
+}
@@ -5,6 +5,7 @@
 
 #include "AlignmentManager.h"
 #include "FrozenWorldPoseExtensions.h"
+#include "WorldLockingToolsModule.h"
 
 #include "Async/Async.h"
 #include "Kismet/KismetSystemLibrary.h"
@@ -100,6 +101,70 @@ void USpacePin::SetLockedPose(FTransform lockedPose, float PositionTolerance, fl
 	SendAlignmentData();
 }
 
+void USpacePin::SetFrozenPoses(const TArray<USpacePin*>& SpacePins, const TArray<FTransform>& FrozenPoses, bool FlipTransformAroundY,
+	bool IgnoreYaw, bool IgnorePitch, bool IgnoreRoll, float PositionTolerance, float RotationTolerance)
+{
+	if (!CheckBatchSizes(SpacePins, FrozenPoses))
+	{
+		return;
+	}
+
+	// Frozen space only moves once the alignment is updated, so all the poses are taken from the same frozen space.
+	WorldLockingTools::FScopedAlignmentTransaction transaction(WorldLockingTools::FAlignmentManager::Get());
+	for (int i = 0; i < SpacePins.Num(); ++i)
+	{
+		if (SpacePins[i] != nullptr)
+		{
+			SpacePins[i]->SetFrozenPose(FrozenPoses[i], FlipTransformAroundY, IgnoreYaw, IgnorePitch, IgnoreRoll, PositionTolerance, RotationTolerance);
+		}
+	}
+}
+
+void USpacePin::SetSpongyPoses(const TArray<USpacePin*>& SpacePins, const TArray<FTransform>& SpongyPoses, bool FlipTransformAroundY,
+	bool IgnoreYaw, bool IgnorePitch, bool IgnoreRoll, float PositionTolerance, float RotationTolerance)
+{
+	if (!CheckBatchSizes(SpacePins, SpongyPoses))
+	{
+		return;
+	}
+
+	WorldLockingTools::FScopedAlignmentTransaction transaction(WorldLockingTools::FAlignmentManager::Get());
+	for (int i = 0; i < SpacePins.Num(); ++i)
+	{
+		if (SpacePins[i] != nullptr)
+		{
+			SpacePins[i]->SetSpongyPose(SpongyPoses[i], FlipTransformAroundY, IgnoreYaw, IgnorePitch, IgnoreRoll, PositionTolerance, RotationTolerance);
+		}
+	}
+}
+
+void USpacePin::SetLockedPoses(const TArray<USpacePin*>& SpacePins, const TArray<FTransform>& LockedPoses, float PositionTolerance, float RotationTolerance)
+{
+	if (!CheckBatchSizes(SpacePins, LockedPoses))
+	{
+		return;
+	}
+
+	WorldLockingTools::FScopedAlignmentTransaction transaction(WorldLockingTools::FAlignmentManager::Get());
+	for (int i = 0; i < SpacePins.Num(); ++i)
+	{
+		if (SpacePins[i] != nullptr)
+		{
+			SpacePins[i]->SetLockedPose(LockedPoses[i], PositionTolerance, RotationTolerance);
+		}
+	}
+}
+
+bool USpacePin::CheckBatchSizes(const TArray<USpacePin*>& SpacePins, const TArray<FTransform>& Poses)
+{
+	if (SpacePins.Num() != Poses.Num())
+	{
+		UE_LOG(LogWLT, Error, TEXT("Setting %d space pins from %d poses."), SpacePins.Num(), Poses.Num());
+		return false;
+	}
+	return true;
+}
+
 /// <summary>
 /// Communicate the data from this point to the alignment manager.
 /// </summary>
@@ -142,15 +207,15 @@ void USpacePin::CheckAttachment()
 /// </summary>
 void USpacePin::ForceAttachment()
 {
-	if (AttachmentPoint == nullptr)
+	if (!AttachmentPoint.IsValid())
 	{
 		LocationHandler.BindUObject(this, &USpacePin::OnLocationUpdate);
 
-		AttachmentPoint = WorldLockingTools::FFragmentManager::Get()->CreateAttachmentPoint(LockedPose.GetLocation(), nullptr, LocationHandler, nullptr);
+		AttachmentPoint = WorldLockingTools::FFragmentManager::Get()->CreateAttachmentPoint(LockedPose.GetLocation(), WorldLockingTools::FAttachmentPointHandle(), LocationHandler, nullptr);
 	}
 	else
 	{
-		WorldLockingTools::FFragmentManager::Get()->TeleportAttachmentPoint(AttachmentPoint, LockedPose.GetLocation(), nullptr);
+		WorldLockingTools::FFragmentManager::Get()->TeleportAttachmentPoint(AttachmentPoint, LockedPose.GetLocation(), WorldLockingTools::FAttachmentPointHandle());
 	}
 }
 
@@ -159,10 +224,10 @@ void USpacePin::ForceAttachment()
 /// </summary>
 void USpacePin::ReleaseAttachment()
 {
-	if (AttachmentPoint != nullptr)
+	if (AttachmentPoint.IsValid())
 	{
 		WorldLockingTools::FFragmentManager::Get()->ReleaseAttachmentPoint(AttachmentPoint);
-		AttachmentPoint = nullptr;
+		AttachmentPoint = WorldLockingTools::FAttachmentPointHandle();
 	}
 }
 
@@ -3,47 +3,1286 @@
 
 #include "Triangulator.h"
 
+#include "GeometricPredicates.h"
+
 namespace WorldLockingTools
 {
-	IndexedBary FTriangulator::FindTriangle(FVector pos)
+	/// The key of an edge, the same whichever way round its vertices are given.
+	static uint64 EdgeKey(int idx0, int idx1)
+	{
+		return ((uint64)FMath::Min(idx0, idx1) << 32) | (uint32)FMath::Max(idx0, idx1);
+	}
+
+	/// Spread the low 16 bits of a value out to the even bits, to interleave with another into a Morton code.
+	static uint32 SpreadBits(uint32 value)
+	{
+		value &= 0x0000FFFF;
+		value = (value | (value << 8)) & 0x00FF00FF;
+		value = (value | (value << 4)) & 0x0F0F0F0F;
+		value = (value | (value << 2)) & 0x33333333;
+		value = (value | (value << 1)) & 0x55555555;
+		return value;
+	}
+
+	IndexedBary FTriangulator::FindTriangle(FVector pos) const
 	{
 		IndexedBary bary;
 		bary.bary = Interpolant();
 		for (int i = 0; i < triangles.Num(); ++i)
 		{
-			Triangle tri = triangles[i];
-			FVector p0 = vertices[tri.idx0];
-			p0.Z = 0;
-			FVector p1 = vertices[tri.idx1];
-			p1.Z = 0;
-			FVector p2 = vertices[tri.idx2];
-			p2.Z = 0;
-			/// Note area will be negative, because this is xz, not xy, but that will cancel with the negative cross products below.
-			float area = FVector::CrossProduct(p2 - p1, p0 - p1).Z;
-			if (area >= 0)
+			if (ComputeBary(i, pos, bary.bary))
 			{
-				area = 0;
+				bary.triangle = i;
+				return bary;
 			}
-			check(area < 0); // Degenerate triangle in Find
+		}
+		check(false); // No triangle exists where this is an interior position.
+		return bary;
+	}
 
-			FVector ps(pos.X, pos.Y, 0.0f);
+	/// <summary>
+	/// Find the triangle a new vertex goes into.
+	///
+	/// The walk starts from whichever is nearest of the triangle the last vertex went into and a few spread over the triangulation,
+	/// so it stays short even when consecutive vertices are far apart. If the walk doesn't get there, all triangles are searched.
+	/// </summary>
+	IndexedBary FTriangulator::LocateForInsertion(FVector pos)
+	{
+		IndexedBary bary;
+		if (!WalkToTriangle(pos, ChooseWalkStart(pos), bary))
+		{
+			bary = FindTriangle(pos);
+		}
+		lastTriangle = bary.triangle;
+		return bary;
+	}
 
-			bary.bary.weights[0] = FVector::CrossProduct(p2 - p1, ps - p1).Z / area;
-			bary.bary.weights[1] = FVector::CrossProduct(p0 - p2, ps - p2).Z / area;
-			bary.bary.weights[2] = FVector::CrossProduct(p1 - p0, ps - p0).Z / area;
+	/// <summary>
+	/// Pick whichever is nearest of the last triangle found and a few spread over the triangulation, to walk to a position from.
+	/// </summary>
+	int FTriangulator::ChooseWalkStart(FVector pos)
+	{
+		int numTriangles = triangles.Num();
+		auto distanceSqr = [this, pos](int triIdx)
+		{
+			const Triangle& tri = triangles[triIdx];
+			FVector center = (vertices[tri.idx0] + vertices[tri.idx1] + vertices[tri.idx2]) / 3.0f;
+			return FVector::DistSquaredXY(center, pos);
+		};
 
-			if (bary.bary.IsInterior())
+		int start = lastTriangle >= 0 && lastTriangle < numTriangles ? lastTriangle : 0;
+		float startDistanceSqr = distanceSqr(start);
+		int numSamples = FMath::CeilToInt(FMath::Pow((float)numTriangles, 1.0f / 3.0f));
+		for (int i = 0; i < numSamples; ++i)
+		{
+			int sample = (int)((int64)i * numTriangles / numSamples);
+			float sampleDistanceSqr = distanceSqr(sample);
+			if (sampleDistanceSqr < startDistanceSqr)
 			{
-				bary.triangle = i;
-				bary.bary.idx[0] = tri.idx0;
-				bary.bary.idx[1] = tri.idx1;
-				bary.bary.idx[2] = tri.idx2;
+				start = sample;
+				startDistanceSqr = sampleDistanceSqr;
+			}
+		}
+		return start;
+	}
 
-				return bary;
+	/// <summary>
+	/// Find the triangle a new vertex goes into, with exact predicates, for the Delaunay mode.
+	///
+	/// The walk leaves each triangle across an edge the vertex is strictly outside of, which always gets there in a Delaunay
+	/// triangulation. Starting from a different edge at each step keeps it from circling otherwise, and failing that all
+	/// triangles are searched.
+	/// </summary>
+	/// <param name="outEdgeCorner">The corner opposite the edge the vertex is on, or -1 if it is strictly inside.</param>
+	/// <returns>False if the vertex is on a corner, so that it is a duplicate.</returns>
+	bool FTriangulator::LocateVertex(int vertIdx, int& outTriIdx, int& outEdgeCorner)
+	{
+		auto classify = [this, vertIdx, &outEdgeCorner](int triIdx, int firstEdge)
+		{
+			int numOnEdge = 0;
+			for (int k = 0; k < 3; ++k)
+			{
+				int i = (firstEdge + k) % 3;
+				int halfEdge = triIdx * 3 + i;
+				int side = WindingSign(HalfEdgeFrom(halfEdge), HalfEdgeTo(halfEdge), vertIdx);
+				if (side < 0)
+				{
+					return i;
+				}
+				if (side == 0)
+				{
+					++numOnEdge;
+					outEdgeCorner = i;
+				}
 			}
+			if (numOnEdge == 0)
+			{
+				outEdgeCorner = -1;
+			}
+			return numOnEdge > 1 ? 3 : -1;
+		};
 
+		int triIdx = ChooseWalkStart(vertices[vertIdx]);
+		for (int step = 0; step < triangles.Num(); ++step)
+		{
+			int exit = classify(triIdx, step);
+			if (exit < 0 || exit == 3)
+			{
+				outTriIdx = triIdx;
+				lastTriangle = triIdx;
+				return exit < 0;
+			}
+			int twin = twins[triIdx * 3 + exit];
+			if (twin < 0)
+			{
+				break;
+			}
+			triIdx = twin / 3;
 		}
-		check(false); // No triangle exists where this is an interior position.
-		return bary;
+
+		for (triIdx = 0; triIdx < triangles.Num(); ++triIdx)
+		{
+			int exit = classify(triIdx, 0);
+			if (exit < 0 || exit == 3)
+			{
+				outTriIdx = triIdx;
+				lastTriangle = triIdx;
+				return exit < 0;
+			}
+		}
+		check(false); // Should be contained by background seed vertices.
+		return false;
+	}
+
+	/// <summary>
+	/// The sign of Winding, computed exactly.
+	/// </summary>
+	int FTriangulator::WindingSign(int idx0, int idx1, int idx2) const
+	{
+		// Triangles here wind the opposite way to a positive Orient2D.
+		double orient = FGeometricPredicates::Orient2D(vertices[idx0], vertices[idx1], vertices[idx2]);
+		return orient < 0 ? 1 : (orient > 0 ? -1 : 0);
+	}
+
+	/// <summary>
+	/// Whether a vertex is strictly inside the circle through the corners of a correctly wound triangle.
+	/// </summary>
+	bool FTriangulator::InCircumcircle(int idx0, int idx1, int idx2, int idxTest) const
+	{
+		return FGeometricPredicates::InCircle(vertices[idx0], vertices[idx1], vertices[idx2], vertices[idxTest]) < 0;
+	}
+
+	/// <summary>
+	/// Insert vertices one at a time, flipping edges after each to keep the triangulation Delaunay.
+	///
+	/// Inserting them in Morton order, of their positions within their bounds, keeps consecutive vertices close together,
+	/// so each walk to a vertex is short. Vertices on top of one already inserted are left out of the triangles.
+	/// </summary>
+	void FTriangulator::AddDelaunay(const TArray<FVector>& inVertices)
+	{
+		if (inVertices.Num() == 0)
+		{
+			return;
+		}
+		FVector minPos = inVertices[0];
+		FVector maxPos = inVertices[0];
+		for (const FVector& pos : inVertices)
+		{
+			minPos = minPos.ComponentMin(pos);
+			maxPos = maxPos.ComponentMax(pos);
+		}
+		double scaleX = maxPos.X > minPos.X ? 65535.0 / (maxPos.X - minPos.X) : 0.0;
+		double scaleY = maxPos.Y > minPos.Y ? 65535.0 / (maxPos.Y - minPos.Y) : 0.0;
+
+		int firstIdx = vertices.Num();
+		vertices.Append(inVertices);
+
+		TArray<TPair<uint32, int>> order;
+		order.Reserve(inVertices.Num());
+		for (int i = 0; i < inVertices.Num(); ++i)
+		{
+			uint32 x = (uint32)((inVertices[i].X - minPos.X) * scaleX);
+			uint32 y = (uint32)((inVertices[i].Y - minPos.Y) * scaleY);
+			order.Add(TPair<uint32, int>(SpreadBits(x) | (SpreadBits(y) << 1), firstIdx + i));
+		}
+		order.Sort([](const TPair<uint32, int>& lhs, const TPair<uint32, int>& rhs)
+		{
+			return lhs.Key < rhs.Key || (lhs.Key == rhs.Key && lhs.Value < rhs.Value);
+		});
+
+		// The grid and the exterior edges are built from scratch once all are in.
+		listingTriangles = false;
+		for (const TPair<uint32, int>& entry : order)
+		{
+			AttachVertex(entry.Value);
+		}
+		listingTriangles = true;
+	}
+
+	/// <summary>
+	/// Add a vertex to the triangulation, changing only the triangles around it.
+	/// </summary>
+	/// <returns>The index of the vertex, as it appears in interpolants.</returns>
+	int FTriangulator::AddVertex(FVector pos)
+	{
+		// Must set bounds before adding vertices.
+		check(vertices.Num() >= 4);
+		triangleCacheValid = false;
+		int vertIdx = vertices.Add(pos);
+		AttachVertex(vertIdx);
+
+		// The grid is sized for the triangles there were when it was built, so build it again once they have doubled.
+		if (triangles.Num() > gridNumTriangles * 2 + 8)
+		{
+			int lastFound = lastTriangle;
+			BuildLocator();
+			lastTriangle = lastFound;
+		}
+		return vertIdx - 4;
+	}
+
+	/// <summary>
+	/// Remove a vertex from the triangulation, filling the hole from the vertices around it.
+	///
+	/// The last vertex takes the index of the removed one, as with TArray::RemoveAtSwap, so that arrays
+	/// indexed like the vertices stay in step by removing from them the same way.
+	/// A vertex left out for being exactly on the removed one is taken in in its place.
+	/// </summary>
+	void FTriangulator::RemoveVertex(int idx)
+	{
+		int vertIdx = idx + 4;
+		check(!IsBoundary(vertIdx) && vertIdx < vertices.Num());
+		triangleCacheValid = false;
+		FVector oldPos = vertices[vertIdx];
+		bool wasLeftOut = leftOut.Remove(vertIdx) > 0;
+		if (!wasLeftOut && !DetachVertex(vertIdx))
+		{
+			vertices.RemoveAtSwap(vertIdx);
+			Rebuild();
+			return;
+		}
+
+		int lastIdx = vertices.Num() - 1;
+		if (vertIdx != lastIdx)
+		{
+			RenameVertex(lastIdx, vertIdx);
+		}
+		vertices.RemoveAt(lastIdx);
+
+		if (!wasLeftOut)
+		{
+			AttachLeftOutAt(oldPos);
+		}
+	}
+
+	/// <summary>
+	/// Move a vertex, keeping its index.
+	///
+	/// If it stays inside the polygon formed by its neighbors, only the triangles around it change shape. Otherwise it is
+	/// taken out and added back at the new position. A vertex left out for being exactly on it at its old position is then taken in.
+	/// </summary>
+	void FTriangulator::MoveVertex(int idx, FVector pos)
+	{
+		int vertIdx = idx + 4;
+		check(!IsBoundary(vertIdx) && vertIdx < vertices.Num());
+		triangleCacheValid = false;
+
+		if (leftOut.Remove(vertIdx) > 0)
+		{
+			// A duplicate left out of the triangles gets its own place once moved.
+			vertices[vertIdx] = pos;
+			AttachVertex(vertIdx);
+			return;
+		}
+
+		TArray<int, TInlineAllocator<16>> star;
+		CollectStar(vertIdx, star);
+
+		FVector oldPos = vertices[vertIdx];
+		vertices[vertIdx] = pos;
+		bool staysInside = true;
+		for (int triIdx : star)
+		{
+			const Triangle& tri = triangles[triIdx];
+			staysInside &= WindingSign(tri.idx0, tri.idx1, tri.idx2) > 0;
+		}
+		vertices[vertIdx] = oldPos;
+
+		if (staysInside)
+		{
+			UnlistTriangles(star);
+			vertices[vertIdx] = pos;
+			ListTriangles(star);
+			FlipEdgesAround(star);
+		}
+		else
+		{
+			if (!DetachVertex(vertIdx))
+			{
+				vertices[vertIdx] = pos;
+				Rebuild();
+				return;
+			}
+			vertices[vertIdx] = pos;
+			AttachVertex(vertIdx);
+		}
+
+		if (pos.X != oldPos.X || pos.Y != oldPos.Y)
+		{
+			AttachLeftOutAt(oldPos);
+		}
+	}
+
+	/// <summary>
+	/// Split the triangle a vertex not yet in the triangulation lands in, or the two on the edge it lands nearest, to take it in.
+	///
+	/// In the Delaunay mode, the edge is only split if the vertex is exactly on it, and a vertex exactly on another is left out.
+	/// </summary>
+	void FTriangulator::AttachVertex(int vertIdx)
+	{
+		int triIdx;
+		Edge edge;
+		int oppositeTriIdx;
+		bool canSplit;
+		if (delaunay)
+		{
+			int edgeCorner;
+			if (!LocateVertex(vertIdx, triIdx, edgeCorner))
+			{
+				leftOut.Add(vertIdx);
+				return;
+			}
+			canSplit = edgeCorner >= 0;
+			int halfEdge = triIdx * 3 + FMath::Max(edgeCorner, 0);
+			edge = Edge{ HalfEdgeFrom(halfEdge), HalfEdgeTo(halfEdge) };
+			oppositeTriIdx = twins[halfEdge] >= 0 ? twins[halfEdge] / 3 : -1;
+			check(!canSplit || oppositeTriIdx >= 0); // Should be contained by background seed vertices.
+		}
+		else
+		{
+			IndexedBary bary = LocateForInsertion(vertices[vertIdx]);
+			check(bary.bary.IsInterior()); // Should be contained by background seed vertices.
+
+			triIdx = bary.triangle;
+			int edgeCorner = ClosestCorner(bary);
+			edge = ClosestEdge(bary);
+			int oppositeHalfEdge = twins[triIdx * 3 + edgeCorner];
+			oppositeTriIdx = oppositeHalfEdge >= 0 ? oppositeHalfEdge / 3 : -1;
+			canSplit = CanSplit(edge, oppositeTriIdx, vertIdx);
+		}
+
+		TArray<int, TInlineAllocator<16>> changed;
+		changed.Add(triIdx);
+		if (canSplit)
+		{
+			changed.Add(oppositeTriIdx);
+		}
+		UnlistTriangles(changed);
+
+		int firstNewTriIdx = triangles.Num();
+		if (canSplit)
+		{
+			AddVertexSplitEdge(edge, triIdx, oppositeTriIdx, vertIdx);
+		}
+		else
+		{
+			AddVertexMidTriangle(triIdx, vertIdx);
+		}
+		for (int newTriIdx = firstNewTriIdx; newTriIdx < triangles.Num(); ++newTriIdx)
+		{
+			changed.Add(newTriIdx);
+		}
+
+		ListTriangles(changed);
+		FlipEdgesAround(changed);
+	}
+
+	/// <summary>
+	/// Take a vertex out of the triangulation, leaving it unused in the vertex list.
+	///
+	/// The polygon of its neighbors is filled by repeatedly cutting off the corner that makes the shortest new edge
+	/// without covering any other corner, reusing the triangles that were around the vertex.
+	/// </summary>
+	/// <returns>False, with nothing changed, if the polygon couldn't be filled.</returns>
+	bool FTriangulator::DetachVertex(int vertIdx)
+	{
+		TArray<int, TInlineAllocator<16>> star;
+		CollectStar(vertIdx, star);
+		if (star.Num() == 0)
+		{
+			return true;
+		}
+
+		// The vertices around it, in the same order as the triangles.
+		TArray<int, TInlineAllocator<16>> polygon;
+		for (int triIdx : star)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				if (Corner(triIdx, i) == vertIdx)
+				{
+					polygon.Add(Corner(triIdx, (i + 1) % 3));
+				}
+			}
+		}
+
+		TArray<Triangle, TInlineAllocator<16>> fill;
+		while (polygon.Num() > 3)
+		{
+			int bestCorner = -1;
+			float bestLengthSq = std::numeric_limits<float>::max();
+			for (int i = 0; i < polygon.Num(); ++i)
+			{
+				int prev = polygon[(i + polygon.Num() - 1) % polygon.Num()];
+				int next = polygon[(i + 1) % polygon.Num()];
+				float lengthSq = (vertices[next] - vertices[prev]).SizeSquared();
+				if (lengthSq >= bestLengthSq || WindingSign(prev, polygon[i], next) <= 0)
+				{
+					continue;
+				}
+
+				bool coversOther = false;
+				for (int other : polygon)
+				{
+					if (other != prev && other != polygon[i] && other != next
+						&& WindingSign(prev, polygon[i], other) >= 0
+						&& WindingSign(polygon[i], next, other) >= 0
+						&& WindingSign(next, prev, other) >= 0)
+					{
+						coversOther = true;
+						break;
+					}
+				}
+				if (!coversOther)
+				{
+					bestCorner = i;
+					bestLengthSq = lengthSq;
+				}
+			}
+			if (bestCorner < 0)
+			{
+				return false;
+			}
+
+			fill.Add(Triangle
+				{
+					polygon[(bestCorner + polygon.Num() - 1) % polygon.Num()],
+					polygon[bestCorner],
+					polygon[(bestCorner + 1) % polygon.Num()]
+				});
+			polygon.RemoveAt(bestCorner);
+		}
+		if (WindingSign(polygon[0], polygon[1], polygon[2]) <= 0)
+		{
+			return false;
+		}
+		fill.Add(Triangle{ polygon[0], polygon[1], polygon[2] });
+
+		// Reuse the lowest triangles, so that removing the two left over doesn't move any of the reused ones.
+		star.Sort();
+		UnlistTriangles(star);
+		TArray<HalfEdgeLink, TInlineAllocator<4>> outerLinks;
+		CollectOuterLinks(star, outerLinks);
+
+		int numFill = fill.Num();
+		for (int i = 0; i < numFill; ++i)
+		{
+			triangles[star[i]] = fill[i];
+		}
+		TArrayView<const int> filled = MakeArrayView(star.GetData(), numFill);
+		RelinkTriangles(filled, outerLinks);
+		ListTriangles(filled);
+
+		RemoveTriangle(star[numFill + 1]);
+		RemoveTriangle(star[numFill]);
+		FlipEdgesAround(filled);
+		return true;
+	}
+
+	/// <summary>
+	/// Take in a vertex left out for being exactly on another, once no vertex in the triangulation is at its position any more.
+	/// </summary>
+	void FTriangulator::AttachLeftOutAt(FVector pos)
+	{
+		for (int i = 0; i < leftOut.Num(); ++i)
+		{
+			int vertIdx = leftOut[i];
+			if (vertices[vertIdx].X == pos.X && vertices[vertIdx].Y == pos.Y)
+			{
+				leftOut.RemoveAtSwap(i);
+				AttachVertex(vertIdx);
+				return;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Give a vertex a new index, leaving its old index unused.
+	/// </summary>
+	void FTriangulator::RenameVertex(int fromIdx, int toIdx)
+	{
+		TArray<int, TInlineAllocator<16>> star;
+		CollectStar(fromIdx, star);
+
+		vertices[toIdx] = vertices[fromIdx];
+		for (int triIdx : star)
+		{
+			Triangle& tri = triangles[triIdx];
+			tri.idx0 = tri.idx0 == fromIdx ? toIdx : tri.idx0;
+			tri.idx1 = tri.idx1 == fromIdx ? toIdx : tri.idx1;
+			tri.idx2 = tri.idx2 == fromIdx ? toIdx : tri.idx2;
+		}
+		if (star.Num() > 0)
+		{
+			NoteCorners(star[0]);
+		}
+		int leftOutIndex = leftOut.Find(fromIdx);
+		if (leftOutIndex != INDEX_NONE)
+		{
+			leftOut[leftOutIndex] = toIdx;
+		}
+		for (Edge& edge : exteriorEdges)
+		{
+			edge.idx0 = edge.idx0 == fromIdx ? toIdx : edge.idx0;
+			edge.idx1 = edge.idx1 == fromIdx ? toIdx : edge.idx1;
+			if (edge.idx0 > edge.idx1)
+			{
+				Swap(edge.idx0, edge.idx1);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Find a triangle with the vertex as a corner, the one noted for it if still so, or else walking towards it from the last triangle found.
+	/// </summary>
+	/// <returns>The triangle, or -1 if the vertex was left out as a duplicate.</returns>
+	int FTriangulator::FindTriangleWithVertex(int vertIdx)
+	{
+		if (leftOut.Contains(vertIdx))
+		{
+			return -1;
+		}
+		if (vertIdx < vertexTriangles.Num())
+		{
+			int noted = vertexTriangles[vertIdx];
+			if (noted >= 0 && noted < triangles.Num()
+				&& (Corner(noted, 0) == vertIdx || Corner(noted, 1) == vertIdx || Corner(noted, 2) == vertIdx))
+			{
+				return noted;
+			}
+		}
+
+		int maxSteps = 16 + 4 * FMath::CeilToInt(FMath::Sqrt((float)triangles.Num()));
+		int tri = lastTriangle >= 0 && lastTriangle < triangles.Num() ? lastTriangle : 0;
+		for (int step = 0; step < maxSteps; ++step)
+		{
+			if (Corner(tri, 0) == vertIdx || Corner(tri, 1) == vertIdx || Corner(tri, 2) == vertIdx)
+			{
+				return tri;
+			}
+
+			Interpolant bary;
+			ComputeBary(tri, vertices[vertIdx], bary);
+			int exit = 0;
+			for (int i = 1; i < 3; ++i)
+			{
+				if (bary.weights[i] < bary.weights[exit])
+				{
+					exit = i;
+				}
+			}
+			int twin = twins[tri * 3 + exit];
+			if (bary.weights[exit] >= 0 || twin < 0)
+			{
+				break;
+			}
+			tri = twin / 3;
+		}
+
+		for (int i = 0; i < triangles.Num(); ++i)
+		{
+			if (Corner(i, 0) == vertIdx || Corner(i, 1) == vertIdx || Corner(i, 2) == vertIdx)
+			{
+				return i;
+			}
+		}
+		checkNoEntry(); // Only duplicates in the Delaunay mode are left out of the triangulation.
+		return -1;
+	}
+
+	/// <summary>
+	/// List the triangles around a vertex, in order around it, or none if it was left out as a duplicate.
+	/// </summary>
+	void FTriangulator::CollectStar(int vertIdx, TArray<int, TInlineAllocator<16>>& outTris)
+	{
+		int start = FindTriangleWithVertex(vertIdx);
+		if (start < 0)
+		{
+			return;
+		}
+		int triIdx = start;
+		do
+		{
+			outTris.Add(triIdx);
+			int corner = Corner(triIdx, 0) == vertIdx ? 0 : (Corner(triIdx, 1) == vertIdx ? 1 : 2);
+			// The half-edge coming into the vertex, whose twin leaves it in the next triangle around.
+			int twin = twins[triIdx * 3 + (corner + 1) % 3];
+			check(twin >= 0); // Only vertices on the bounds are on open edges.
+			triIdx = twin / 3;
+		} while (triIdx != start && outTris.Num() <= triangles.Num());
+		lastTriangle = start;
+	}
+
+	/// <summary>
+	/// Remove a triangle which nothing links to any more, moving the last triangle into its place.
+	/// </summary>
+	void FTriangulator::RemoveTriangle(int triIdx)
+	{
+		int lastIdx = triangles.Num() - 1;
+		if (triIdx != lastIdx)
+		{
+			UnlistTriangles(MakeArrayView(&lastIdx, 1));
+			triangles[triIdx] = triangles[lastIdx];
+			for (int i = 0; i < 3; ++i)
+			{
+				int twin = twins[lastIdx * 3 + i];
+				twins[triIdx * 3 + i] = twin;
+				if (twin >= 0)
+				{
+					twins[twin] = triIdx * 3 + i;
+				}
+			}
+			ListTriangles(MakeArrayView(&triIdx, 1));
+			NoteCorners(triIdx);
+			if (lastTriangle == lastIdx)
+			{
+				lastTriangle = triIdx;
+			}
+		}
+		triangles.RemoveAt(lastIdx);
+		twins.RemoveAt(lastIdx * 3, 3);
+	}
+
+	/// <summary>
+	/// Triangulate the current vertices from scratch, within the same bounds.
+	/// </summary>
+	void FTriangulator::Rebuild()
+	{
+		TArray<FVector> realVertices;
+		for (int i = 4; i < vertices.Num(); ++i)
+		{
+			realVertices.Add(vertices[i]);
+		}
+		FVector minPos = vertices[1];
+		FVector maxPos = vertices[3];
+
+		Clear();
+		SetBounds(minPos, maxPos);
+		if (realVertices.Num() > 0)
+		{
+			Add(realVertices);
+		}
+	}
+
+	/// <summary>
+	/// Pair up the half-edges of all triangles from scratch, noting a triangle for each vertex.
+	/// </summary>
+	void FTriangulator::LinkAllTriangles()
+	{
+		int numTriangles = triangles.Num();
+		twins.Init(-1, numTriangles * 3);
+
+		for (int triIdx = 0; triIdx < numTriangles; ++triIdx)
+		{
+			NoteCorners(triIdx);
+		}
+
+		TMap<uint64, int> openEdges;
+		openEdges.Reserve(numTriangles * 2);
+		for (int halfEdge = 0; halfEdge < numTriangles * 3; ++halfEdge)
+		{
+			uint64 key = EdgeKey(HalfEdgeFrom(halfEdge), HalfEdgeTo(halfEdge));
+			int twin;
+			if (openEdges.RemoveAndCopyValue(key, twin))
+			{
+				twins[halfEdge] = twin;
+				twins[twin] = halfEdge;
+			}
+			else
+			{
+				openEdges.Add(key, halfEdge);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Before rewriting a few triangles, note each of their half-edges whose twin is outside of them, or on the bounds.
+	///
+	/// Rewriting triangles in place or adding new ones leaves the half-edges of all other triangles where they were,
+	/// so RelinkTriangles can reattach them afterwards by their vertices, without searching the triangulation.
+	/// </summary>
+	void FTriangulator::CollectOuterLinks(TArrayView<const int> tris, TArray<HalfEdgeLink, TInlineAllocator<4>>& outLinks) const
+	{
+		for (int triIdx : tris)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				int halfEdge = triIdx * 3 + i;
+				int twin = twins[halfEdge];
+				if (twin < 0 || !tris.Contains(twin / 3))
+				{
+					outLinks.Add(HalfEdgeLink{ HalfEdgeFrom(halfEdge), HalfEdgeTo(halfEdge), twin });
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// After rewriting a few triangles, link up their half-edges, with the outer ones noted by CollectOuterLinks and with each other,
+	/// and note them as the triangles of their corners.
+	/// </summary>
+	void FTriangulator::RelinkTriangles(TArrayView<const int> tris, TArrayView<const HalfEdgeLink> outerLinks)
+	{
+		for (int triIdx : tris)
+		{
+			NoteCorners(triIdx);
+			for (int i = 0; i < 3; ++i)
+			{
+				int halfEdge = triIdx * 3 + i;
+				int from = HalfEdgeFrom(halfEdge);
+				int to = HalfEdgeTo(halfEdge);
+				twins[halfEdge] = -1;
+
+				bool isOuter = false;
+				for (const HalfEdgeLink& link : outerLinks)
+				{
+					if (link.from == from && link.to == to)
+					{
+						twins[halfEdge] = link.twin;
+						if (link.twin >= 0)
+						{
+							twins[link.twin] = halfEdge;
+						}
+						isOuter = true;
+						break;
+					}
+				}
+				if (isOuter)
+				{
+					continue;
+				}
+
+				for (int otherIdx : tris)
+				{
+					for (int j = 0; j < 3; ++j)
+					{
+						int other = otherIdx * 3 + j;
+						if (HalfEdgeFrom(other) == to && HalfEdgeTo(other) == from)
+						{
+							twins[halfEdge] = other;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Flip the shared edges, longest first, where the other diagonal of the two triangles on it is shorter.
+	///
+	/// The triangles on each edge are found through a map from edge to half-edge, kept up to date as edges are flipped.
+	/// </summary>
+	void FTriangulator::FlipLongEdges()
+	{
+		/// Make a list of all unique edges (no duplicates).
+		TArray<Edge> edges = ListSharedEdges();
+
+		TMap<uint64, int> edgeHalfEdges;
+		edgeHalfEdges.Reserve(triangles.Num() * 2);
+		for (int halfEdge = 0; halfEdge < triangles.Num() * 3; ++halfEdge)
+		{
+			edgeHalfEdges.Add(EdgeKey(HalfEdgeFrom(halfEdge), HalfEdgeTo(halfEdge)), halfEdge);
+		}
+
+		/// For each edge in the list
+		for (int iEdge = 0; iEdge < edges.Num(); ++iEdge)
+		{
+			Edge edge = edges[iEdge];
+			/// Find the two triangles sharing it.
+			uint64 edgeKey = EdgeKey(edge.idx0, edge.idx1);
+			const int* halfEdge = edgeHalfEdges.Find(edgeKey);
+			check(halfEdge != nullptr); // Can't find a triangle with a known edge
+			int twin = twins[*halfEdge];
+
+			/// If there are two triangles
+			if (twin >= 0)
+			{
+				int pair[2] = { FMath::Min(*halfEdge / 3, twin / 3), FMath::Max(*halfEdge / 3, twin / 3) };
+				if (FlipIfImproves(edge, pair[0], pair[1]))
+				{
+					edgeHalfEdges.Remove(edgeKey);
+				}
+
+				/// Shifting moves the half-edges around even when the edge isn't flipped.
+				for (int triIdx : pair)
+				{
+					for (int i = 0; i < 3; ++i)
+					{
+						int pairHalfEdge = triIdx * 3 + i;
+						edgeHalfEdges.Add(EdgeKey(HalfEdgeFrom(pairHalfEdge), HalfEdgeTo(pairHalfEdge)), pairHalfEdge);
+					}
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Flip the edge between two triangles if the other diagonal of the quad they form is shorter, and inside it.
+	/// In the Delaunay mode, flip it instead if the far corner of one triangle is inside the circumcircle of the other.
+	/// </summary>
+	/// <returns>True if flipped.</returns>
+	bool FTriangulator::FlipIfImproves(Edge edge, int tri0, int tri1)
+	{
+		int pair[2] = { tri0, tri1 };
+		TArray<HalfEdgeLink, TInlineAllocator<4>> outerLinks;
+		CollectOuterLinks(MakeArrayView(pair), outerLinks);
+
+		/// Shift the indices to form (i,j,k),(k,j,l) where (j,k) is the edge.
+		ShiftTriangles(edge, tri0, tri1);
+
+		bool flipped = false;
+		Triangle t0 = triangles[tri0];
+		Triangle t1 = triangles[tri1];
+		bool flip = false;
+		if (delaunay)
+		{
+			/// The quad is convex whenever l is inside the circumcircle of (i,j,k), so the flip is always valid.
+			flip = InCircumcircle(t0.idx0, t0.idx1, t0.idx2, t1.idx2);
+		}
+		else if (!IsInsideTriangle(t0.idx0, t0.idx1, t1.idx2, t0.idx2)
+			&& !IsInsideTriangle(t0.idx0, t1.idx2, t0.idx2, t0.idx1))
+		{
+			float edgeLengthSq = (vertices[edge.idx0] - vertices[edge.idx1]).SizeSquared();
+			/// Find distance between vertices that aren't on the edge,
+			/// which is vert[0] from tri0 and vert[2] from tri1.
+			float crossLengthSq = (vertices[triangles[tri0].idx0] - vertices[triangles[tri1].idx2]).SizeSquared();
+
+			/// If that distance is shorter than edge length
+			flip = crossLengthSq < edgeLengthSq;
+		}
+
+		if (flip)
+		{
+			/// change tri0 to (k,i,l) and tri1 to (l,i,j)
+			t0 = Triangle
+			{
+				triangles[tri0].idx2,
+				triangles[tri0].idx0,
+				triangles[tri1].idx2
+			};
+			t1 = Triangle
+			{
+				triangles[tri1].idx2,
+				triangles[tri0].idx0,
+				triangles[tri0].idx1
+			};
+			triangles[tri0] = t0;
+			triangles[tri1] = t1;
+			flipped = true;
+		}
+
+		RelinkTriangles(MakeArrayView(pair), outerLinks);
+		return flipped;
+	}
+
+	/// <summary>
+	/// Flip edges of a few changed triangles, and then of the triangles next to each flipped edge, until none is left to flip.
+	///
+	/// Every flip shortens an edge, or in the Delaunay mode removes a vertex from a circumcircle, so this ends,
+	/// and it only reaches as far from the changed triangles as flips keep happening.
+	/// </summary>
+	void FTriangulator::FlipEdgesAround(TArrayView<const int> tris)
+	{
+		struct PendingEdge
+		{
+			Edge edge;
+			int triangle;
+		};
+		TArray<PendingEdge, TInlineAllocator<32>> pending;
+		auto addEdges = [this, &pending](int triIdx)
+		{
+			const Triangle& tri = triangles[triIdx];
+			pending.Add(PendingEdge{ Edge{ tri.idx0, tri.idx1 }, triIdx });
+			pending.Add(PendingEdge{ Edge{ tri.idx1, tri.idx2 }, triIdx });
+			pending.Add(PendingEdge{ Edge{ tri.idx2, tri.idx0 }, triIdx });
+		};
+		for (int triIdx : tris)
+		{
+			addEdges(triIdx);
+		}
+
+		while (pending.Num() > 0)
+		{
+			PendingEdge next = pending.Pop(false);
+
+			// Edges flipped away since they were added are no longer in their triangle.
+			int halfEdge = -1;
+			for (int i = 0; i < 3; ++i)
+			{
+				int candidate = next.triangle * 3 + i;
+				if (EdgesEqual(next.edge, HalfEdgeFrom(candidate), HalfEdgeTo(candidate)))
+				{
+					halfEdge = candidate;
+				}
+			}
+			if (halfEdge < 0 || twins[halfEdge] < 0)
+			{
+				continue;
+			}
+
+			int pair[2] = { FMath::Min(next.triangle, twins[halfEdge] / 3), FMath::Max(next.triangle, twins[halfEdge] / 3) };
+			UnlistTriangles(MakeArrayView(pair));
+			bool flipped = FlipIfImproves(next.edge, pair[0], pair[1]);
+			ListTriangles(MakeArrayView(pair));
+			if (flipped)
+			{
+				addEdges(pair[0]);
+				addEdges(pair[1]);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Compute the barycentric coordinates of a position in a triangle, projected onto the horizontal plane.
+	/// </summary>
+	/// <returns>True if the position is inside the triangle.</returns>
+	bool FTriangulator::ComputeBary(int triIdx, FVector pos, Interpolant& outBary) const
+	{
+		Triangle tri = triangles[triIdx];
+		outBary.idx[0] = tri.idx0;
+		outBary.idx[1] = tri.idx1;
+		outBary.idx[2] = tri.idx2;
+		if (triangleCacheValid)
+		{
+			const double* x = &triangleCache.cornerX[triIdx * 3];
+			const double* y = &triangleCache.cornerY[triIdx * 3];
+			float inverseArea = triangleCache.inverseArea[triIdx];
+			if (inverseArea == 0.0f)
+			{
+				outBary.weights[0] = outBary.weights[1] = outBary.weights[2] = 0.0f;
+				return false;
+			}
+			outBary.weights[0] = ((x[2] - x[1]) * (pos.Y - y[1]) - (y[2] - y[1]) * (pos.X - x[1])) * inverseArea;
+			outBary.weights[1] = ((x[0] - x[2]) * (pos.Y - y[2]) - (y[0] - y[2]) * (pos.X - x[2])) * inverseArea;
+			outBary.weights[2] = ((x[1] - x[0]) * (pos.Y - y[0]) - (y[1] - y[0]) * (pos.X - x[0])) * inverseArea;
+			return outBary.IsInterior();
+		}
+
+		FVector p0 = vertices[tri.idx0];
+		p0.Z = 0;
+		FVector p1 = vertices[tri.idx1];
+		p1.Z = 0;
+		FVector p2 = vertices[tri.idx2];
+		p2.Z = 0;
+		/// Note area will be negative, because this is xz, not xy, but that will cancel with the negative cross products below.
+		float area = FVector::CrossProduct(p2 - p1, p0 - p1).Z;
+		if (area >= 0)
+		{
+			area = 0;
+		}
+		check(area < 0); // Degenerate triangle in Find
+
+		FVector ps(pos.X, pos.Y, 0.0f);
+
+		outBary.weights[0] = FVector::CrossProduct(p2 - p1, ps - p1).Z / area;
+		outBary.weights[1] = FVector::CrossProduct(p0 - p2, ps - p2).Z / area;
+		outBary.weights[2] = FVector::CrossProduct(p1 - p0, ps - p0).Z / area;
+
+		return outBary.IsInterior();
+	}
+
+	/// <summary>
+	/// Gather the corners and area of every triangle for ComputeBary, until the triangulation next changes.
+	/// </summary>
+	void FTriangulator::BuildTriangleCache()
+	{
+		int numTriangles = triangles.Num();
+		triangleCache.cornerX.SetNumUninitialized(numTriangles * 3);
+		triangleCache.cornerY.SetNumUninitialized(numTriangles * 3);
+		triangleCache.inverseArea.SetNumUninitialized(numTriangles);
+		for (int triIdx = 0; triIdx < numTriangles; ++triIdx)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				const FVector& corner = vertices[Corner(triIdx, i)];
+				triangleCache.cornerX[triIdx * 3 + i] = corner.X;
+				triangleCache.cornerY[triIdx * 3 + i] = corner.Y;
+			}
+			// The exact predicates can keep slivers whose area rounds to nothing or the wrong sign. No position is found in those,
+			// the triangles around them cover the same positions.
+			const double* x = &triangleCache.cornerX[triIdx * 3];
+			const double* y = &triangleCache.cornerY[triIdx * 3];
+			double area = (x[2] - x[1]) * (y[0] - y[1]) - (y[2] - y[1]) * (x[0] - x[1]);
+			float inverseArea = (float)(1.0 / area);
+			triangleCache.inverseArea[triIdx] = area < 0 && FMath::IsFinite(inverseArea) ? inverseArea : 0.0f;
+		}
+		triangleCacheValid = true;
+	}
+
+	void FTriangulator::ClearLocator()
+	{
+		triangleGrid.Empty();
+		gridSizeX = 0;
+		gridSizeY = 0;
+		gridNumTriangles = 0;
+		lastTriangle = -1;
+	}
+
+	/// <summary>
+	/// Build the grid of interior triangles used to locate positions.
+	/// </summary>
+	void FTriangulator::BuildLocator()
+	{
+		ClearLocator();
+
+		int numTriangles = triangles.Num();
+		// Only interior triangles go into the grid, so it need only cover the real vertices, not the bounds.
+		if (vertices.Num() <= 4)
+		{
+			return;
+		}
+		FVector minPos = vertices[4];
+		FVector maxPos = vertices[4];
+		for (int i = 5; i < vertices.Num(); ++i)
+		{
+			minPos = minPos.ComponentMin(vertices[i]);
+			maxPos = maxPos.ComponentMax(vertices[i]);
+		}
+
+		TArray<int> interiorTriangles;
+		for (int t = 0; t < numTriangles; ++t)
+		{
+			if (!IsBoundary(triangles[t].idx0) && !IsBoundary(triangles[t].idx1) && !IsBoundary(triangles[t].idx2))
+			{
+				interiorTriangles.Add(t);
+			}
+		}
+		if (interiorTriangles.Num() == 0)
+		{
+			return;
+		}
+
+		// Size the cells for about one triangle per cell.
+		float width = maxPos.X - minPos.X;
+		float height = maxPos.Y - minPos.Y;
+		int numInterior = interiorTriangles.Num();
+		gridCellSize = FMath::Max3(FMath::Sqrt(width * height / numInterior), FMath::Max(width, height) / numInterior, 1.0f);
+		gridOrigin = minPos;
+		gridSizeX = FMath::FloorToInt(width / gridCellSize) + 1;
+		gridSizeY = FMath::FloorToInt(height / gridCellSize) + 1;
+		triangleGrid.SetNum(gridSizeX * gridSizeY);
+		gridNumTriangles = numTriangles;
+
+		for (int t : interiorTriangles)
+		{
+			int x0, x1, y0, y1;
+			GridCellRange(t, x0, x1, y0, y1);
+			for (int y = y0; y <= y1; ++y)
+			{
+				for (int x = x0; x <= x1; ++x)
+				{
+					triangleGrid[y * gridSizeX + x].Add(t);
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Find the range of grid cells an interior triangle overlaps, clamped to the grid.
+	/// </summary>
+	/// <returns>False if there is no grid, or the triangle isn't interior and so doesn't go in it.</returns>
+	bool FTriangulator::GridCellRange(int triIdx, int& outX0, int& outX1, int& outY0, int& outY1)
+	{
+		const Triangle& tri = triangles[triIdx];
+		if (triangleGrid.Num() == 0 || IsBoundary(tri.idx0) || IsBoundary(tri.idx1) || IsBoundary(tri.idx2))
+		{
+			return false;
+		}
+
+		FVector triMin = vertices[tri.idx0].ComponentMin(vertices[tri.idx1]).ComponentMin(vertices[tri.idx2]);
+		FVector triMax = vertices[tri.idx0].ComponentMax(vertices[tri.idx1]).ComponentMax(vertices[tri.idx2]);
+		outX0 = FMath::Clamp(FMath::FloorToInt((triMin.X - gridOrigin.X) / gridCellSize), 0, gridSizeX - 1);
+		outX1 = FMath::Clamp(FMath::FloorToInt((triMax.X - gridOrigin.X) / gridCellSize), 0, gridSizeX - 1);
+		outY0 = FMath::Clamp(FMath::FloorToInt((triMin.Y - gridOrigin.Y) / gridCellSize), 0, gridSizeY - 1);
+		outY1 = FMath::Clamp(FMath::FloorToInt((triMax.Y - gridOrigin.Y) / gridCellSize), 0, gridSizeY - 1);
+		return true;
+	}
+
+	/// <summary>
+	/// Take triangles about to change out of the grid and the exterior edges. ListTriangles puts them back once changed.
+	/// </summary>
+	void FTriangulator::UnlistTriangles(TArrayView<const int> tris)
+	{
+		if (!listingTriangles)
+		{
+			return;
+		}
+		for (int triIdx : tris)
+		{
+			int x0, x1, y0, y1;
+			if (GridCellRange(triIdx, x0, x1, y0, y1))
+			{
+				for (int y = y0; y <= y1; ++y)
+				{
+					for (int x = x0; x <= x1; ++x)
+					{
+						triangleGrid[y * gridSizeX + x].RemoveSingleSwap(triIdx, false);
+					}
+				}
+			}
+
+			int outVertIdx = HasExteriorEdge(triangles[triIdx]);
+			if (outVertIdx >= 0)
+			{
+				// Keep the edge if the triangle across, which isn't changing, has it as its exterior edge too.
+				int twin = twins[triIdx * 3 + outVertIdx];
+				if (twin >= 0 && !tris.Contains(twin / 3) && HasExteriorEdge(triangles[twin / 3]) == twin % 3)
+				{
+					continue;
+				}
+				Edge edge = ExtractEdge(triangles[triIdx], outVertIdx);
+				exteriorEdges.RemoveAllSwap([edge](const Edge& other)
+				{
+					return other.idx0 == edge.idx0 && other.idx1 == edge.idx1;
+				}, false);
+			}
+		}
+	}
+
+	void FTriangulator::ListTriangles(TArrayView<const int> tris)
+	{
+		if (!listingTriangles)
+		{
+			return;
+		}
+		for (int triIdx : tris)
+		{
+			int x0, x1, y0, y1;
+			if (GridCellRange(triIdx, x0, x1, y0, y1))
+			{
+				for (int y = y0; y <= y1; ++y)
+				{
+					for (int x = x0; x <= x1; ++x)
+					{
+						triangleGrid[y * gridSizeX + x].Add(triIdx);
+					}
+				}
+			}
+
+			int outVertIdx = HasExteriorEdge(triangles[triIdx]);
+			if (outVertIdx >= 0)
+			{
+				Edge edge = ExtractEdge(triangles[triIdx], outVertIdx);
+				if (!exteriorEdges.ContainsByPredicate([edge](const Edge& other)
+				{
+					return other.idx0 == edge.idx0 && other.idx1 == edge.idx1;
+				}))
+				{
+					exteriorEdges.Add(edge);
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Find the triangle containing a position inside the bounds.
+	///
+	/// Successive positions are expected to be close together, so the search walks from the hint, the last triangle found.
+	/// If the walk doesn't get there, the grid of interior triangles is tried, and only then all triangles.
+	/// </summary>
+	/// <returns>True if a containing triangle was found.</returns>
+	bool FTriangulator::LocateTriangle(FVector pos, int& inOutHint, IndexedBary& outBary) const
+	{
+		if (WalkToTriangle(pos, inOutHint, outBary) || LookUpInteriorTriangle(pos, outBary))
+		{
+			inOutHint = outBary.triangle;
+			return true;
+		}
+
+		// The position is in a triangle touching the bounds, far from the last one. Start from there next time.
+		outBary = FindTriangle(pos);
+		inOutHint = outBary.triangle;
+		return true;
+	}
+
+	/// <summary>
+	/// Walk from a triangle towards the position, each step crossing the edge the position is furthest outside of.
+	///
+	/// The number of steps is limited, since such a walk isn't guaranteed to terminate on a triangulation that isn't Delaunay.
+	/// </summary>
+	/// <returns>True if the walk arrived at a triangle containing the position.</returns>
+	bool FTriangulator::WalkToTriangle(FVector pos, int startTriangle, IndexedBary& outBary) const
+	{
+		if (startTriangle < 0 || startTriangle >= triangles.Num())
+		{
+			return false;
+		}
+
+		int maxSteps = 16 + 4 * FMath::CeilToInt(FMath::Sqrt((float)triangles.Num()));
+		int tri = startTriangle;
+		for (int step = 0; step < maxSteps; ++step)
+		{
+			if (ComputeBary(tri, pos, outBary.bary))
+			{
+				outBary.triangle = tri;
+				return true;
+			}
+
+			int exit = 0;
+			for (int i = 1; i < 3; ++i)
+			{
+				if (outBary.bary.weights[i] < outBary.bary.weights[exit])
+				{
+					exit = i;
+				}
+			}
+
+			int twin = twins[tri * 3 + exit];
+			if (twin < 0)
+			{
+				return false;
+			}
+			tri = twin / 3;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Find the interior triangle containing a position, among those overlapping its grid cell.
+	/// </summary>
+	/// <returns>True if found, false if the position isn't in any interior triangle.</returns>
+	bool FTriangulator::LookUpInteriorTriangle(FVector pos, IndexedBary& outBary) const
+	{
+		if (triangleGrid.Num() == 0)
+		{
+			return false;
+		}
+
+		int x = FMath::FloorToInt((pos.X - gridOrigin.X) / gridCellSize);
+		int y = FMath::FloorToInt((pos.Y - gridOrigin.Y) / gridCellSize);
+		if (x < 0 || x >= gridSizeX || y < 0 || y >= gridSizeY)
+		{
+			return false;
+		}
+
+		for (int t : triangleGrid[y * gridSizeX + x])
+		{
+			if (ComputeBary(t, pos, outBary.bary))
+			{
+				outBary.triangle = t;
+				return true;
+			}
+		}
+		return false;
 	}
-}
\ No newline at end of file
+}
@@ -40,12 +40,32 @@ namespace WorldLockingTools
 		Interpolant bary;
 	};
 
+	/// A half-edge outside of a set of triangles being rewritten, to be reattached once they are.
+	struct HalfEdgeLink
+	{
+		int from;
+		int to;
+		int twin;
+	};
+
 	struct PointOnEdge
 	{
 		float parm;
 		float distanceSqr;
 	};
 
+	/// <summary>
+	/// Barycentric setup of each triangle, laid out by field so that locating a position reads it without going through the vertices.
+	/// </summary>
+	struct TriangleCache
+	{
+		/// Horizontal positions of the corners, three per triangle in the order of its vertices.
+		TArray<double> cornerX;
+		TArray<double> cornerY;
+		/// One over the (negative) signed area of each triangle, as computed by ComputeBary, or zero for a sliver with no usable area.
+		TArray<float> inverseArea;
+	};
+
 	class FTriangulator
 	{
 	private:
@@ -53,12 +73,48 @@ namespace WorldLockingTools
 		TArray<Triangle> triangles;
 		TArray<Edge> exteriorEdges;
 
+		/// Whether to keep the triangulation Delaunay, with exact predicates, rather than flipping long edges.
+		bool delaunay = false;
+		/// Whether changes to triangles are reflected in the grid and the exterior edges as they are made.
+		/// Off while Add changes many, to build those once at the end.
+		bool listingTriangles = true;
+		/// Vertices left out of the triangulation in the Delaunay mode for being exactly on another, to take in once that one goes.
+		TArray<int> leftOut;
+		/// A triangle with each vertex as a corner, noted as triangles are linked. Checked before use, as removing triangles can leave it stale.
+		TArray<int> vertexTriangles;
+
+		/// Adjacency, kept up to date as triangles are added and changed.
+		/// Half-edge 3 * t + i runs along the edge opposite vertex i of triangle t, from vertex i + 1 to vertex i + 2 (mod 3).
+		/// twins[3 * t + i] is the half-edge running the other way in the triangle across that edge, or -1 on the bounds.
+		TArray<int> twins;
+
+		/// Point location, built once the triangulation is complete.
+		/// Uniform grid over the real vertices, listing the interior triangles overlapping each cell.
+		TArray<TArray<int>> triangleGrid;
+		FVector gridOrigin;
+		float gridCellSize = 1.0f;
+		int gridSizeX = 0;
+		int gridSizeY = 0;
+		/// The number of triangles when the grid was built, to rebuild it once vertices added since have doubled that.
+		int gridNumTriangles = 0;
+		/// The triangle found by the last search, or containing the last vertex added, where the next search starts walking from.
+		int lastTriangle = -1;
+
+		/// Built on the first search after the triangulation changes, or by BuildTriangleCache.
+		TriangleCache triangleCache;
+		bool triangleCacheValid = false;
+
 	public:
 		void Clear()
 		{
+			triangleCacheValid = false;
 			vertices.Empty();
 			triangles.Empty();
+			twins.Empty();
 			exteriorEdges.Empty();
+			leftOut.Empty();
+			vertexTriangles.Empty();
+			ClearLocator();
 		}
 
 		void SetBounds(FVector minPos, FVector maxPos)
@@ -74,22 +130,68 @@ namespace WorldLockingTools
 			SeedQuad(bounds);
 		}
 
+		/// <summary>
+		/// Switch between flipping long edges and keeping the triangulation Delaunay, triangulating any vertices again.
+		///
+		/// Delaunay triangles avoid the slivers long edge flipping can leave, for smoother interpolation, and its exact
+		/// predicates handle collinear and cocircular vertices, like pins laid out on a grid.
+		/// </summary>
+		void SetDelaunay(bool inDelaunay)
+		{
+			if (delaunay != inDelaunay)
+			{
+				delaunay = inDelaunay;
+				if (vertices.Num() > 4)
+				{
+					Rebuild();
+				}
+			}
+		}
+
+		bool IsDelaunay() const
+		{
+			return delaunay;
+		}
+
 		bool Add(TArray<FVector> inVertices)
 		{
 			// Must set bounds before adding vertices.
 			check(vertices.Num() >= 4);
-			for (int i = 0; i < inVertices.Num(); ++i)
+			triangleCacheValid = false;
+			if (delaunay)
+			{
+				AddDelaunay(inVertices);
+			}
+			else
 			{
-				AddVertexSubdividing(inVertices[i]);
+				for (int i = 0; i < inVertices.Num(); ++i)
+				{
+					AddVertexSubdividing(inVertices[i]);
+				}
+				FlipLongEdges();
 			}
-			FlipLongEdges();
 			FindExteriorEdges();
+			BuildLocator();
 			return true;
 		}
 
 		bool Find(FVector pos, Interpolant& outBary)
 		{
-			bool HasInterpolant = FindTriangleOrEdgeOrVertex(pos, outBary);
+			if (!triangleCacheValid)
+			{
+				BuildTriangleCache();
+			}
+			return Find(pos, lastTriangle, outBary);
+		}
+
+		/// <summary>
+		/// Find the interpolant for a position without changing the triangulator, so that several threads can look up at once.
+		/// Call BuildTriangleCache first after changing the triangulation, or this is slower.
+		/// </summary>
+		/// <param name="inOutHint">The triangle to start looking from, -1 for none, set to the triangle found.</param>
+		bool Find(FVector pos, int& inOutHint, Interpolant& outBary) const
+		{
+			bool HasInterpolant = FindTriangleOrEdgeOrVertex(pos, inOutHint, outBary);
 			if (HasInterpolant)
 			{
 				AdjustForBoundingIndices(outBary);
@@ -98,6 +200,20 @@ namespace WorldLockingTools
 			return HasInterpolant;
 		}
 
+		int AddVertex(FVector pos);
+		void RemoveVertex(int idx);
+		void MoveVertex(int idx, FVector pos);
+
+		/// <summary>
+		/// The position of a vertex, by the index it was added as.
+		/// </summary>
+		FVector GetVertex(int idx) const
+		{
+			return vertices[idx + 4];
+		}
+
+		void BuildTriangleCache();
+
 		TArray<int> Triangles()
 		{
 			TArray<int> tris;
@@ -113,7 +229,7 @@ namespace WorldLockingTools
 		}
 
 	private:
-		void AdjustForBoundingIndices(Interpolant& bary)
+		void AdjustForBoundingIndices(Interpolant& bary) const
 		{
 			//if (bary != null)
 			{
@@ -142,13 +258,14 @@ namespace WorldLockingTools
 			{
 				if (idxBase + 2 < inVertices.Num())
 				{
-					triangles.Add(MakeTriangle(idxBase + 1, idxBase + 2, idxBase + 0));
+					AddTriangle(MakeTriangle(idxBase + 1, idxBase + 2, idxBase + 0));
 				}
 				if (idxBase + 3 < inVertices.Num())
 				{
-					triangles.Add(MakeTriangle(idxBase + 0, idxBase + 2, idxBase + 3));
+					AddTriangle(MakeTriangle(idxBase + 0, idxBase + 2, idxBase + 3));
 				}
 			}
+			LinkAllTriangles();
 			return triangles.Num() > 0;
 		}
 
@@ -166,8 +283,13 @@ namespace WorldLockingTools
 		bool WindingCorrect(int triIdx)
 		{
 			Triangle tri = triangles[triIdx];
-			float cross = -FVector::CrossProduct(vertices[tri.idx2] - vertices[tri.idx1], vertices[tri.idx0] - vertices[tri.idx1]).Z;
-			return cross > 0;
+			return Winding(tri.idx0, tri.idx1, tri.idx2) > 0;
+		}
+
+		/// Positive if a triangle with these vertices in this order is wound like the ones in the triangulation.
+		float Winding(int idx0, int idx1, int idx2) const
+		{
+			return -FVector::CrossProduct(vertices[idx2] - vertices[idx1], vertices[idx0] - vertices[idx1]).Z;
 		}
 
 		void AddVertexSubdividing(FVector vtx)
@@ -176,14 +298,16 @@ namespace WorldLockingTools
 			int newVertIdx = vertices.Num() - 1;
 
 			// Find closest triangle
-			IndexedBary bary = FindTriangle(vtx);
+			IndexedBary bary = LocateForInsertion(vtx);
 			check(bary.bary.IsInterior()); // Should be contained by background seed vertices.
 
 			// Find closest edge
+			int edgeCorner = ClosestCorner(bary);
 			Edge edge = ClosestEdge(bary);
 
 			// Find any other triangle with that edge
-			int oppositieTriIdx = FindTriangleWithEdge(edge, bary.triangle);
+			int oppositeHalfEdge = twins[bary.triangle * 3 + edgeCorner];
+			int oppositieTriIdx = oppositeHalfEdge >= 0 ? oppositeHalfEdge / 3 : -1;
 
 			bool canSplit = CanSplit(edge, oppositieTriIdx, newVertIdx);
 
@@ -236,12 +360,21 @@ namespace WorldLockingTools
 
 		void AddVertexSplitEdge(Edge edge, int triIdx0, int triIdx1, int newVertIdx)
 		{
-			SplitEdge(triIdx0, edge, newVertIdx);
-			SplitEdge(triIdx1, edge, newVertIdx);
+			TArray<HalfEdgeLink, TInlineAllocator<4>> outerLinks;
+			int splitTriangles[4] = { triIdx0, triIdx1, -1, -1 };
+			CollectOuterLinks(MakeArrayView(splitTriangles, 2), outerLinks);
+
+			splitTriangles[2] = SplitEdge(triIdx0, edge, newVertIdx);
+			splitTriangles[3] = SplitEdge(triIdx1, edge, newVertIdx);
+
+			RelinkTriangles(MakeArrayView(splitTriangles), outerLinks);
 		}
 
 		void AddVertexMidTriangle(int triIdx, int newVertIdx)
 		{
+			TArray<HalfEdgeLink, TInlineAllocator<4>> outerLinks;
+			CollectOuterLinks(MakeArrayView(&triIdx, 1), outerLinks);
+
 			Triangle tri = triangles[triIdx];
 
 			triangles[triIdx] = Triangle
@@ -250,7 +383,7 @@ namespace WorldLockingTools
 				tri.idx1,
 				newVertIdx
 			};
-			triangles.Add(
+			int newTriIdx0 = AddTriangle(
 				Triangle
 				{
 					tri.idx1,
@@ -258,7 +391,7 @@ namespace WorldLockingTools
 					newVertIdx
 				}
 			);
-			triangles.Add(
+			int newTriIdx1 = AddTriangle(
 				Triangle
 				{
 					tri.idx2,
@@ -266,9 +399,16 @@ namespace WorldLockingTools
 					newVertIdx
 				}
 			);
+
+			int splitTriangles[3] = { triIdx, newTriIdx0, newTriIdx1 };
+			RelinkTriangles(MakeArrayView(splitTriangles), outerLinks);
 		}
 
-		void SplitEdge(int triIdx, Edge edge, int newVertIdx)
+		/// <summary>
+		/// Split a triangle in two at a new vertex on one of its edges.
+		/// </summary>
+		/// <returns>The index of the added triangle, the other half replaces the original.</returns>
+		int SplitEdge(int triIdx, Edge edge, int newVertIdx)
 		{
 			Triangle tri = triangles[triIdx];
 			if (EdgesEqual(edge, tri.idx0, tri.idx1))
@@ -286,7 +426,7 @@ namespace WorldLockingTools
 					tri.idx2
 				};
 				triangles[triIdx] = newTri0;
-				triangles.Add(newTri1);
+				return AddTriangle(newTri1);
 			}
 			else if (EdgesEqual(edge, tri.idx1, tri.idx2))
 			{
@@ -303,7 +443,7 @@ namespace WorldLockingTools
 					tri.idx0
 				};
 				triangles[triIdx] = newTri0;
-				triangles.Add(newTri1);
+				return AddTriangle(newTri1);
 			}
 			else
 			{
@@ -321,7 +461,7 @@ namespace WorldLockingTools
 					tri.idx1
 				};
 				triangles[triIdx] = newTri0;
-				triangles.Add(newTri1);
+				return AddTriangle(newTri1);
 			}
 		}
 
@@ -368,59 +508,14 @@ namespace WorldLockingTools
 				&& FVector::CrossProduct(vt - v2, v0 - v2).Z >= nearIn;
 		}
 
-		void FlipLongEdges()
-		{
-			/// Make a list of all unique edges (no duplicates).
-			TArray<Edge> edges = ListSharedEdges();
-
-			/// For each edge in the list
-			for (int iEdge = 0; iEdge < edges.Num(); ++iEdge)
-			{
-				Edge edge = edges[iEdge];
-				/// Find the two triangles sharing it.
-				int tri0 = FindTriangleWithEdge(edge, -1);
-				check(tri0 >= 0); // Can't find a triangle with a known edge
-				int tri1 = FindTriangleWithEdge(edge, tri0);
+		void FlipLongEdges();
+		bool FlipIfImproves(Edge edge, int tri0, int tri1);
+		void FlipEdgesAround(TArrayView<const int> tris);
 
-				/// If there are two triangles
-				if (tri1 >= 0)
-				{
-					/// Shift the indices to form (i,j,k),(k,j,l) where (j,k) is the edge.
-					ShiftTriangles(edge, tri0, tri1);
-
-					Triangle t0 = triangles[tri0];
-					Triangle t1 = triangles[tri1];
-					if (!IsInsideTriangle(t0.idx0, t0.idx1, t1.idx2, t0.idx2)
-						&& !IsInsideTriangle(t0.idx0, t1.idx2, t0.idx2, t0.idx1))
-					{
-						float edgeLengthSq = (vertices[edge.idx0] - vertices[edge.idx1]).SizeSquared();
-						/// Find distance between vertices that aren't on the edge,
-						/// which is vert[0] from tri0 and vert[2] from tri1.
-						float crossLengthSq = (vertices[triangles[tri0].idx0] - vertices[triangles[tri1].idx2]).SizeSquared();
-
-						/// If that distance is shorter than edge length
-						if (crossLengthSq < edgeLengthSq)
-						{
-							/// change tri0 to (k,i,l) and tri1 to (l,i,j)
-							t0 = Triangle
-							{
-								triangles[tri0].idx2,
-								triangles[tri0].idx0,
-								triangles[tri1].idx2
-							};
-							t1 = Triangle
-							{
-								triangles[tri1].idx2,
-								triangles[tri0].idx0,
-								triangles[tri0].idx1
-							};
-							triangles[tri0] = t0;
-							triangles[tri1] = t1;
-						}
-					}
-				}
-			}
-		}
+		void AddDelaunay(const TArray<FVector>& inVertices);
+		bool LocateVertex(int vertIdx, int& outTriIdx, int& outEdgeCorner);
+		int WindingSign(int idx0, int idx1, int idx2) const;
+		bool InCircumcircle(int idx0, int idx1, int idx2, int idxTest) const;
 
 		bool EdgeHasVertex(Edge edge, int vertIdx)
 		{
@@ -454,24 +549,6 @@ namespace WorldLockingTools
 			triangles[tri1] = t0;
 		}
 
-		int FindTriangleWithEdge(Edge edge, int notTriangle)
-		{
-			for (int i = 0; i < triangles.Num(); ++i)
-			{
-				if (i != notTriangle)
-				{
-					Triangle tri = triangles[i];
-					if (EdgesEqual(edge, tri.idx0, tri.idx1)
-						|| EdgesEqual(edge, tri.idx1, tri.idx2)
-						|| EdgesEqual(edge, tri.idx2, tri.idx0))
-					{
-						return i;
-					}
-				}
-			}
-			return -1;
-		}
-
 		bool EdgesEqual(Edge edge, int idx0, int idx1)
 		{
 			if (edge.idx0 == idx0 && edge.idx1 == idx1)
@@ -485,6 +562,25 @@ namespace WorldLockingTools
 			return false;
 		}
 
+		/// <summary>
+		/// The corner of the triangle opposite the edge closest to the position.
+		/// </summary>
+		int ClosestCorner(IndexedBary bary)
+		{
+			int corner = 0;
+			float minWeight = bary.bary.weights[0];
+			if (bary.bary.weights[1] < minWeight)
+			{
+				corner = 1;
+				minWeight = bary.bary.weights[1];
+			}
+			if (bary.bary.weights[2] < minWeight)
+			{
+				corner = 2;
+			}
+			return corner;
+		}
+
 		Edge ClosestEdge(IndexedBary bary)
 		{
 			Triangle tri = triangles[bary.triangle];
@@ -506,16 +602,80 @@ namespace WorldLockingTools
 			return edge;
 		}
 
-		IndexedBary FindTriangle(FVector pos);
+		IndexedBary FindTriangle(FVector pos) const;
+		IndexedBary LocateForInsertion(FVector pos);
+		int ChooseWalkStart(FVector pos);
 
-		bool FindTriangleOrEdgeOrVertex(FVector pos, Interpolant& outBary)
+		int Corner(int triIdx, int i) const
 		{
-			if (PointInsideBounds(pos))
+			const Triangle& tri = triangles[triIdx];
+			return i == 0 ? tri.idx0 : (i == 1 ? tri.idx1 : tri.idx2);
+		}
+
+		int HalfEdgeFrom(int halfEdge) const
+		{
+			return Corner(halfEdge / 3, (halfEdge + 1) % 3);
+		}
+
+		int HalfEdgeTo(int halfEdge) const
+		{
+			return Corner(halfEdge / 3, (halfEdge + 2) % 3);
+		}
+
+		int AddTriangle(Triangle tri)
+		{
+			twins.Add(-1);
+			twins.Add(-1);
+			twins.Add(-1);
+			return triangles.Add(tri);
+		}
+
+		/// Point each corner of a triangle back to it, for FindTriangleWithVertex.
+		void NoteCorners(int triIdx)
+		{
+			const Triangle& tri = triangles[triIdx];
+			int maxIdx = FMath::Max3(tri.idx0, tri.idx1, tri.idx2);
+			if (maxIdx >= vertexTriangles.Num())
 			{
-				outBary = FindTriangle(pos).bary;
+				vertexTriangles.SetNum(maxIdx + 1);
+			}
+			vertexTriangles[tri.idx0] = triIdx;
+			vertexTriangles[tri.idx1] = triIdx;
+			vertexTriangles[tri.idx2] = triIdx;
+		}
+
+		void AttachVertex(int vertIdx);
+		bool DetachVertex(int vertIdx);
+		void AttachLeftOutAt(FVector pos);
+		void RenameVertex(int fromIdx, int toIdx);
+		int FindTriangleWithVertex(int vertIdx);
+		void CollectStar(int vertIdx, TArray<int, TInlineAllocator<16>>& outTris);
+		void RemoveTriangle(int triIdx);
+		void Rebuild();
+
+		void LinkAllTriangles();
+		void CollectOuterLinks(TArrayView<const int> tris, TArray<HalfEdgeLink, TInlineAllocator<4>>& outLinks) const;
+		void RelinkTriangles(TArrayView<const int> tris, TArrayView<const HalfEdgeLink> outerLinks);
+
+		bool ComputeBary(int triIdx, FVector pos, Interpolant& outBary) const;
 
-				if (IsInteriorTriangle(outBary))
+		void ClearLocator();
+		void BuildLocator();
+		bool GridCellRange(int triIdx, int& outX0, int& outX1, int& outY0, int& outY1);
+		void UnlistTriangles(TArrayView<const int> tris);
+		void ListTriangles(TArrayView<const int> tris);
+		bool LocateTriangle(FVector pos, int& inOutHint, IndexedBary& outBary) const;
+		bool WalkToTriangle(FVector pos, int startTriangle, IndexedBary& outBary) const;
+		bool LookUpInteriorTriangle(FVector pos, IndexedBary& outBary) const;
+
+		bool FindTriangleOrEdgeOrVertex(FVector pos, int& inOutHint, Interpolant& outBary) const
+		{
+			if (PointInsideBounds(pos))
+			{
+				IndexedBary found;
+				if (LocateTriangle(pos, inOutHint, found) && IsInteriorTriangle(found.bary))
 				{
+					outBary = found.bary;
 					return true;
 				}
 			}
@@ -523,7 +683,7 @@ namespace WorldLockingTools
 			return FindClosestExteriorEdge(pos, outBary);
 		}
 
-		bool PointInsideBounds(FVector pos)
+		bool PointInsideBounds(FVector pos) const
 		{
 			if (vertices.Num() < 4)
 			{
@@ -535,7 +695,7 @@ namespace WorldLockingTools
 				&& pos.Y <= vertices[3].Y;
 		}
 
-		bool IsInteriorTriangle(Interpolant bary)
+		bool IsInteriorTriangle(Interpolant bary) const
 		{
 			/*if (bary == nullptr)
 			{
@@ -551,11 +711,27 @@ namespace WorldLockingTools
 			return true;
 		}
 
-		bool IsBoundary(int vertIdx)
+		bool IsBoundary(int vertIdx) const
 		{
 			return vertIdx < 4;
 		}
 
+		/// Any real vertex in the triangulation, or -1 if there is none.
+		int FindTriangulatedVertex() const
+		{
+			for (const Triangle& tri : triangles)
+			{
+				for (int vertIdx : { tri.idx0, tri.idx1, tri.idx2 })
+				{
+					if (!IsBoundary(vertIdx))
+					{
+						return vertIdx;
+					}
+				}
+			}
+			return -1;
+		}
+
 		int HasExteriorEdge(Triangle tri)
 		{
 			int outVertIdx = -1;
@@ -624,59 +800,29 @@ namespace WorldLockingTools
 				int outVertIdx = HasExteriorEdge(tri);
 				if (outVertIdx >= 0)
 				{
-					exteriorEdges.Add(ExtractEdge(tri, outVertIdx));
-				}
-			}
-			RemoveRedundantEdges(exteriorEdges);
-		}
-
-		void RemoveRedundantEdges(TArray<Edge> edges)
-		{
-			// Don't really need to check length, if it's empty or single edge nothing will happen.
-			if (edges.Num() > 1)
-			{
-				edges.Sort([this](Edge e0, Edge e1)
-				{
-					// Sort by first index first.
-					if (e0.idx0 < e1.idx0)
-					{
-						return false;
-					}
-					if (e0.idx0 > e1.idx0)
-					{
-						return true;
-					}
-					// First index equal, sort by second index.
-					if (e0.idx1 < e1.idx1)
+					// When the triangle across also has this as its exterior edge, only the lower half-edge adds it.
+					int halfEdge = iTri * 3 + outVertIdx;
+					int twin = twins[halfEdge];
+					if (twin >= 0 && twin < halfEdge && HasExteriorEdge(triangles[twin / 3]) == twin % 3)
 					{
-						return false;
-					}
-					if (e0.idx1 > e1.idx1)
-					{
-						return true;
-					}
-					return false;
-				});
-				// Note i doesn't reach zero, because edges[i] is compared to edges[i-1].
-				for (int i = edges.Num() - 1; i > 0; --i)
-				{
-					if (edges[i - 1].idx0 == edges[i].idx0 && edges[i - 1].idx1 == edges[i].idx1)
-					{
-						edges.RemoveAt(i);
+						continue;
 					}
+					exteriorEdges.Add(ExtractEdge(tri, outVertIdx));
 				}
 			}
 		}
 
-		bool FindClosestExteriorEdge(FVector pos, Interpolant& outBary)
+		bool FindClosestExteriorEdge(FVector pos, Interpolant& outBary) const
 		{
 			if (exteriorEdges.Num() == 0)
 			{
-				if (vertices.Num() == 5)
+				int single = FindTriangulatedVertex();
+				if (single >= 0)
 				{
-					/// There is a single real vertex, so no exterior edges.
-					/// That's okay, the single vertex wins all the weight.
-					outBary.idx[0] = outBary.idx[1] = outBary.idx[2] = 4;
+					/// The real vertices triangulated are all at one position, so there are no exterior edges.
+					/// More vertices may have been added there, but are left out as duplicates.
+					/// That's okay, the single vertex triangulated wins all the weight.
+					outBary.idx[0] = outBary.idx[1] = outBary.idx[2] = single;
 					outBary.weights[0] = 1.0f;
 					outBary.weights[1] = outBary.weights[2] = 0.0f;
 					return true;
@@ -709,7 +855,7 @@ namespace WorldLockingTools
 			return true;
 		}
 
-		PointOnEdge PositionOnEdge(Edge edge, FVector pos)
+		PointOnEdge PositionOnEdge(Edge edge, FVector pos) const
 		{
 			/// Project everything onto the horizontal plane.
 			pos.Z = 0;
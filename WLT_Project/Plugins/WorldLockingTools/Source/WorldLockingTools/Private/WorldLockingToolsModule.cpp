@@ -81,4 +81,63 @@ void UWorldLockingToolsFunctionLibrary::Reset()
 #endif
 }
 
+FAnchorComponentPoolStats UWorldLockingToolsFunctionLibrary::GetAnchorComponentPoolStats()
+{
+#if defined(USING_FROZEN_WORLD)
+	WorldLockingTools::FWorldLockingToolsModule* WLTModule = GetWorldLockingToolsModule();
+	if (WLTModule == nullptr || WLTModule->FrozenWorldPlugin == nullptr)
+	{
+		return FAnchorComponentPoolStats();
+	}
+
+	return WLTModule->FrozenWorldPlugin->GetAnchorComponentPoolStats();
+#else
+	return FAnchorComponentPoolStats();
+#endif
+}
+
+FAnchorConsolidationStats UWorldLockingToolsFunctionLibrary::GetAnchorConsolidationStats()
+{
+#if defined(USING_FROZEN_WORLD)
+	WorldLockingTools::FWorldLockingToolsModule* WLTModule = GetWorldLockingToolsModule();
+	if (WLTModule == nullptr || WLTModule->FrozenWorldPlugin == nullptr)
+	{
+		return FAnchorConsolidationStats();
+	}
+
+	return WLTModule->FrozenWorldPlugin->GetAnchorConsolidationStats();
+#else
+	return FAnchorConsolidationStats();
+#endif
+}
+
+FPendingAttachmentPointStats UWorldLockingToolsFunctionLibrary::GetPendingAttachmentPointStats()
+{
+#if defined(USING_FROZEN_WORLD)
+	WorldLockingTools::FWorldLockingToolsModule* WLTModule = GetWorldLockingToolsModule();
+	if (WLTModule == nullptr || WLTModule->FrozenWorldPlugin == nullptr)
+	{
+		return FPendingAttachmentPointStats();
+	}
+
+	return WLTModule->FrozenWorldPlugin->GetPendingAttachmentPointStats();
+#else
+	return FPendingAttachmentPointStats();
+#endif
+}
+
+TArray<FTransform> UWorldLockingToolsFunctionLibrary::ComputePinnedFromLockedPoses(const TArray<FVector>& LockedPositions, int BatchSize)
+{
+#if defined(USING_FROZEN_WORLD)
+	WorldLockingTools::FWorldLockingToolsModule* WLTModule = GetWorldLockingToolsModule();
+	if (WLTModule != nullptr && WLTModule->FrozenWorldPlugin != nullptr)
+	{
+		return WLTModule->FrozenWorldPlugin->ComputePinnedFromLockedPoses(LockedPositions, BatchSize);
+	}
+#endif
+	TArray<FTransform> PinnedFromLockedPoses;
+	PinnedFromLockedPoses.Init(FTransform::Identity, LockedPositions.Num());
+	return PinnedFromLockedPoses;
+}
+
 IMPLEMENT_MODULE(WorldLockingTools::FWorldLockingToolsModule, WorldLockingTools)
\ No newline at end of file
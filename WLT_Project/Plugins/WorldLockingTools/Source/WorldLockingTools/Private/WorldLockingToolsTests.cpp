@@ -4,7 +4,18 @@
 #include "CoreMinimal.h"
 #include "FrozenWorldPlugin.h"
 #include "FrozenWorldPoseExtensions.h"
+#include "AnchorRegionStore.h"
+#include "AttachmentPointBatchListener.h"
+#include "AttachmentPointIndex.h"
+#include "DeferredAdjustments.h"
+#include "Fragment.h"
+#include "FragmentManager.h"
+#include "GeometricPredicates.h"
+#include "Interfaces/IPluginManager.h"
 #include "Misc/AutomationTest.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Paths.h"
+#include "PoseAveraging.h"
 
 namespace WorldLockingTools
 {
@@ -19,6 +30,377 @@ namespace WorldLockingTools
 			FTransform lockedPose;
 		};
 
+		class FCountingBatchListener : public FAttachmentPointBatchListener
+		{
+		public:
+			int NumBatches = 0;
+			TArray<AttachmentPointUpdate> LastBatch;
+
+			void OnAttachmentPointsUpdated(TArrayView<const AttachmentPointUpdate> updates) override
+			{
+				++NumBatches;
+				LastBatch = updates;
+			}
+		};
+
+		/// <summary>
+		/// Stand-in for the FrozenWorld engine's refreeze adjustments, so refits can be driven without the engine.
+		/// Each anchor gets its own correction, looked up per attachment point like the engine would.
+		/// </summary>
+		class FStandInEngine
+		{
+		public:
+			TMap<FrozenWorld_AnchorId, FTransform> corrections;
+
+			FTransform GetCorrection(FrozenWorld_AnchorId anchorId) const
+			{
+				const FTransform* correction = corrections.Find(anchorId);
+				return correction != nullptr ? *correction : FTransform::Identity;
+			}
+
+			void ComputeAdjustments(TArrayView<AttachmentPointAdjustment> adjustments) const
+			{
+				for (auto& entry : adjustments)
+				{
+					entry.adjustment = GetCorrection(entry.anchorId);
+					entry.adjusted = true;
+				}
+			}
+		};
+
+		// Attachment point counts each WLT.Perf.Fragments test runs at, spread over perfNumFragments fragments.
+		const int perfSizes[3] = { 1000, 10000, 100000 };
+		const int perfNumFragments = 100;
+
+		// Vertex counts the WLT.Perf.Triangulator tests run at.
+		const int perfTriangulatorSizes[3] = { 100, 1000, 10000 };
+
+		// Measured times fail against their baseline only beyond this factor and this many milliseconds more, as they vary from run to run.
+		const double perfTimeTolerance = 2.0;
+		const double perfTimeSlackMilliseconds = 1.0;
+
+		/// <summary>
+		/// Allocator counting the allocations made on one thread, forwarding everything to the allocator it stands in for.
+		/// </summary>
+		class FCountingMalloc : public FMalloc
+		{
+		public:
+			FMalloc* Inner = nullptr;
+			uint32 ThreadId = 0;
+			int64 NumAllocations = 0;
+
+			void* Malloc(SIZE_T Size, uint32 Alignment) override
+			{
+				Record(Size);
+				return Inner->Malloc(Size, Alignment);
+			}
+
+			void* TryMalloc(SIZE_T Size, uint32 Alignment) override
+			{
+				Record(Size);
+				return Inner->TryMalloc(Size, Alignment);
+			}
+
+			void* Realloc(void* Original, SIZE_T Size, uint32 Alignment) override
+			{
+				Record(Size);
+				return Inner->Realloc(Original, Size, Alignment);
+			}
+
+			void* TryRealloc(void* Original, SIZE_T Size, uint32 Alignment) override
+			{
+				Record(Size);
+				return Inner->TryRealloc(Original, Size, Alignment);
+			}
+
+			void Free(void* Original) override
+			{
+				Inner->Free(Original);
+			}
+
+			SIZE_T QuantizeSize(SIZE_T Size, uint32 Alignment) override
+			{
+				return Inner->QuantizeSize(Size, Alignment);
+			}
+
+			bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+			{
+				return Inner->GetAllocationSize(Original, SizeOut);
+			}
+
+			void Trim(bool bTrimThreadCaches) override
+			{
+				Inner->Trim(bTrimThreadCaches);
+			}
+
+			void SetupTLSCachesOnCurrentThread() override
+			{
+				Inner->SetupTLSCachesOnCurrentThread();
+			}
+
+			void ClearAndDisableTLSCachesOnCurrentThread() override
+			{
+				Inner->ClearAndDisableTLSCachesOnCurrentThread();
+			}
+
+			bool IsInternallyThreadSafe() const override
+			{
+				return Inner->IsInternallyThreadSafe();
+			}
+
+			bool ValidateHeap() override
+			{
+				return Inner->ValidateHeap();
+			}
+
+			const TCHAR* GetDescriptiveName() override
+			{
+				return Inner->GetDescriptiveName();
+			}
+
+		private:
+			void Record(SIZE_T Size)
+			{
+				// Only the measuring thread writes the count, other threads just pass through.
+				if (Size > 0 && FPlatformTLS::GetCurrentThreadId() == ThreadId)
+				{
+					++NumAllocations;
+				}
+			}
+		};
+
+		/// <summary>
+		/// Count the allocations made on the current thread while in scope.
+		/// 
+		/// The counting allocator only forwards to the one it stands in for, so memory allocated through either can be freed
+		/// through the other, and other threads may keep allocating through it. For the same reason it is never destroyed.
+		/// Scopes must not be nested.
+		/// </summary>
+		class FScopedAllocationCount
+		{
+		public:
+			FScopedAllocationCount()
+			{
+				FCountingMalloc& counter = GetCounter();
+				check(GMalloc != &counter);
+				counter.Inner = GMalloc;
+				counter.ThreadId = FPlatformTLS::GetCurrentThreadId();
+				counter.NumAllocations = 0;
+				FPlatformAtomics::InterlockedExchangePtr((void**)&GMalloc, &counter);
+			}
+
+			~FScopedAllocationCount()
+			{
+				FPlatformAtomics::InterlockedExchangePtr((void**)&GMalloc, GetCounter().Inner);
+			}
+
+			int64 Num() const
+			{
+				return GetCounter().NumAllocations;
+			}
+
+		private:
+			static FCountingMalloc& GetCounter()
+			{
+				static FCountingMalloc counter;
+				return counter;
+			}
+		};
+
+		struct FPerfMeasurement
+		{
+			double milliseconds = 0;
+			int64 allocations = 0;
+		};
+
+		/// <summary>
+		/// Time a piece of work, and count the allocations it makes on this thread.
+		/// </summary>
+		template<typename FunctionType>
+		FPerfMeasurement MeasurePerf(FunctionType work)
+		{
+			FPerfMeasurement measured;
+			FScopedAllocationCount allocations;
+			double startTime = FPlatformTime::Seconds();
+			work();
+			measured.milliseconds = (FPlatformTime::Seconds() - startTime) * 1000.0;
+			measured.allocations = allocations.Num();
+			return measured;
+		}
+
+		/// <summary>
+		/// Compare a measurement with its baseline, failing if it makes more allocations, or takes well over the time.
+		/// 
+		/// Baselines come from Config/PerfBaselines.ini in the plugin, or else from those recorded on this machine in
+		/// Saved/Automation/WLTPerfBaselines.ini. A measurement with neither is recorded there as the baseline for the runs after it.
+		/// Every measurement is also written to Saved/Automation/WLTPerf.ini, to copy over the baselines after an intended change.
+		/// </summary>
+		/// <param name="section">The test measured, such as WLT.Perf.Fragments.Create.</param>
+		/// <param name="size">The size of the problem, such as the number of attachment points.</param>
+		/// <returns>False if the measurement regressed against its baseline.</returns>
+		bool CheckPerfBaseline(const FString& section, int size, const FPerfMeasurement& measured)
+		{
+			FString allocationsKey = FString::Printf(TEXT("Allocations_%d"), size);
+			FString millisecondsKey = FString::Printf(TEXT("Milliseconds_%d"), size);
+			FString allocationsValue = FString::Printf(TEXT("%lld"), measured.allocations);
+			FString millisecondsValue = FString::Printf(TEXT("%f"), measured.milliseconds);
+
+			UE_LOG(LogTemp, Log, TEXT("%s with %d: %f ms, %lld allocations"), *section, size, measured.milliseconds, measured.allocations);
+
+			FString resultsFileName = FPaths::AutomationDir() / TEXT("WLTPerf.ini");
+			FConfigFile results;
+			results.Read(resultsFileName);
+			results.SetString(*section, *allocationsKey, *allocationsValue);
+			results.SetString(*section, *millisecondsKey, *millisecondsValue);
+			results.Write(resultsFileName);
+
+			FConfigFile baselines;
+			baselines.Read(IPluginManager::Get().FindPlugin("WorldLockingTools")->GetBaseDir() / TEXT("Config/PerfBaselines.ini"));
+			FString recordedFileName = FPaths::AutomationDir() / TEXT("WLTPerfBaselines.ini");
+			FConfigFile recorded;
+			recorded.Read(recordedFileName);
+
+			bool testPassed = true;
+			bool recordedChanged = false;
+			FString baseline;
+			if (baselines.GetString(*section, *allocationsKey, baseline) || recorded.GetString(*section, *allocationsKey, baseline))
+			{
+				if (measured.allocations > FCString::Atoi64(*baseline))
+				{
+					UE_LOG(LogTemp, Error, TEXT("%s with %d made %lld allocations, baseline is %s"), *section, size, measured.allocations, *baseline);
+					testPassed = false;
+				}
+			}
+			else
+			{
+				recorded.SetString(*section, *allocationsKey, *allocationsValue);
+				recordedChanged = true;
+			}
+			if (baselines.GetString(*section, *millisecondsKey, baseline) || recorded.GetString(*section, *millisecondsKey, baseline))
+			{
+				double baselineMilliseconds = FCString::Atod(*baseline);
+				if (measured.milliseconds > FMath::Max(baselineMilliseconds * perfTimeTolerance, baselineMilliseconds + perfTimeSlackMilliseconds))
+				{
+					UE_LOG(LogTemp, Error, TEXT("%s with %d took %f ms, baseline is %s ms"), *section, size, measured.milliseconds, *baseline);
+					testPassed = false;
+				}
+			}
+			else
+			{
+				recorded.SetString(*section, *millisecondsKey, *millisecondsValue);
+				recordedChanged = true;
+			}
+			if (recordedChanged)
+			{
+				recorded.Write(recordedFileName);
+			}
+			return testPassed;
+		}
+
+		/// <summary>
+		/// Set up the fragments for a WLT.Perf.Fragments test, without any attachment points.
+		/// </summary>
+		void CreatePerfFragments(FAttachmentPointPool& pool, TArray<FFragment>& fragments)
+		{
+			fragments.Reserve(perfNumFragments);
+			for (int i = 0; i < perfNumFragments; ++i)
+			{
+				FFragment& fragment = fragments.Emplace_GetRef(FrozenWorld_FragmentId(i + 1), pool);
+				fragment.State = i == 0 ? AttachmentPointStateType::Normal : AttachmentPointStateType::Unconnected;
+			}
+		}
+
+		/// <summary>
+		/// Create attachment points spread over the fragments, each on an anchor of its own fragment.
+		/// </summary>
+		void AddPerfAttachmentPoints(FAttachmentPointPool& pool, TArray<FFragment>& fragments, int numAttachmentPoints,
+			TArray<FAttachmentPointHandle>& outHandles)
+		{
+			const int anchorsPerFragment = 16;
+			for (int i = 0; i < numAttachmentPoints; ++i)
+			{
+				FFragment& fragment = fragments[i % fragments.Num()];
+				FVector position(i % 100 * 50.0f, i / 100 % 100 * 50.0f, i / 10000 * 50.0f);
+				FAttachmentPointHandle handle = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate());
+				FAttachmentPoint* attachmentPoint = pool.Get(handle);
+				attachmentPoint->Set(fragment.FragmentId, position, MakeAnchorId(i % fragments.Num() * anchorsPerFragment + i % anchorsPerFragment), FVector::ZeroVector);
+				attachmentPoint->ObjectPosition = position;
+				fragment.AddAttachmentPoint(handle);
+				outHandles.Add(handle);
+			}
+		}
+
+		/// <summary>
+		/// Random vertices on the plane, the same for every run of a WLT.Perf.Triangulator test of the same size.
+		/// </summary>
+		TArray<FVector> MakePerfVertices(int numVertices)
+		{
+			FRandomStream random(numVertices);
+			TArray<FVector> vertices;
+			for (int i = 0; i < numVertices; ++i)
+			{
+				vertices.Add(FVector(random.FRandRange(-5000.0f, 5000.0f), random.FRandRange(-5000.0f, 5000.0f), 0));
+			}
+			return vertices;
+		}
+
+		/// <summary>
+		/// Pins scattered over the plane, each virtual pose a little off its locked pose, as for WLT.Alignment.Batch. They are not sent yet.
+		/// </summary>
+		void AddScatteredPins(int numPins)
+		{
+			FRandomStream random(45);
+			for (int i = 0; i < numPins; ++i)
+			{
+				FVector lockedPos(random.FRandRange(-2000.0f, 2000.0f), random.FRandRange(-2000.0f, 2000.0f), 0);
+				FVector virtualPos = lockedPos + FVector(random.FRandRange(-50.0f, 50.0f), random.FRandRange(-50.0f, 50.0f), 0);
+				FQuat virtualRot(FVector::UpVector, random.FRandRange(-0.2f, 0.2f));
+				FAlignmentManager::Get()->AddAlignmentAnchor(FString::Printf(TEXT("batchPin%d"), i),
+					FTransform(virtualRot, virtualPos), FTransform(FQuat::Identity, lockedPos));
+			}
+		}
+
+		/// <summary>
+		/// Rows of positions across the pins of AddScatteredPins and beyond, as for a heatmap of the alignment.
+		/// </summary>
+		TArray<FVector> MakeAlignmentGrid(int gridSize)
+		{
+			TArray<FVector> positions;
+			for (int y = 0; y < gridSize; ++y)
+			{
+				for (int x = 0; x < gridSize; ++x)
+				{
+					positions.Add(FVector(-2500.0f + x * 5000.0f / gridSize, -2500.0f + y * 5000.0f / gridSize, 0));
+				}
+			}
+			return positions;
+		}
+
+		FVector CalibrationLockedPosition(int pin)
+		{
+			return FVector((pin % 10) * 300.0f, (pin / 10) * 300.0f, 0);
+		}
+
+		FVector CalibrationVirtualPosition(int pin)
+		{
+			return FVector((pin % 10) * 300.0f + 20.0f, (pin / 10) * 300.0f, 0);
+		}
+
+		/// <summary>
+		/// A calibration pass, setting each pin on its own frame, as each is found.
+		/// </summary>
+		void SetCalibrationPins(int numPins)
+		{
+			FAlignmentManager* alignmentManager = FAlignmentManager::Get();
+			for (int pin = 0; pin < numPins; ++pin)
+			{
+				alignmentManager->AddAlignmentAnchor(FString::Printf(TEXT("transactionPin%d"), pin),
+					FTransform(FQuat::Identity, CalibrationVirtualPosition(pin)), FTransform(FQuat::Identity, CalibrationLockedPosition(pin)));
+				alignmentManager->SendAlignmentAnchors();
+				alignmentManager->ComputePinnedPose(FTransform(FQuat::Identity, CalibrationLockedPosition(pin)));
+			}
+		}
+
 		FrozenWorld_AnchorId MakeAnchorId(int idx)
 		{
 			return FrozenWorld_AnchorId_INVALID + 1 + idx;
@@ -443,93 +825,1619 @@ namespace WorldLockingTools
 			return succeeded;
 		}
 
-		bool RunTestAlignmentThreeBodyOrient()
+		bool RunTestTriangulatorWalk()
 		{
-			TArray<FVector> modelPositions;
-			modelPositions.Add(FVector(0, 1, 0));
-			modelPositions.Add(FVector(1, 0, 0));
-			modelPositions.Add(FVector(0.5f, 0.3f, 0.4f));
-			modelPositions.Add(FVector(10, -8, 7));
+			const int numVertices = 2000;
+			const int numFrames = 10000;
 
-			TArray<FVector> frozenPositions;
-			frozenPositions.AddDefaulted(modelPositions.Num());
+			FRandomStream random(41);
+			TArray<FVector> vertices;
+			for (int i = 0; i < numVertices; ++i)
+			{
+				FVector2D p = FVector2D(random.FRandRange(-1.0f, 1.0f), random.FRandRange(-1.0f, 1.0f)) * 5000.0f;
+				vertices.Add(FVector(p.X, p.Y, 0));
+			}
 
-			FQuat initFrozenFromModel = FQuat::MakeFromEuler(FVector(0.0f, 45.0f, 45.0f));
+			FTriangulator triangulator;
+			triangulator.SetBounds(FVector(-100000, -100000, 0), FVector(100000, 100000, 0));
+			triangulator.Add(vertices);
 
-			for (int i = 0; i < modelPositions.Num(); ++i)
+			// Walk the head around in a slow circle, with a few jumps across the space and out of it.
+			bool succeeded = true;
+			int numInterior = 0;
+			for (int frame = 0; frame < numFrames; ++frame)
 			{
-				frozenPositions[i] = initFrozenFromModel * modelPositions[i];
+				float angle = frame * 0.001f;
+				FVector pos(FMath::Cos(angle) * 3000.0f, FMath::Sin(angle) * 3000.0f, 120.0f);
+				if (frame % 1000 == 999)
+				{
+					pos = frame % 2000 == 999 ? FVector(-pos.X, -pos.Y, 0) : pos * 5.0f;
+				}
+
+				Interpolant interp;
+				succeeded &= triangulator.Find(pos, interp);
+				if (interp.IsInterior() && interp.weights[2] > 0)
+				{
+					// Inside the triangulation, the weights reproduce the position.
+					FVector interpolated = FVector::ZeroVector;
+					for (int i = 0; i < 3; ++i)
+					{
+						interpolated += vertices[interp.idx[i]] * interp.weights[i];
+					}
+					succeeded &= FMath::Abs(interpolated.X - pos.X) < 0.1f && FMath::Abs(interpolated.Y - pos.Y) < 0.1f;
+					++numInterior;
+				}
 			}
 
-			float errorLength = 0;
-			for (int i = 1; i < modelPositions.Num(); ++i)
+			succeeded &= numInterior > numFrames / 2;
+			return succeeded;
+		}
+
+		bool RunTestPerfTriangulatorWalk()
+		{
+			const int numFrames = 10000;
+
+			bool succeeded = true;
+			for (int numVertices : perfTriangulatorSizes)
 			{
-				FQuat frozenFromModelFirst = FQuat::FindBetweenVectors(modelPositions[i - 1], frozenPositions[i - 1]);
+				FTriangulator triangulator;
+				triangulator.SetBounds(FVector(-100000, -100000, 0), FVector(100000, 100000, 0));
+				triangulator.Add(MakePerfVertices(numVertices));
 
-				FVector firstAlignedSecond = frozenFromModelFirst * modelPositions[i];
+				// The head walking around in a slow circle, so each position is found by walking from the last.
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (int frame = 0; frame < numFrames; ++frame)
+					{
+						float angle = frame * 0.001f;
+						Interpolant interp;
+						succeeded &= triangulator.Find(FVector(FMath::Cos(angle) * 3000.0f, FMath::Sin(angle) * 3000.0f, 120.0f), interp);
+					}
+				});
 
-				FVector dir = frozenPositions[i - 1];
-				dir.Normalize();
-				FVector up = FVector::CrossProduct(frozenPositions[i], dir);
-				up.Normalize();
-				FVector right = FVector::CrossProduct(dir, up);
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Triangulator.Walk"), numVertices, measured);
+			}
+			return succeeded;
+		}
 
-				float sinRads = FVector::DotProduct(firstAlignedSecond, up);
-				float cosRads = FVector::DotProduct(firstAlignedSecond, right);
+		bool RunTestTriangulatorIncremental()
+		{
+			const int numVertices = 300;
+			const int numEdits = 1000;
 
-				float rotRads = FMath::Atan2(sinRads, cosRads);
+			FRandomStream random(43);
+			auto randomPosition = [&random]()
+			{
+				return FVector(random.FRandRange(-5000.0f, 5000.0f), random.FRandRange(-5000.0f, 5000.0f), 0);
+			};
 
-				FQuat frozenFromModelSecond = FQuat(dir, rotRads);
+			TArray<FVector> vertices;
+			for (int i = 0; i < numVertices; ++i)
+			{
+				vertices.Add(randomPosition());
+			}
 
-				FQuat frozenFromModel = frozenFromModelSecond * frozenFromModelFirst;
+			FTriangulator triangulator;
+			triangulator.SetBounds(FVector(-100000, -100000, 0), FVector(100000, 100000, 0));
+			triangulator.Add(vertices);
 
-				TArray<FVector> checkFrozen;
-				checkFrozen.AddDefaulted(modelPositions.Num());
-				for (int j = 0; j < modelPositions.Num(); ++j)
+			// Add, remove and move vertices at random, small moves as when dragging a pin and jumps across the space.
+			bool succeeded = true;
+			for (int edit = 0; edit < numEdits; ++edit)
+			{
+				int idx = random.RandHelper(vertices.Num());
+				switch (edit % 4)
 				{
-					checkFrozen[j] = frozenFromModel * modelPositions[j];
-					FVector delErr = checkFrozen[j] - frozenPositions[j];
-					float errLen = delErr.Length();
-					errorLength += errLen;
+				case 0:
+				{
+					FVector pos = randomPosition();
+					succeeded &= triangulator.AddVertex(pos) == vertices.Num();
+					vertices.Add(pos);
+				}
+				break;
+				case 1:
+					triangulator.RemoveVertex(idx);
+					vertices.RemoveAtSwap(idx);
+					break;
+				case 2:
+					vertices[idx] += FVector(random.FRandRange(-50.0f, 50.0f), random.FRandRange(-50.0f, 50.0f), 0);
+					triangulator.MoveVertex(idx, vertices[idx]);
+					break;
+				default:
+					vertices[idx] = randomPosition();
+					triangulator.MoveVertex(idx, vertices[idx]);
+					break;
 				}
 			}
 
-			UE_LOG(LogTemp, Log, TEXT("Total error %f"), errorLength);
-
-			return errorLength <= KINDA_SMALL_NUMBER;
+			// Still a triangulation of all the vertices, which interpolates positions inside it exactly.
+			succeeded &= triangulator.Triangles().Num() == (2 * vertices.Num() + 2) * 3;
+			for (int i = 0; i < 1000; ++i)
+			{
+				FVector pos = randomPosition();
+				Interpolant interp;
+				succeeded &= triangulator.Find(pos, interp);
+				if (interp.IsInterior() && interp.weights[2] > 0)
+				{
+					FVector interpolated = FVector::ZeroVector;
+					for (int j = 0; j < 3; ++j)
+					{
+						interpolated += vertices[interp.idx[j]] * interp.weights[j];
+					}
+					succeeded &= FMath::Abs(interpolated.X - pos.X) < 0.1f && FMath::Abs(interpolated.Y - pos.Y) < 0.1f;
+				}
+			}
+			return succeeded;
 		}
 
-		bool RunTestAlignmentManagerBasic()
+		bool RunTestPerfTriangulatorEdit()
 		{
-			bool testPassed = true;
-
-			testPassed &= CheckSinglePin(0);
-			testPassed &= CheckSinglePin(1);
-
-			testPassed &= CheckDualPins(0, 1);
-			testPassed &= CheckDualPins(1, 2);
-			testPassed &= CheckDualPins(0, 2);
+			const int numEdits = 1000;
 
-			FAlignmentManager::Get()->ClearAlignmentAnchors();
-			TArray<FPinData> pinData = GetPinData();
-			for (int i = 0; i < 2; ++i)
+			bool succeeded = true;
+			for (int numVertices : perfTriangulatorSizes)
 			{
-				FAlignmentManager::Get()->AddAlignmentAnchor(pinData[i].name, pinData[i].virtualPose, pinData[i].lockedPose);
-			}
-			FAlignmentManager::Get()->SendAlignmentAnchors();
-
-			testPassed &= CheckAlignment(pinData[0].virtualPose.GetLocation(), pinData[0].lockedPose.GetLocation());
+				TArray<FVector> vertices = MakePerfVertices(numVertices);
+				vertices.Reserve(numVertices + numEdits);
 
-			testPassed &= CheckAlignment(pinData[1].virtualPose.GetLocation(), pinData[1].lockedPose.GetLocation());
+				FTriangulator triangulator;
+				triangulator.SetBounds(FVector(-100000, -100000, 0), FVector(100000, 100000, 0));
+				triangulator.Add(vertices);
 
-			testPassed &= CheckAlignment(
-				(pinData[0].virtualPose.GetLocation() + pinData[1].virtualPose.GetLocation()) * 0.5f,
-				(pinData[0].lockedPose.GetLocation() + pinData[1].lockedPose.GetLocation()) * 0.5f);
+				// Pins added, removed and dragged in turn, as in a calibration session, against the cost of WLT.Perf.Triangulator.Build.
+				FRandomStream random(43);
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (int edit = 0; edit < numEdits; ++edit)
+					{
+						int idx = random.RandHelper(vertices.Num());
+						switch (edit % 3)
+						{
+						case 0:
+						{
+							FVector pos(random.FRandRange(-5000.0f, 5000.0f), random.FRandRange(-5000.0f, 5000.0f), 0);
+							triangulator.AddVertex(pos);
+							vertices.Add(pos);
+						}
+						break;
+						case 1:
+							triangulator.RemoveVertex(idx);
+							vertices.RemoveAtSwap(idx);
+							break;
+						default:
+							vertices[idx] += FVector(random.FRandRange(-50.0f, 50.0f), random.FRandRange(-50.0f, 50.0f), 0);
+							triangulator.MoveVertex(idx, vertices[idx]);
+							break;
+						}
+					}
+				});
 
-			return testPassed;
+				succeeded &= triangulator.Triangles().Num() == (2 * vertices.Num() + 2) * 3;
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Triangulator.Edit"), numVertices, measured);
+			}
+			return succeeded;
 		}
-	};
-}
+
+		bool RunTestTriangulatorDelaunay()
+		{
+			bool succeeded = true;
+
+			// Exactly collinear and cocircular, which rounding alone gets wrong either way.
+			succeeded &= FGeometricPredicates::Orient2D(FVector(0.1f, 0.1f, 0), FVector(0.2f, 0.2f, 0), FVector(0.3f, 0.3f, 0)) == 0;
+			succeeded &= FGeometricPredicates::Orient2D(FVector(0, 0, 0), FVector(1, 0, 0), FVector(0.5f, 1.0e-30f, 0)) > 0;
+			succeeded &= FGeometricPredicates::InCircle(FVector(1, 0, 0), FVector(0, 1, 0), FVector(-1, 0, 0), FVector(0, -1, 0)) == 0;
+			succeeded &= FGeometricPredicates::InCircle(FVector(1, 0, 0), FVector(0, 1, 0), FVector(-1, 0, 0), FVector(0, -0.999999f, 0)) > 0;
+
+			// Pins on a regular grid, every four of them on a circle, plus one on top of another.
+			const FVector gridMin(-100, -100, 0);
+			const FVector gridMax(3000, 3000, 0);
+			TArray<FVector> gridVertices;
+			for (int y = 0; y < 30; ++y)
+			{
+				for (int x = 0; x < 30; ++x)
+				{
+					gridVertices.Add(FVector(x * 100.0f, y * 100.0f, 0));
+				}
+			}
+			gridVertices.Add(gridVertices[100]);
+
+			FTriangulator grid;
+			grid.SetDelaunay(true);
+			grid.SetBounds(gridMin, gridMax);
+			grid.Add(gridVertices);
+			succeeded &= grid.Triangles().Num() == (2 * (gridVertices.Num() - 1) + 2) * 3;
+
+			FRandomStream random(44);
+			for (int i = 0; i < 1000; ++i)
+			{
+				FVector pos(random.FRandRange(0.0f, 2900.0f), random.FRandRange(0.0f, 2900.0f), 0);
+				Interpolant interp;
+				succeeded &= grid.Find(pos, interp);
+				FVector interpolated = FVector::ZeroVector;
+				for (int j = 0; j < 3; ++j)
+				{
+					interpolated += gridVertices[interp.idx[j]] * interp.weights[j];
+				}
+				succeeded &= FMath::Abs(interpolated.X - pos.X) < 0.1f && FMath::Abs(interpolated.Y - pos.Y) < 0.1f;
+			}
+
+			// Random pins, edited after the first triangulation, which should still leave no vertex inside any triangle's circumcircle.
+			const FVector boundsMin(-10000, -10000, 0);
+			const FVector boundsMax(10000, 10000, 0);
+			TArray<FVector> vertices;
+			for (int i = 0; i < 300; ++i)
+			{
+				vertices.Add(FVector(random.FRandRange(-5000.0f, 5000.0f), random.FRandRange(-5000.0f, 5000.0f), 0));
+			}
+
+			FTriangulator triangulator;
+			triangulator.SetDelaunay(true);
+			triangulator.SetBounds(boundsMin, boundsMax);
+			triangulator.Add(vertices);
+			for (int edit = 0; edit < 300; ++edit)
+			{
+				int idx = random.RandHelper(vertices.Num());
+				FVector pos(random.FRandRange(-5000.0f, 5000.0f), random.FRandRange(-5000.0f, 5000.0f), 0);
+				switch (edit % 3)
+				{
+				case 0:
+					triangulator.AddVertex(pos);
+					vertices.Add(pos);
+					break;
+				case 1:
+					triangulator.RemoveVertex(idx);
+					vertices.RemoveAtSwap(idx);
+					break;
+				default:
+					triangulator.MoveVertex(idx, pos);
+					vertices[idx] = pos;
+					break;
+				}
+			}
+
+			// Triangles index the four bounding corners first, as SetBounds places them, and then the vertices.
+			TArray<FVector> positions;
+			positions.Add(FVector(boundsMin.X, boundsMax.Y, 0));
+			positions.Add(FVector(boundsMin.X, boundsMin.Y, 0));
+			positions.Add(FVector(boundsMax.X, boundsMin.Y, 0));
+			positions.Add(FVector(boundsMax.X, boundsMax.Y, 0));
+			positions.Append(vertices);
+
+			TArray<int> tris = triangulator.Triangles();
+			succeeded &= tris.Num() == (2 * vertices.Num() + 2) * 3;
+			for (int i = 0; i < tris.Num(); i += 3)
+			{
+				// Triangles wind the opposite way to a positive Orient2D, so a vertex inside makes InCircle negative.
+				const FVector& p0 = positions[tris[i]];
+				const FVector& p1 = positions[tris[i + 1]];
+				const FVector& p2 = positions[tris[i + 2]];
+				for (const FVector& pos : positions)
+				{
+					succeeded &= FGeometricPredicates::InCircle(p0, p1, p2, pos) >= 0;
+				}
+			}
+
+			// Two pins at the same place, one left out of the triangles, which takes over when the other goes.
+			FTriangulator duplicates;
+			duplicates.SetDelaunay(true);
+			duplicates.SetBounds(boundsMin, boundsMax);
+			duplicates.AddVertex(FVector(100, 200, 0));
+			duplicates.AddVertex(FVector(100, 200, 50));
+			duplicates.AddVertex(FVector(-300, 0, 0));
+			duplicates.RemoveVertex(2);
+			for (const FVector& pos : { FVector(100, 200, 0), FVector(500, -700, 0), FVector(20000, 0, 0) })
+			{
+				Interpolant interp;
+				succeeded &= duplicates.Find(pos, interp);
+				succeeded &= interp.idx[0] < 2 && interp.weights[0] == 1.0f;
+			}
+			duplicates.RemoveVertex(0);
+			{
+				Interpolant interp;
+				succeeded &= duplicates.Find(FVector(0, 0, 0), interp);
+				succeeded &= interp.idx[0] == 0 && interp.weights[0] == 1.0f;
+			}
+			duplicates.AddVertex(FVector(100, 200, 0));
+			duplicates.AddVertex(FVector(400, 200, 0));
+			duplicates.MoveVertex(0, FVector(-600, -600, 0));
+			{
+				Interpolant interp;
+				succeeded &= duplicates.Find(FVector(100, 200, 0), interp);
+				bool onDuplicate = false;
+				for (int j = 0; j < 3; ++j)
+				{
+					onDuplicate |= interp.idx[j] == 1 && interp.weights[j] > 0.999f;
+				}
+				succeeded &= onDuplicate;
+			}
+			return succeeded;
+		}
+
+		bool RunTestPerfTriangulatorDelaunay()
+		{
+			bool succeeded = true;
+			for (int numVertices : perfTriangulatorSizes)
+			{
+				TArray<FVector> vertices = MakePerfVertices(numVertices);
+
+				// Against the long edge flips of WLT.Perf.Triangulator.Build.
+				FTriangulator triangulator;
+				triangulator.SetDelaunay(true);
+				triangulator.SetBounds(FVector(-100000, -100000, 0), FVector(100000, 100000, 0));
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					triangulator.Add(vertices);
+				});
+
+				succeeded &= triangulator.Triangles().Num() == (2 * numVertices + 2) * 3;
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Triangulator.Delaunay"), numVertices, measured);
+			}
+			return succeeded;
+		}
+
+		bool RunTestPerfTriangulator()
+		{
+			const int numQueries = 1000;
+
+			bool succeeded = true;
+			for (int numVertices : perfTriangulatorSizes)
+			{
+				TArray<FVector> vertices = MakePerfVertices(numVertices);
+
+				FTriangulator triangulator;
+				triangulator.SetBounds(FVector(-100000, -100000, 0), FVector(100000, 100000, 0));
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					triangulator.Add(vertices);
+				});
+
+				// Every vertex lands inside the bounding quad, so it ends up split into two triangles per vertex, plus two.
+				succeeded &= triangulator.Triangles().Num() == (2 * numVertices + 2) * 3;
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Triangulator.Build"), numVertices, measured);
+
+				// Positions all over the triangulation, so each is found from far away.
+				TArray<FVector> queries = MakePerfVertices(numQueries);
+				measured = MeasurePerf([&]()
+				{
+					for (const FVector& pos : queries)
+					{
+						Interpolant interp;
+						succeeded &= triangulator.Find(pos, interp);
+						succeeded &= FMath::IsNearlyEqual(interp.weights[0] + interp.weights[1] + interp.weights[2], 1.0f, 1.0e-3f);
+					}
+				});
+
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Triangulator.Find"), numVertices, measured);
+			}
+			return succeeded;
+		}
+
+		bool RunTestAlignmentThreeBodyOrient()
+		{
+			TArray<FVector> modelPositions;
+			modelPositions.Add(FVector(0, 1, 0));
+			modelPositions.Add(FVector(1, 0, 0));
+			modelPositions.Add(FVector(0.5f, 0.3f, 0.4f));
+			modelPositions.Add(FVector(10, -8, 7));
+
+			TArray<FVector> frozenPositions;
+			frozenPositions.AddDefaulted(modelPositions.Num());
+
+			FQuat initFrozenFromModel = FQuat::MakeFromEuler(FVector(0.0f, 45.0f, 45.0f));
+
+			for (int i = 0; i < modelPositions.Num(); ++i)
+			{
+				frozenPositions[i] = initFrozenFromModel * modelPositions[i];
+			}
+
+			float errorLength = 0;
+			for (int i = 1; i < modelPositions.Num(); ++i)
+			{
+				FQuat frozenFromModelFirst = FQuat::FindBetweenVectors(modelPositions[i - 1], frozenPositions[i - 1]);
+
+				FVector firstAlignedSecond = frozenFromModelFirst * modelPositions[i];
+
+				FVector dir = frozenPositions[i - 1];
+				dir.Normalize();
+				FVector up = FVector::CrossProduct(frozenPositions[i], dir);
+				up.Normalize();
+				FVector right = FVector::CrossProduct(dir, up);
+
+				float sinRads = FVector::DotProduct(firstAlignedSecond, up);
+				float cosRads = FVector::DotProduct(firstAlignedSecond, right);
+
+				float rotRads = FMath::Atan2(sinRads, cosRads);
+
+				FQuat frozenFromModelSecond = FQuat(dir, rotRads);
+
+				FQuat frozenFromModel = frozenFromModelSecond * frozenFromModelFirst;
+
+				TArray<FVector> checkFrozen;
+				checkFrozen.AddDefaulted(modelPositions.Num());
+				for (int j = 0; j < modelPositions.Num(); ++j)
+				{
+					checkFrozen[j] = frozenFromModel * modelPositions[j];
+					FVector delErr = checkFrozen[j] - frozenPositions[j];
+					float errLen = delErr.Length();
+					errorLength += errLen;
+				}
+			}
+
+			UE_LOG(LogTemp, Log, TEXT("Total error %f"), errorLength);
+
+			return errorLength <= KINDA_SMALL_NUMBER;
+		}
+
+		bool RunTestAlignmentManagerBasic()
+		{
+			bool testPassed = true;
+
+			testPassed &= CheckSinglePin(0);
+			testPassed &= CheckSinglePin(1);
+
+			testPassed &= CheckDualPins(0, 1);
+			testPassed &= CheckDualPins(1, 2);
+			testPassed &= CheckDualPins(0, 2);
+
+			FAlignmentManager::Get()->ClearAlignmentAnchors();
+			TArray<FPinData> pinData = GetPinData();
+			for (int i = 0; i < 2; ++i)
+			{
+				FAlignmentManager::Get()->AddAlignmentAnchor(pinData[i].name, pinData[i].virtualPose, pinData[i].lockedPose);
+			}
+			FAlignmentManager::Get()->SendAlignmentAnchors();
+
+			testPassed &= CheckAlignment(pinData[0].virtualPose.GetLocation(), pinData[0].lockedPose.GetLocation());
+
+			testPassed &= CheckAlignment(pinData[1].virtualPose.GetLocation(), pinData[1].lockedPose.GetLocation());
+
+			testPassed &= CheckAlignment(
+				(pinData[0].virtualPose.GetLocation() + pinData[1].virtualPose.GetLocation()) * 0.5f,
+				(pinData[0].lockedPose.GetLocation() + pinData[1].lockedPose.GetLocation()) * 0.5f);
+
+			return testPassed;
+		}
+
+		bool RunTestAlignmentManagerBatch()
+		{
+			FAlignmentManager::Get()->ClearAlignmentAnchors();
+			AddScatteredPins(64);
+			FAlignmentManager::Get()->SendAlignmentAnchors();
+
+			TArray<FVector> positions = MakeAlignmentGrid(100);
+
+			TArray<FTransform> expected;
+			for (const FVector& pos : positions)
+			{
+				FAlignmentManager::Get()->ComputePinnedPose(FTransform(FQuat::Identity, pos));
+				expected.Add(FAlignmentManager::Get()->PinnedFromLocked);
+			}
+
+			TArray<FTransform> batched;
+			batched.SetNumUninitialized(positions.Num());
+			FAlignmentManager::Get()->ComputePinnedPoses(positions, batched);
+
+			TArray<FTransform> parallel;
+			parallel.SetNumUninitialized(positions.Num());
+			FAlignmentManager::Get()->ComputePinnedPoses(positions, parallel, 256);
+
+			bool succeeded = true;
+			for (int i = 0; i < positions.Num(); ++i)
+			{
+				succeeded &= batched[i].Equals(expected[i], 1.0e-3f);
+				succeeded &= parallel[i].Equals(expected[i], 1.0e-3f);
+			}
+
+			FAlignmentManager::Get()->ClearAlignmentAnchors();
+			FAlignmentManager::Get()->SendAlignmentAnchors();
+			return succeeded;
+		}
+
+		bool RunTestPerfAlignmentBatch()
+		{
+			FAlignmentManager* alignmentManager = FAlignmentManager::Get();
+			alignmentManager->ClearAlignmentAnchors();
+			AddScatteredPins(64);
+			alignmentManager->SendAlignmentAnchors();
+
+			bool succeeded = true;
+			for (int gridSize : { 10, 100 })
+			{
+				TArray<FVector> positions = MakeAlignmentGrid(gridSize);
+				TArray<FTransform> poses;
+				poses.SetNumUninitialized(positions.Num());
+
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (int i = 0; i < positions.Num(); ++i)
+					{
+						alignmentManager->ComputePinnedPose(FTransform(FQuat::Identity, positions[i]));
+						poses[i] = alignmentManager->PinnedFromLocked;
+					}
+				});
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Single"), positions.Num(), measured);
+
+				measured = MeasurePerf([&]()
+				{
+					alignmentManager->ComputePinnedPoses(positions, poses);
+				});
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Batch"), positions.Num(), measured);
+
+				// Allocations on the worker threads aren't counted.
+				measured = MeasurePerf([&]()
+				{
+					alignmentManager->ComputePinnedPoses(positions, poses, 256);
+				});
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Parallel"), positions.Num(), measured);
+			}
+
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			return succeeded;
+		}
+
+		bool RunTestAlignmentManagerPool()
+		{
+			FAlignmentManager* alignmentManager = FAlignmentManager::Get();
+			alignmentManager->ClearAlignmentAnchors();
+
+			// Hundreds of pins on a grid, as across a facility, each locked at twice its virtual position.
+			const int gridSize = 20;
+			TArray<FrozenWorld_AnchorId> anchorIds;
+			TArray<FVector> virtualPositions;
+			TArray<FVector> lockedPositions;
+			for (int y = 0; y < gridSize; ++y)
+			{
+				for (int x = 0; x < gridSize; ++x)
+				{
+					FVector virtualPos(x * 100.0f, y * 100.0f, 0);
+					virtualPositions.Add(virtualPos);
+					lockedPositions.Add(virtualPos * 2.0f);
+					anchorIds.Add(alignmentManager->AddAlignmentAnchor(FString::Printf(TEXT("poolPin%d"), anchorIds.Num()),
+						FTransform(FQuat::Identity, virtualPos), FTransform(FQuat::Identity, virtualPos * 2.0f)));
+				}
+			}
+			alignmentManager->SendAlignmentAnchors();
+
+			bool succeeded = CheckAlignment(virtualPositions[1], lockedPositions[1]);
+
+			// Pins removed keep aligning until the next send.
+			for (int i = 1; i < anchorIds.Num(); i += 2)
+			{
+				succeeded &= alignmentManager->RemoveAlignmentAnchor(anchorIds[i]);
+			}
+			succeeded &= !alignmentManager->RemoveAlignmentAnchor(anchorIds[1]);
+			succeeded &= CheckAlignment(virtualPositions[1], lockedPositions[1]);
+
+			for (int i = 0; i < anchorIds.Num(); ++i)
+			{
+				FTransform lockedPose;
+				bool found = alignmentManager->GetAlignmentPose(anchorIds[i], lockedPose);
+				succeeded &= found == (i % 2 == 0);
+				succeeded &= !found || lockedPose.GetLocation() == lockedPositions[i];
+			}
+
+			alignmentManager->SendAlignmentAnchors();
+			for (int i = 0; i < anchorIds.Num(); i += 2)
+			{
+				succeeded &= CheckAlignment(virtualPositions[i], lockedPositions[i]);
+			}
+
+			// Restoring by name keeps the anchor id of the pin it replaces, and removed pins are forgotten.
+			succeeded &= alignmentManager->RestoreAlignmentAnchor(TEXT("poolPin0"), FTransform::Identity) == anchorIds[0];
+			succeeded &= alignmentManager->RestoreAlignmentAnchor(TEXT("poolPin1"), FTransform::Identity) == FrozenWorld_AnchorId_INVALID;
+
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			return succeeded;
+		}
+
+		bool RunTestPerfAlignmentManagerPool()
+		{
+			FAlignmentManager* alignmentManager = FAlignmentManager::Get();
+
+			bool succeeded = true;
+			for (int gridSize : { 10, 20, 50 })
+			{
+				alignmentManager->ClearAlignmentAnchors();
+				alignmentManager->SendAlignmentAnchors();
+
+				int numPins = gridSize * gridSize;
+				TArray<FrozenWorld_AnchorId> anchorIds;
+				anchorIds.Reserve(numPins);
+				// Named up front, so the measurement doesn't include formatting the names.
+				TArray<FString> names;
+				for (int i = 0; i < numPins; ++i)
+				{
+					names.Add(FString::Printf(TEXT("poolPin%d"), i));
+				}
+
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (int i = 0; i < numPins; ++i)
+					{
+						FTransform pose(FQuat::Identity, FVector(i % gridSize * 100.0f, i / gridSize * 100.0f, 0));
+						anchorIds.Add(alignmentManager->AddAlignmentAnchor(MoveTemp(names[i]), pose, pose));
+					}
+				});
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Pool.Add"), numPins, measured);
+
+				measured = MeasurePerf([&]()
+				{
+					for (const auto& anchorId : anchorIds)
+					{
+						FTransform lockedPose;
+						succeeded &= alignmentManager->GetAlignmentPose(anchorId, lockedPose);
+					}
+				});
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Pool.LookUp"), numPins, measured);
+
+				measured = MeasurePerf([&]()
+				{
+					for (int i = 1; i < anchorIds.Num(); i += 2)
+					{
+						succeeded &= alignmentManager->RemoveAlignmentAnchor(anchorIds[i]);
+					}
+				});
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Pool.Remove"), numPins, measured);
+			}
+
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			return succeeded;
+		}
+
+		bool RunTestAlignmentManagerLevels()
+		{
+			FAlignmentManager* alignmentManager = FAlignmentManager::Get();
+			alignmentManager->ClearAlignmentAnchors();
+			float previousSeparation = alignmentManager->GetAlignmentLevelSeparation();
+			float previousBlendHeight = alignmentManager->GetAlignmentLevelBlendHeight();
+			alignmentManager->SetAlignmentLevels(200.0f, 100.0f);
+
+			// Two floors 400 apart, whose pins disagree on where the model is by 20 along X.
+			for (int floor = 0; floor < 2; ++floor)
+			{
+				for (int y = 0; y < 3; ++y)
+				{
+					for (int x = 0; x < 3; ++x)
+					{
+						FVector lockedPos(x * 500.0f + floor * 50.0f, y * 500.0f + floor * 50.0f, floor * 400.0f);
+						FVector virtualPos = lockedPos + FVector(floor == 0 ? 10.0f : -10.0f, 0, 0);
+						alignmentManager->AddAlignmentAnchor(FString::Printf(TEXT("levelPin%d_%d_%d"), floor, x, y),
+							FTransform(FQuat::Identity, virtualPos), FTransform(FQuat::Identity, lockedPos));
+					}
+				}
+			}
+			alignmentManager->SendAlignmentAnchors();
+
+			auto pinnedFromLocked = [alignmentManager](float height)
+			{
+				alignmentManager->ComputePinnedPose(FTransform(FQuat::Identity, FVector(525.0f, 525.0f, height)));
+				return alignmentManager->PinnedFromLocked.GetLocation();
+			};
+			FVector lowerFloor = pinnedFromLocked(0.0f);
+			FVector upperFloor = pinnedFromLocked(400.0f);
+
+			// Each floor aligns by its own pins only, up to the band around the boundary halfway between them.
+			bool succeeded = !lowerFloor.Equals(upperFloor, 1.0f);
+			succeeded &= pinnedFromLocked(140.0f).Equals(lowerFloor, 1.0e-3f);
+			succeeded &= pinnedFromLocked(260.0f).Equals(upperFloor, 1.0e-3f);
+			succeeded &= pinnedFromLocked(600.0f).Equals(upperFloor, 1.0e-3f);
+			succeeded &= pinnedFromLocked(160.0f).Equals(FMath::Lerp(lowerFloor, upperFloor, 0.1f), 1.0e-3f);
+			succeeded &= pinnedFromLocked(200.0f).Equals(FMath::Lerp(lowerFloor, upperFloor, 0.5f), 1.0e-3f);
+			succeeded &= pinnedFromLocked(230.0f).Equals(FMath::Lerp(lowerFloor, upperFloor, 0.8f), 1.0e-3f);
+
+			TArray<FVector> positions = { FVector(525.0f, 525.0f, 0.0f), FVector(525.0f, 525.0f, 200.0f), FVector(525.0f, 525.0f, 400.0f) };
+			TArray<FTransform> batched;
+			batched.SetNumUninitialized(positions.Num());
+			alignmentManager->ComputePinnedPoses(positions, batched);
+			succeeded &= batched[0].GetLocation().Equals(lowerFloor, 1.0e-3f);
+			succeeded &= batched[1].GetLocation().Equals(pinnedFromLocked(200.0f), 1.0e-3f);
+			succeeded &= batched[2].GetLocation().Equals(upperFloor, 1.0e-3f);
+
+			alignmentManager->SetAlignmentLevels(previousSeparation, previousBlendHeight);
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			return succeeded;
+		}
+
+		bool RunTestAlignmentManagerTransaction()
+		{
+			FAlignmentManager* alignmentManager = FAlignmentManager::Get();
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			alignmentManager->ComputePinnedPose(FTransform::Identity);
+
+			// Nothing takes effect until the outermost transaction is committed.
+			const int numPins = 50;
+			alignmentManager->BeginTransaction();
+			alignmentManager->BeginTransaction();
+			SetCalibrationPins(numPins);
+			bool succeeded = alignmentManager->PinnedFromLocked.Equals(FTransform::Identity);
+			alignmentManager->CommitTransaction();
+			alignmentManager->ComputePinnedPose(FTransform(FQuat::Identity, CalibrationLockedPosition(0)));
+			succeeded &= alignmentManager->PinnedFromLocked.Equals(FTransform::Identity);
+			alignmentManager->CommitTransaction();
+			for (int pin = 0; pin < numPins; ++pin)
+			{
+				succeeded &= CheckAlignment(CalibrationVirtualPosition(pin), CalibrationLockedPosition(pin));
+			}
+
+			// A scoped transaction commits as it goes out of scope.
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			alignmentManager->ComputePinnedPose(FTransform::Identity);
+			{
+				FScopedAlignmentTransaction transaction(alignmentManager);
+				SetCalibrationPins(numPins);
+				succeeded &= alignmentManager->PinnedFromLocked.Equals(FTransform::Identity);
+			}
+			for (int pin = 0; pin < numPins; ++pin)
+			{
+				succeeded &= CheckAlignment(CalibrationVirtualPosition(pin), CalibrationLockedPosition(pin));
+			}
+
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			return succeeded;
+		}
+
+		bool RunTestPerfAlignmentManagerTransaction()
+		{
+			FAlignmentManager* alignmentManager = FAlignmentManager::Get();
+
+			bool succeeded = true;
+			for (int numPins : { 10, 50 })
+			{
+				alignmentManager->ClearAlignmentAnchors();
+				alignmentManager->SendAlignmentAnchors();
+
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					SetCalibrationPins(numPins);
+				});
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Transaction.SentEach"), numPins, measured);
+
+				alignmentManager->ClearAlignmentAnchors();
+				alignmentManager->SendAlignmentAnchors();
+
+				measured = MeasurePerf([&]()
+				{
+					FScopedAlignmentTransaction transaction(alignmentManager);
+					SetCalibrationPins(numPins);
+				});
+				succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Transaction.Committed"), numPins, measured);
+			}
+
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			return succeeded;
+		}
+
+		bool RunTestAlignmentManagerRefit()
+		{
+			FAlignmentManager* alignmentManager = FAlignmentManager::Get();
+			alignmentManager->ClearAlignmentAnchors();
+
+			const FTransform virtualPose(FQuat::Identity, FVector(12365.0f, -6789.0f, 0));
+			const FTransform lockedPose(FQuat::Identity, FVector(12345.0f, -6789.0f, 0));
+			FrozenWorld_AnchorId anchorId = alignmentManager->AddAlignmentAnchor(TEXT("refitPin"), virtualPose, lockedPose);
+			alignmentManager->SendAlignmentAnchors();
+			alignmentManager->ComputePinnedPose(lockedPose);
+			bool succeeded = alignmentManager->PinnedFromLocked.Equals(
+				FFrozenWorldPoseExtensions::Multiply(virtualPose, FFrozenWorldPoseExtensions::Inverse(lockedPose)));
+
+			// A refit adjusts the pin's locked pose through its attachment point, without the pins being sent again.
+			FFragmentManager* fragmentManager = FFragmentManager::Get();
+			FAttachmentPointHandle handle = fragmentManager->FindNearestAttachmentPoint(lockedPose.GetLocation(), 1.0f);
+			const FAttachmentPoint* attachmentPoint = fragmentManager->GetAttachmentPoint(handle);
+			succeeded &= attachmentPoint != nullptr;
+			if (attachmentPoint != nullptr)
+			{
+				FAttachmentPoint::FAdjustLocationDelegate handler = attachmentPoint->LocationHandler;
+				handler.ExecuteIfBound(FTransform(FQuat(FVector::UpVector, PI / 2), FVector(0, 0, 10)));
+			}
+
+			FTransform movedPose;
+			succeeded &= alignmentManager->GetAlignmentPose(anchorId, movedPose) && !movedPose.Equals(lockedPose);
+			alignmentManager->ComputePinnedPose(movedPose);
+			succeeded &= alignmentManager->PinnedFromLocked.Equals(
+				FFrozenWorldPoseExtensions::Multiply(virtualPose, FFrozenWorldPoseExtensions::Inverse(movedPose)));
+
+			alignmentManager->ClearAlignmentAnchors();
+			alignmentManager->SendAlignmentAnchors();
+			return succeeded;
+		}
+
+		bool RunTestPoseAveraging()
+		{
+			// The pairwise Slerp the alignment manager blended pinned poses with before, as the reference.
+			auto pairwiseAverage = [](const FQuat* rotations, const float* weights)
+			{
+				FQuat last = FQuat::Slerp(rotations[1], rotations[2], weights[2] / (weights[1] + weights[2]));
+				return FQuat::Slerp(rotations[0], last, weights[1] + weights[2]).GetNormalized();
+			};
+			// The weighted sum of squared dot products, which the eigen average maximizes.
+			auto agreement = [](const FQuat& average, const FQuat* rotations, const float* weights)
+			{
+				double sum = 0;
+				for (int i = 0; i < 3; ++i)
+				{
+					double dot = average | rotations[i];
+					sum += weights[i] * dot * dot;
+				}
+				return sum;
+			};
+
+			FRandomStream random(47);
+			bool succeeded = true;
+			double maxSumError = 0;
+			double maxEigenError = 0;
+			for (int trial = 0; trial < 1000; ++trial)
+			{
+				FQuat base(FVector::UpVector, random.FRandRange(-PI, PI));
+				FQuat rotations[3];
+				FVector positions[3];
+				float weights[3];
+				float totalWeight = 0;
+				for (int i = 0; i < 3; ++i)
+				{
+					rotations[i] = FQuat(random.GetUnitVector(), random.FRandRange(-0.15f, 0.15f)) * base;
+					positions[i] = random.GetUnitVector() * random.FRandRange(0.0f, 1000.0f);
+					weights[i] = random.FRandRange(0.01f, 1.0f);
+					totalWeight += weights[i];
+				}
+				for (int i = 0; i < 3; ++i)
+				{
+					weights[i] /= totalWeight;
+				}
+
+				FQuat expected = pairwiseAverage(rotations, weights);
+				FQuat sum = FPoseAveraging::AverageRotations(MakeArrayView(rotations), MakeArrayView(weights));
+				FQuat eigen = FPoseAveraging::AverageRotationsEigen(MakeArrayView(rotations), MakeArrayView(weights));
+				maxSumError = FMath::Max(maxSumError, (double)sum.AngularDistance(expected));
+				maxEigenError = FMath::Max(maxEigenError, (double)eigen.AngularDistance(expected));
+				succeeded &= agreement(eigen, rotations, weights) >= agreement(sum, rotations, weights) - 1.0e-12;
+				succeeded &= agreement(eigen, rotations, weights) >= agreement(expected, rotations, weights) - 1.0e-12;
+
+				FVector expectedPosition = FMath::Lerp(positions[0],
+					FMath::Lerp(positions[1], positions[2], weights[2] / (weights[1] + weights[2])), weights[1] + weights[2]);
+				succeeded &= FPoseAveraging::AveragePositions(MakeArrayView(positions), MakeArrayView(weights)).Equals(expectedPosition, 1.0e-3);
+
+				// Neither the order of the rotations nor their signs may matter.
+				FQuat reordered[3] = { rotations[2], rotations[0], rotations[1] * -1.0 };
+				float reorderedWeights[3] = { weights[2], weights[0], weights[1] };
+				succeeded &= FPoseAveraging::AverageRotations(MakeArrayView(reordered), MakeArrayView(reorderedWeights)).AngularDistance(sum) < 1.0e-6;
+				succeeded &= FPoseAveraging::AverageRotationsEigen(MakeArrayView(reordered), MakeArrayView(reorderedWeights)).AngularDistance(eigen) < 1.0e-6;
+			}
+			UE_LOG(LogTemp, Log, TEXT("Largest difference from pairwise Slerp %f radians normalizing the sum, %f radians by eigenvector"),
+				maxSumError, maxEigenError);
+			succeeded &= maxSumError < 1.0e-3;
+			succeeded &= maxEigenError < 1.0e-3;
+
+			FQuat sameRotations[3] = { FQuat(FVector::ForwardVector, 0.5f), FQuat(FVector::ForwardVector, 0.5f), FQuat(FVector::ForwardVector, 0.5f) };
+			float sameWeights[3] = { 0.2f, 0.3f, 0.5f };
+			succeeded &= FPoseAveraging::AverageRotationsEigen(MakeArrayView(sameRotations), MakeArrayView(sameWeights)).Equals(sameRotations[0], 1.0e-6f);
+			float zeroWeights[3] = { 0.0f, 0.0f, 0.0f };
+			succeeded &= FPoseAveraging::AverageRotations(MakeArrayView(sameRotations), MakeArrayView(zeroWeights)).Equals(FQuat::Identity);
+
+			return succeeded;
+		}
+
+		bool RunTestPerfPoseAveraging()
+		{
+			// Blends of three, as for every alignment lookup.
+			const int numBlends = 100000;
+			FQuat rotations[3] = { FQuat(FVector::UpVector, 0.1f), FQuat(FVector::RightVector, 0.05f), FQuat(FVector::ForwardVector, -0.1f) };
+			float weights[3] = { 0.2f, 0.3f, 0.5f };
+
+			// Summed up, so the averages can't be optimized away.
+			double checksum = 0;
+			FPerfMeasurement measured = MeasurePerf([&]()
+			{
+				for (int i = 0; i < numBlends; ++i)
+				{
+					weights[0] = 0.2f + i * 1.0e-7f;
+					checksum += FPoseAveraging::AverageRotations(MakeArrayView(rotations), MakeArrayView(weights)).W;
+				}
+			});
+			bool succeeded = CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Averaging.Sum"), numBlends, measured);
+
+			measured = MeasurePerf([&]()
+			{
+				for (int i = 0; i < numBlends; ++i)
+				{
+					weights[0] = 0.2f + i * 1.0e-7f;
+					checksum += FPoseAveraging::AverageRotationsEigen(MakeArrayView(rotations), MakeArrayView(weights)).W;
+				}
+			});
+			succeeded &= CheckPerfBaseline(TEXT("WLT.Perf.Alignment.Averaging.Eigen"), numBlends, measured);
+
+			succeeded &= FMath::IsFinite(checksum);
+			return succeeded;
+		}
+
+		bool RunTestAnchorRegionStore()
+		{
+			// Keep clear of the regions of real sessions, which Discard would delete.
+			FString directory = FPaths::AutomationTransientDir() / TEXT("AnchorRegions");
+			FAnchorRegionStore store(directory);
+			store.Discard();
+
+			FIntVector cell(-1, 0, 2);
+			FAnchorRegion first;
+			first.anchors.Add(FrozenWorld_Anchor{ MakeAnchorId(0), 1, FFrozenWorldInterop::UtoF(FTransform(FVector(-100, 0, 200))) });
+			first.anchors.Add(FrozenWorld_Anchor{ MakeAnchorId(1), 1, FFrozenWorldInterop::UtoF(FTransform(FVector(-150, 50, 250))) });
+			first.edges.Add(FrozenWorld_Edge{ MakeAnchorId(0), MakeAnchorId(1) });
+
+			FAnchorRegion second;
+			second.anchors.Add(FrozenWorld_Anchor{ MakeAnchorId(7), 2, FFrozenWorldInterop::UtoF(FTransform(FVector(-120, 10, 210))) });
+			second.edges.Add(FrozenWorld_Edge{ MakeAnchorId(1), MakeAnchorId(7) });
+
+			bool testPassed = store.Write(cell, first) && store.Write(cell, second);
+
+			// A fresh store finds the region and the largest id on disk.
+			FAnchorRegionStore reopened(directory);
+			reopened.Scan();
+			testPassed &= reopened.Contains(cell) && reopened.GetStoredCells().Num() == 1;
+			testPassed &= reopened.GetMaxAnchorId() == MakeAnchorId(7);
+
+			FAnchorRegion taken;
+			testPassed &= reopened.Take(cell, taken);
+			testPassed &= taken.anchors.Num() == 3 && taken.edges.Num() == 2;
+			testPassed &= taken.anchors[2].anchorId == MakeAnchorId(7) && taken.anchors[2].fragmentId == 2;
+			testPassed &= FFrozenWorldInterop::FtoU(taken.anchors[1].transform.position).Equals(FVector(-150, 50, 250), 0.01f);
+			testPassed &= !reopened.Contains(cell) && !reopened.Take(cell, taken);
+
+			store.Discard();
+			return testPassed;
+		}
+
+		bool RunTestFragmentMergeBenchmark()
+		{
+			const int numFragments = 100;
+			const int attachmentPointsPerFragment = 100;
+
+			FAttachmentPointPool pool;
+			TArray<FFragment> fragments;
+			TArray<FAttachmentPointHandle> attachmentPoints;
+			for (int i = 0; i < numFragments; ++i)
+			{
+				FFragment& fragment = fragments.Emplace_GetRef(FrozenWorld_FragmentId(i + 1), pool);
+				fragment.State = AttachmentPointStateType::Unconnected;
+				for (int j = 0; j < attachmentPointsPerFragment; ++j)
+				{
+					FAttachmentPointHandle handle = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate());
+					FAttachmentPoint* attachmentPoint = pool.Get(handle);
+					attachmentPoint->Set(fragment.FragmentId, FVector(i, j, 0), MakeAnchorId(i), FVector::ZeroVector);
+					attachmentPoint->ObjectPosition = FVector(i, j, 0);
+					attachmentPoint->ObjectAdjustment = FTransform::Identity;
+					fragment.AddAttachmentPoint(handle);
+					attachmentPoints.Add(handle);
+				}
+			}
+			fragments[0].State = AttachmentPointStateType::Normal;
+
+			FTransform adjustment(FVector(0, 0, 10));
+			FPerfMeasurement measured = MeasurePerf([&]()
+			{
+				for (int i = 1; i < numFragments; ++i)
+				{
+					fragments[0].AbsorbOtherFragment(MoveTemp(fragments[i]), adjustment);
+				}
+			});
+
+			bool testPassed = CheckPerfBaseline(TEXT("WLT.Perf.FragmentMerge"), attachmentPoints.Num(), measured);
+			testPassed &= fragments[0].NumAttachmentPoints() == numFragments * attachmentPointsPerFragment;
+			for (int i = 1; i < numFragments; ++i)
+			{
+				testPassed &= fragments[i].NumAttachmentPoints() == 0;
+			}
+			for (const auto& handle : attachmentPoints)
+			{
+				const FAttachmentPoint* attachmentPoint = pool.Get(handle);
+				testPassed &= attachmentPoint->FragmentId == fragments[0].FragmentId;
+				testPassed &= attachmentPoint->State == AttachmentPointStateType::Normal;
+			}
+			// Only absorbed attachment points are adjusted.
+			testPassed &= pool.Get(attachmentPoints[0])->ObjectPosition.Z == 0;
+			testPassed &= pool.Get(attachmentPoints.Last())->ObjectPosition.Z == 10;
+
+			// Releasing from the merged fragment keeps the others reachable.
+			fragments[0].ReleaseAttachmentPoint(attachmentPoints[0]);
+			pool.Release(attachmentPoints[0]);
+			testPassed &= fragments[0].NumAttachmentPoints() == numFragments * attachmentPointsPerFragment - 1;
+			testPassed &= pool.Get(attachmentPoints.Last())->FragmentIndex != INDEX_NONE;
+
+			return testPassed;
+		}
+
+		bool RunTestAttachmentPointBatchListener()
+		{
+			const int numAttachmentPoints = 1000;
+
+			FAttachmentPointPool pool;
+			FFragment target(FrozenWorld_FragmentId(1), pool);
+			FFragment source(FrozenWorld_FragmentId(2), pool);
+			target.State = AttachmentPointStateType::Normal;
+			source.State = AttachmentPointStateType::Unconnected;
+
+			FCountingBatchListener listener;
+			for (int i = 0; i < numAttachmentPoints; ++i)
+			{
+				FAttachmentPointHandle handle = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate());
+				pool.Get(handle)->BatchListener = &listener;
+				source.AddAttachmentPoint(handle);
+			}
+			listener.Dispatch();
+
+			bool testPassed = listener.NumBatches == 1 && listener.LastBatch.Num() == numAttachmentPoints;
+
+			// A merge both adjusts and reconnects each attachment point, which is reported as a single update per attachment point.
+			FTransform adjustment(FVector(0, 0, 10));
+			target.AbsorbOtherFragment(MoveTemp(source), adjustment);
+			listener.Dispatch();
+
+			testPassed &= listener.NumBatches == 2 && listener.LastBatch.Num() == numAttachmentPoints;
+			for (const auto& update : listener.LastBatch)
+			{
+				testPassed &= pool.Contains(update.handle);
+				testPassed &= update.state == AttachmentPointStateType::Normal;
+				testPassed &= update.adjustment.GetLocation().Equals(FVector(0, 0, 10));
+			}
+
+			// Nothing happened since, so there is no call.
+			listener.Dispatch();
+			testPassed &= listener.NumBatches == 2;
+
+			// A listener going away unregisters itself, and its attachment points stop reporting to it.
+			FFragmentManager* fragmentManager = FFragmentManager::Get();
+			TUniquePtr<FCountingBatchListener> registered = MakeUnique<FCountingBatchListener>();
+			FAttachmentPointHandle handle = fragmentManager->CreateAttachmentPoint(FVector::ZeroVector, FAttachmentPointHandle(),
+				FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate(), registered.Get());
+			registered.Reset();
+			const FAttachmentPoint* attachmentPoint = fragmentManager->GetAttachmentPoint(handle);
+			testPassed &= attachmentPoint != nullptr && attachmentPoint->BatchListener == nullptr;
+			fragmentManager->ReleaseAttachmentPoint(handle);
+
+			return testPassed;
+		}
+
+		bool RunTestAttachmentPointChanges()
+		{
+			FAttachmentPointPool pool;
+			FFragment target(FrozenWorld_FragmentId(1), pool);
+			FFragment source(FrozenWorld_FragmentId(2), pool);
+			target.State = AttachmentPointStateType::Normal;
+			source.State = AttachmentPointStateType::Normal;
+
+			TArray<FAttachmentPointHandle> handles;
+			for (int i = 0; i < 4; ++i)
+			{
+				FAttachmentPointHandle handle = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate());
+				pool.Get(handle)->ObjectPosition = FVector(i * 100, 0, 0);
+				(i < 2 ? target : source).AddAttachmentPoint(handle);
+				handles.Add(handle);
+			}
+
+			TArray<AttachmentPointChange> changes;
+			uint64 epoch = pool.GetChangesSince(0, handles, changes);
+			bool testPassed = changes.Num() == 4;
+
+			// Nothing changed since.
+			changes.Reset();
+			testPassed &= pool.GetChangesSince(epoch, handles, changes) == epoch && changes.Num() == 0;
+
+			// Two adjustments accumulate, and only the absorbed attachment points report a change.
+			target.AbsorbOtherFragment(MoveTemp(source), FTransform(FQuat(FVector::UpVector, PI / 2)));
+			pool.Get(handles[3])->HandlePoseAdjustment(FTransform(FVector(0, 0, 10)));
+			pool.Release(handles[0]);
+
+			changes.Reset();
+			uint64 nextEpoch = pool.GetChangesSince(epoch, handles, changes);
+			testPassed &= nextEpoch > epoch && changes.Num() == 3;
+			testPassed &= changes[0].handle == handles[0] && changes[0].state == AttachmentPointStateType::Released;
+			testPassed &= changes[1].handle == handles[2] && changes[1].position.Equals(FVector(0, 200, 0), 0.01f);
+			testPassed &= changes[2].handle == handles[3] && changes[2].position.Equals(FVector(0, 300, 10), 0.01f);
+			testPassed &= FFrozenWorldPoseExtensions::Multiply(changes[2].adjustment, FVector(300, 0, 0)).Equals(changes[2].position, 0.01f);
+
+			return testPassed;
+		}
+
+		bool RunTestDeferredAdjustments()
+		{
+			const int numAbsorbed = 64;
+
+			FAttachmentPointPool pool;
+			TMap<FrozenWorld_FragmentId, TSharedPtr<FFragment>> fragments;
+			TSharedPtr<FFragment> target = MakeShared<FFragment>(FrozenWorld_FragmentId(1), pool);
+			TSharedPtr<FFragment> source = MakeShared<FFragment>(FrozenWorld_FragmentId(2), pool);
+			target->State = AttachmentPointStateType::Unconnected;
+			source->State = AttachmentPointStateType::Unconnected;
+			fragments.Add(target->FragmentId, target);
+			fragments.Add(source->FragmentId, source);
+
+			// The absorbed attachment points, scattered in front of and behind the head, followed by one of the target's own.
+			TArray<int> notifications;
+			notifications.SetNumZeroed(numAbsorbed + 1);
+			TArray<FAttachmentPointHandle> handles;
+			for (int i = 0; i <= numAbsorbed; ++i)
+			{
+				FAttachmentPointHandle handle = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(),
+					FAttachmentPoint::FAdjustStateDelegate::CreateLambda([&notifications, i](AttachmentPointStateType state)
+					{
+						++notifications[i];
+					}));
+				float distance = 50.0f + 37.0f * (i * 7 % numAbsorbed);
+				pool.Get(handle)->ObjectPosition = FVector(i % 3 == 0 ? -distance : distance, 0, 0);
+				(i < numAbsorbed ? *source : *target).AddAttachmentPoint(handle);
+				handles.Add(handle);
+			}
+
+			FDeferredAdjustments deferred(pool, fragments);
+			target->AbsorbOtherFragment(MoveTemp(*source), FTransform(FVector(0, 0, 10)), deferred.Begin());
+			fragments.Remove(source->FragmentId);
+
+			// The merged fragment becomes current, as FFragmentManager::ApplyActiveCurrentFragment does right after a merge.
+			// Only the target's own attachment point is connected, the absorbed ones wait for their adjustment.
+			target->UpdateState(AttachmentPointStateType::Normal);
+
+			bool testPassed = deferred.Num() == numAbsorbed;
+			testPassed &= pool.Get(handles.Last())->State == AttachmentPointStateType::Normal && notifications.Last() == 2;
+			for (int i = 0; i < numAbsorbed; ++i)
+			{
+				const FAttachmentPoint* attachmentPoint = pool.Get(handles[i]);
+				testPassed &= attachmentPoint->AdjustmentDeferred && attachmentPoint->State == AttachmentPointStateType::Unconnected;
+				testPassed &= attachmentPoint->ObjectPosition.Z == 0 && notifications[i] == 1;
+			}
+
+			// Out of time right away, so only the first few adjustments are applied, those nearest in front of the head.
+			FTransform lockedHead = FTransform::Identity;
+			deferred.Prioritize(lockedHead);
+			TArray<FAttachmentPointHandle> applied;
+			deferred.Apply(0.001f, [&applied](FAttachmentPointHandle handle)
+			{
+				applied.Add(handle);
+			});
+			testPassed &= applied.Num() > 0 && applied.Num() < numAbsorbed && deferred.Num() == numAbsorbed - applied.Num();
+
+			float lastPriority = 0.0f;
+			for (const auto& handle : applied)
+			{
+				const FAttachmentPoint* attachmentPoint = pool.Get(handle);
+				float priority = FFragmentManager::GetPriority(attachmentPoint->ObjectPosition - FVector(0, 0, 10), lockedHead);
+				testPassed &= priority >= lastPriority;
+				lastPriority = priority;
+			}
+			for (int i = 0; i < numAbsorbed; ++i)
+			{
+				const FAttachmentPoint* attachmentPoint = pool.Get(handles[i]);
+				if (applied.Contains(handles[i]))
+				{
+					testPassed &= !attachmentPoint->AdjustmentDeferred && attachmentPoint->State == AttachmentPointStateType::Normal;
+					testPassed &= FMath::IsNearlyEqual(attachmentPoint->ObjectPosition.Z, 10.0) && notifications[i] == 2;
+				}
+				else
+				{
+					testPassed &= attachmentPoint->State == AttachmentPointStateType::Unconnected && attachmentPoint->ObjectPosition.Z == 0;
+					testPassed &= FFragmentManager::GetPriority(attachmentPoint->ObjectPosition, lockedHead) >= lastPriority;
+				}
+			}
+
+			// Behind the head counts as twice as far.
+			testPassed &= FFragmentManager::GetPriority(FVector(-60, 0, 0), lockedHead) > FFragmentManager::GetPriority(FVector(100, 0, 0), lockedHead);
+
+			// Without a budget the rest is applied, and each attachment point is told of its new state once.
+			deferred.Apply(0, [&applied](FAttachmentPointHandle handle)
+			{
+				applied.Add(handle);
+			});
+			testPassed &= deferred.Num() == 0 && applied.Num() == numAbsorbed;
+			for (int i = 0; i < numAbsorbed; ++i)
+			{
+				const FAttachmentPoint* attachmentPoint = pool.Get(handles[i]);
+				testPassed &= !attachmentPoint->AdjustmentDeferred && attachmentPoint->State == AttachmentPointStateType::Normal;
+				testPassed &= FMath::IsNearlyEqual(attachmentPoint->ObjectPosition.Z, 10.0) && notifications[i] == 2;
+			}
+
+			return testPassed;
+		}
+
+		bool RunTestPendingAttachmentPointPriority()
+		{
+			// In order of submission. The head is at the origin looking along X.
+			TArray<FVector> positions = {
+				FVector(300, 0, 0),
+				FVector(-100, 0, 0),	// Behind the head, as far as 200 in front.
+				FVector(0, 250, 0),
+				FVector(300, 0, 0),		// Tied with the first, stays after it.
+				FVector(10, 0, 0),		// Released before being set up.
+				FVector(50, 0, 0)
+			};
+			TArray<int> expectedOrder = { 5, 1, 2, 0, 3, 4 };
+
+			FAttachmentPointPool pool;
+			TArray<FAttachmentPointHandle> handles;
+			TArray<PendingAttachmentPoint> pending;
+			for (const auto& position : positions)
+			{
+				FAttachmentPointHandle handle = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate());
+				pool.Get(handle)->ObjectPosition = position;
+				handles.Add(handle);
+				pending.Add(PendingAttachmentPoint{ handle, FAttachmentPointHandle(), 0.0, 0.0f });
+			}
+			pool.Release(handles[4]);
+
+			FFragmentManager::PrioritizePendingAttachmentPoints(pending, pool, FTransform::Identity);
+
+			bool testPassed = pending.Num() == expectedOrder.Num();
+			for (int i = 0; i < pending.Num(); ++i)
+			{
+				testPassed &= pending[i].target == handles[expectedOrder[i]];
+			}
+			return testPassed;
+		}
+
+		bool RunTestAttachmentPointPool()
+		{
+			const int numAttachmentPoints = 10000;
+
+			FAttachmentPointPool pool;
+			FFragment fragment(FrozenWorld_FragmentId(1), pool);
+			fragment.State = AttachmentPointStateType::Normal;
+
+			TArray<FAttachmentPointHandle> handles;
+			for (int i = 0; i < numAttachmentPoints; ++i)
+			{
+				FAttachmentPointHandle handle = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate());
+				pool.Get(handle)->ObjectPosition = FVector(i, 0, 0);
+				fragment.AddAttachmentPoint(handle);
+				handles.Add(handle);
+			}
+
+			bool testPassed = pool.Num() == numAttachmentPoints && fragment.NumAttachmentPoints() == numAttachmentPoints;
+			testPassed &= !pool.Contains(FAttachmentPointHandle());
+
+			// Release every other attachment point, front to back.
+			for (int i = 0; i < numAttachmentPoints; i += 2)
+			{
+				fragment.ReleaseAttachmentPoint(handles[i]);
+				testPassed &= pool.Release(handles[i]);
+			}
+
+			testPassed &= pool.Num() == numAttachmentPoints / 2 && fragment.NumAttachmentPoints() == numAttachmentPoints / 2;
+			for (int i = 0; i < numAttachmentPoints; ++i)
+			{
+				const FAttachmentPoint* attachmentPoint = pool.Get(handles[i]);
+				if (i % 2 == 0)
+				{
+					testPassed &= attachmentPoint == nullptr;
+				}
+				else
+				{
+					// Survivors moved in storage, but their handles still find them.
+					testPassed &= attachmentPoint != nullptr && attachmentPoint->ObjectPosition.X == i;
+				}
+			}
+
+			// A reused slot doesn't revive stale handles.
+			FAttachmentPointHandle reused = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate());
+			testPassed &= reused.Index == handles[numAttachmentPoints - 2].Index && reused != handles[numAttachmentPoints - 2];
+			testPassed &= pool.Get(handles[numAttachmentPoints - 2]) == nullptr && pool.Get(reused) != nullptr;
+			testPassed &= !pool.Release(handles[0]);
+
+			pool.Reset();
+			testPassed &= pool.Num() == 0 && pool.Get(reused) == nullptr && pool.Get(handles[1]) == nullptr;
+
+			return testPassed;
+		}
+
+		bool RunTestPerfAttachmentPointPool()
+		{
+			bool testPassed = true;
+			for (int numAttachmentPoints : perfSizes)
+			{
+				FAttachmentPointPool pool;
+				FFragment fragment(FrozenWorld_FragmentId(1), pool);
+				fragment.State = AttachmentPointStateType::Normal;
+
+				TArray<FAttachmentPointHandle> handles;
+				handles.Reserve(numAttachmentPoints);
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (int i = 0; i < numAttachmentPoints; ++i)
+					{
+						FAttachmentPointHandle handle = pool.Allocate(FAttachmentPoint::FAdjustLocationDelegate(), FAttachmentPoint::FAdjustStateDelegate());
+						fragment.AddAttachmentPoint(handle);
+						handles.Add(handle);
+					}
+				});
+				testPassed &= pool.Num() == numAttachmentPoints;
+				testPassed &= CheckPerfBaseline(TEXT("WLT.Perf.AttachmentPointPool.Create"), numAttachmentPoints, measured);
+
+				// Every other attachment point, front to back, which would be quadratic with a linear remove.
+				measured = MeasurePerf([&]()
+				{
+					for (int i = 0; i < numAttachmentPoints; i += 2)
+					{
+						fragment.ReleaseAttachmentPoint(handles[i]);
+						pool.Release(handles[i]);
+					}
+				});
+				testPassed &= pool.Num() == numAttachmentPoints / 2 && fragment.NumAttachmentPoints() == numAttachmentPoints / 2;
+				testPassed &= CheckPerfBaseline(TEXT("WLT.Perf.AttachmentPointPool.Release"), numAttachmentPoints, measured);
+			}
+			return testPassed;
+		}
+
+		bool RunTestAttachmentPointIndex()
+		{
+			const int numAttachmentPoints = 10000;
+			const int numQueries = 100;
+
+			FRandomStream random(39);
+			FAttachmentPointIndex index;
+			TMap<FAttachmentPointHandle, FVector> positions;
+			for (int i = 0; i < numAttachmentPoints; ++i)
+			{
+				FAttachmentPointHandle handle{ (uint32)i, 1 };
+				FVector position = random.GetUnitVector() * random.FRandRange(0.0f, 5000.0f);
+				index.Update(handle, position);
+				positions.Add(handle, position);
+			}
+
+			// Move some, drop some, and regrid, which must all keep the index in step.
+			for (int i = 0; i < numAttachmentPoints; i += 3)
+			{
+				FAttachmentPointHandle handle{ (uint32)i, 1 };
+				FVector position = positions[handle] + random.GetUnitVector() * 300.0f;
+				index.Update(handle, position);
+				positions[handle] = position;
+			}
+			for (int i = 1; i < numAttachmentPoints; i += 7)
+			{
+				FAttachmentPointHandle handle{ (uint32)i, 1 };
+				index.Remove(handle);
+				positions.Remove(handle);
+			}
+			index.SetCellSize(150.0f);
+
+			bool testPassed = index.Num() == positions.Num();
+
+			auto all = [](FAttachmentPointHandle) { return true; };
+			for (int q = 0; q < numQueries; ++q)
+			{
+				FVector center = random.GetUnitVector() * random.FRandRange(0.0f, 5000.0f);
+				float radius = random.FRandRange(50.0f, 600.0f);
+				FBox box = FBox::BuildAABB(center, FVector(radius, 0.5f * radius, 2.0f * radius));
+
+				TArray<FAttachmentPointHandle> inRadius;
+				TArray<FAttachmentPointHandle> inBox;
+				index.FindInRadius(center, radius, all, inRadius);
+				index.FindInBox(box, all, inBox);
+				FAttachmentPointHandle nearest = index.FindNearest(center, 0.0f, all);
+
+				int expectedInRadius = 0;
+				int expectedInBox = 0;
+				double nearestDistSqr = MAX_dbl;
+				for (const auto& entry : positions)
+				{
+					double distSqr = (entry.Value - center).SquaredLength();
+					expectedInRadius += distSqr <= (double)radius * radius ? 1 : 0;
+					expectedInBox += box.IsInsideOrOn(entry.Value) ? 1 : 0;
+					nearestDistSqr = FMath::Min(nearestDistSqr, distSqr);
+				}
+
+				testPassed &= inRadius.Num() == expectedInRadius && inBox.Num() == expectedInBox;
+				for (const auto& handle : inRadius)
+				{
+					testPassed &= (positions[handle] - center).SquaredLength() <= (double)radius * radius;
+				}
+				testPassed &= nearest.IsValid() && FMath::IsNearlyEqual((positions[nearest] - center).SquaredLength(), nearestDistSqr);
+			}
+
+			// A limited nearest search finds nothing beyond its limit.
+			testPassed &= !index.FindNearest(FVector(1.0e6f, 0, 0), 100.0f, all).IsValid();
+
+			return testPassed;
+		}
+
+		bool RunTestPerfAttachmentPointIndex()
+		{
+			const int numQueries = 100;
+
+			bool testPassed = true;
+			for (int numAttachmentPoints : perfSizes)
+			{
+				FRandomStream random(39);
+				TArray<FVector> positions;
+				positions.Reserve(numAttachmentPoints);
+				for (int i = 0; i < numAttachmentPoints; ++i)
+				{
+					positions.Add(random.GetUnitVector() * random.FRandRange(0.0f, 5000.0f));
+				}
+
+				FAttachmentPointIndex index;
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (int i = 0; i < numAttachmentPoints; ++i)
+					{
+						index.Update(FAttachmentPointHandle{ (uint32)i, 1 }, positions[i]);
+					}
+				});
+				testPassed &= index.Num() == numAttachmentPoints;
+				testPassed &= CheckPerfBaseline(TEXT("WLT.Perf.AttachmentPointIndex.Update"), numAttachmentPoints, measured);
+
+				// Query shapes picked up front, so the measurement only includes the queries.
+				TArray<FVector> centers;
+				TArray<float> radii;
+				for (int q = 0; q < numQueries; ++q)
+				{
+					centers.Add(random.GetUnitVector() * random.FRandRange(0.0f, 5000.0f));
+					radii.Add(random.FRandRange(50.0f, 600.0f));
+				}
+
+				auto all = [](FAttachmentPointHandle) { return true; };
+				TArray<FAttachmentPointHandle> found;
+				int numNearest = 0;
+				measured = MeasurePerf([&]()
+				{
+					for (int q = 0; q < numQueries; ++q)
+					{
+						found.Reset();
+						index.FindInRadius(centers[q], radii[q], all, found);
+						found.Reset();
+						index.FindInBox(FBox::BuildAABB(centers[q], FVector(radii[q], 0.5f * radii[q], 2.0f * radii[q])), all, found);
+						numNearest += index.FindNearest(centers[q], 0.0f, all).IsValid() ? 1 : 0;
+					}
+				});
+				testPassed &= numNearest == numQueries;
+				testPassed &= CheckPerfBaseline(TEXT("WLT.Perf.AttachmentPointIndex.Query"), numAttachmentPoints, measured);
+			}
+			return testPassed;
+		}
+
+		bool RunTestPerfFragmentsCreate()
+		{
+			bool testPassed = true;
+			for (int numAttachmentPoints : perfSizes)
+			{
+				FAttachmentPointPool pool;
+				TArray<FFragment> fragments;
+				TArray<FAttachmentPointHandle> handles;
+				CreatePerfFragments(pool, fragments);
+				handles.Reserve(numAttachmentPoints);
+
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					AddPerfAttachmentPoints(pool, fragments, numAttachmentPoints, handles);
+				});
+
+				testPassed &= pool.Num() == numAttachmentPoints;
+				testPassed &= fragments[0].NumAttachmentPoints() == numAttachmentPoints / perfNumFragments;
+				testPassed &= pool.Get(handles[0])->State == AttachmentPointStateType::Normal;
+				testPassed &= pool.Get(handles[1])->State == AttachmentPointStateType::Unconnected;
+				testPassed &= CheckPerfBaseline(TEXT("WLT.Perf.Fragments.Create"), numAttachmentPoints, measured);
+			}
+			return testPassed;
+		}
+
+		bool RunTestPerfFragmentsMerge()
+		{
+			bool testPassed = true;
+			for (int numAttachmentPoints : perfSizes)
+			{
+				FAttachmentPointPool pool;
+				TArray<FFragment> fragments;
+				TArray<FAttachmentPointHandle> handles;
+				CreatePerfFragments(pool, fragments);
+				AddPerfAttachmentPoints(pool, fragments, numAttachmentPoints, handles);
+
+				FTransform adjustment(FVector(0, 0, 10));
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (int i = 1; i < fragments.Num(); ++i)
+					{
+						fragments[0].AbsorbOtherFragment(MoveTemp(fragments[i]), adjustment);
+					}
+				});
+
+				testPassed &= fragments[0].NumAttachmentPoints() == numAttachmentPoints;
+				for (const auto& handle : handles)
+				{
+					const FAttachmentPoint* attachmentPoint = pool.Get(handle);
+					testPassed &= attachmentPoint->FragmentId == fragments[0].FragmentId && attachmentPoint->State == AttachmentPointStateType::Normal;
+				}
+				// Only absorbed attachment points are adjusted.
+				testPassed &= pool.Get(handles[0])->ObjectPosition.Z == 0 && pool.Get(handles[1])->ObjectPosition.Z == 10;
+				testPassed &= CheckPerfBaseline(TEXT("WLT.Perf.Fragments.Merge"), numAttachmentPoints, measured);
+			}
+			return testPassed;
+		}
+
+		bool RunTestPerfFragmentsRefreeze()
+		{
+			bool testPassed = true;
+			for (int numAttachmentPoints : perfSizes)
+			{
+				FAttachmentPointPool pool;
+				TArray<FFragment> fragments;
+				TArray<FAttachmentPointHandle> handles;
+				CreatePerfFragments(pool, fragments);
+				AddPerfAttachmentPoints(pool, fragments, numAttachmentPoints, handles);
+
+				FStandInEngine engine;
+				for (const auto& handle : handles)
+				{
+					FrozenWorld_AnchorId anchorId = pool.Get(handle)->AnchorId;
+					engine.corrections.Add(anchorId, FTransform(FRotator(0, anchorId % 7, 0), FVector(0, 0, anchorId % 5)));
+				}
+
+				// A refreeze absorbs all fragments without adjustment, then adjusts every attachment point individually.
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (int i = 1; i < fragments.Num(); ++i)
+					{
+						fragments[0].AbsorbOtherFragment(MoveTemp(fragments[i]));
+					}
+					fragments[0].AdjustAll([&engine](TArrayView<AttachmentPointAdjustment> adjustments)
+					{
+						engine.ComputeAdjustments(adjustments);
+					});
+				});
+
+				testPassed &= fragments[0].NumAttachmentPoints() == numAttachmentPoints;
+				for (int i = 0; i < handles.Num(); i += 97)
+				{
+					const FAttachmentPoint* attachmentPoint = pool.Get(handles[i]);
+					FVector expected = FFrozenWorldPoseExtensions::Multiply(engine.GetCorrection(attachmentPoint->AnchorId), attachmentPoint->CachedPosition);
+					testPassed &= attachmentPoint->ObjectPosition.Equals(expected, 0.01f);
+					testPassed &= attachmentPoint->State == AttachmentPointStateType::Normal;
+				}
+				testPassed &= CheckPerfBaseline(TEXT("WLT.Perf.Fragments.Refreeze"), numAttachmentPoints, measured);
+			}
+			return testPassed;
+		}
+
+		bool RunTestPerfFragmentsRelease()
+		{
+			bool testPassed = true;
+			for (int numAttachmentPoints : perfSizes)
+			{
+				FAttachmentPointPool pool;
+				TArray<FFragment> fragments;
+				TArray<FAttachmentPointHandle> handles;
+				CreatePerfFragments(pool, fragments);
+				AddPerfAttachmentPoints(pool, fragments, numAttachmentPoints, handles);
+
+				// Release in random order, so releases hit the middle of fragments and of the pool.
+				FRandomStream random(40);
+				for (int i = handles.Num() - 1; i > 0; --i)
+				{
+					handles.Swap(i, random.RandRange(0, i));
+				}
+
+				FPerfMeasurement measured = MeasurePerf([&]()
+				{
+					for (const auto& handle : handles)
+					{
+						fragments[(int)pool.Get(handle)->FragmentId - 1].ReleaseAttachmentPoint(handle);
+						pool.Release(handle);
+					}
+				});
+
+				testPassed &= pool.Num() == 0;
+				for (const auto& fragment : fragments)
+				{
+					testPassed &= fragment.NumAttachmentPoints() == 0;
+				}
+				testPassed &= CheckPerfBaseline(TEXT("WLT.Perf.Fragments.Release"), numAttachmentPoints, measured);
+			}
+			return testPassed;
+		}
+	};
+}
 
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPluginTest, "WLT.Plugin", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
@@ -556,6 +2464,48 @@ bool FWLTTriangulatorObtuseTest::RunTest(FString const& Parameters) {
 	return Test.RunTestTriangulatorObtuse();
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTTriangulatorWalkTest, "WLT.Triangulator.Walk", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTTriangulatorWalkTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestTriangulatorWalk();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfTriangulatorWalkTest, "WLT.Perf.Triangulator.Walk", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfTriangulatorWalkTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfTriangulatorWalk();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTTriangulatorIncrementalTest, "WLT.Triangulator.Incremental", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTTriangulatorIncrementalTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestTriangulatorIncremental();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfTriangulatorEditTest, "WLT.Perf.Triangulator.Edit", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfTriangulatorEditTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfTriangulatorEdit();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTTriangulatorDelaunayTest, "WLT.Triangulator.Delaunay", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTTriangulatorDelaunayTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestTriangulatorDelaunay();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfTriangulatorDelaunayTest, "WLT.Perf.Triangulator.Delaunay", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfTriangulatorDelaunayTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfTriangulatorDelaunay();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfTriangulatorTest, "WLT.Perf.Triangulator", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfTriangulatorTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfTriangulator();
+}
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAlignmentThreeBodyTest, "WLT.Alignment.ThreeBodyOrient", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
 bool FWLTAlignmentThreeBodyTest::RunTest(FString const& Parameters) {
 	WorldLockingTools::FWLTTests Test;
@@ -568,6 +2518,150 @@ bool FWLTAlignmentBasicTest::RunTest(FString const& Parameters) {
 	return Test.RunTestAlignmentManagerBasic();
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAlignmentBatchTest, "WLT.Alignment.Batch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAlignmentBatchTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAlignmentManagerBatch();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfAlignmentBatchTest, "WLT.Perf.Alignment.Batch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfAlignmentBatchTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfAlignmentBatch();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAlignmentManagerPoolTest, "WLT.Alignment.Pool", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAlignmentManagerPoolTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAlignmentManagerPool();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfAlignmentManagerPoolTest, "WLT.Perf.Alignment.Pool", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfAlignmentManagerPoolTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfAlignmentManagerPool();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAlignmentManagerLevelsTest, "WLT.Alignment.Levels", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAlignmentManagerLevelsTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAlignmentManagerLevels();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAlignmentManagerTransactionTest, "WLT.Alignment.Transaction", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAlignmentManagerTransactionTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAlignmentManagerTransaction();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfAlignmentManagerTransactionTest, "WLT.Perf.Alignment.Transaction", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfAlignmentManagerTransactionTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfAlignmentManagerTransaction();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAlignmentManagerRefitTest, "WLT.Alignment.Refit", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAlignmentManagerRefitTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAlignmentManagerRefit();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPoseAveragingTest, "WLT.Alignment.Averaging", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTPoseAveragingTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPoseAveraging();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfPoseAveragingTest, "WLT.Perf.Alignment.Averaging", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfPoseAveragingTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfPoseAveraging();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAnchorRegionStoreTest, "WLT.AnchorRegionStore", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAnchorRegionStoreTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAnchorRegionStore();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAttachmentPointBatchListenerTest, "WLT.AttachmentPointBatchListener", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAttachmentPointBatchListenerTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAttachmentPointBatchListener();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAttachmentPointChangesTest, "WLT.AttachmentPointChanges", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAttachmentPointChangesTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAttachmentPointChanges();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTDeferredAdjustmentsTest, "WLT.DeferredAdjustments", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTDeferredAdjustmentsTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestDeferredAdjustments();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPendingAttachmentPointPriorityTest, "WLT.PendingAttachmentPointPriority", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTPendingAttachmentPointPriorityTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPendingAttachmentPointPriority();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAttachmentPointPoolTest, "WLT.AttachmentPointPool", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAttachmentPointPoolTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAttachmentPointPool();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfAttachmentPointPoolTest, "WLT.Perf.AttachmentPointPool", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfAttachmentPointPoolTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfAttachmentPointPool();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTAttachmentPointIndexTest, "WLT.AttachmentPointIndex", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FWLTAttachmentPointIndexTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestAttachmentPointIndex();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfAttachmentPointIndexTest, "WLT.Perf.AttachmentPointIndex", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfAttachmentPointIndexTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfAttachmentPointIndex();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfFragmentsCreateTest, "WLT.Perf.Fragments.Create", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfFragmentsCreateTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfFragmentsCreate();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfFragmentsMergeTest, "WLT.Perf.Fragments.Merge", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfFragmentsMergeTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfFragmentsMerge();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfFragmentsRefreezeTest, "WLT.Perf.Fragments.Refreeze", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfFragmentsRefreezeTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfFragmentsRefreeze();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTPerfFragmentsReleaseTest, "WLT.Perf.Fragments.Release", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTPerfFragmentsReleaseTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestPerfFragmentsRelease();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWLTFragmentMergeBenchmarkTest, "WLT.Perf.FragmentMerge", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FWLTFragmentMergeBenchmarkTest::RunTest(FString const& Parameters) {
+	WorldLockingTools::FWLTTests Test;
+	return Test.RunTestFragmentMergeBenchmark();
+}
+
 struct Edge
 {
 	int idx0;
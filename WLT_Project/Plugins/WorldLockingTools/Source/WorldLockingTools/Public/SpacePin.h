@@ -72,6 +72,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "World Locking Tools")
 	void SetLockedPose(FTransform lockedPose, float PositionTolerance = 1, float RotationTolerance = 3);
 
+	/// SetFrozenPose for each of many space pins, updating the alignment once for all of them, as after a calibration pass.
+	/// @param SpacePins The space pins to set.
+	/// @param FrozenPoses Pose in frozen space for each of SpacePins.
+	/// The other parameters are as for SetFrozenPose, and apply to every space pin.
+	UFUNCTION(BlueprintCallable, Category = "World Locking Tools")
+	static void SetFrozenPoses(const TArray<USpacePin*>& SpacePins, const TArray<FTransform>& FrozenPoses, bool FlipTransformAroundY = false, bool IgnoreYaw = false, bool IgnorePitch = true, bool IgnoreRoll = true, float PositionTolerance = 1, float RotationTolerance = 3);
+
+	/// SetSpongyPose for each of many space pins, updating the alignment once for all of them, as after a calibration pass.
+	/// @param SpacePins The space pins to set.
+	/// @param SpongyPoses Pose in spongy space for each of SpacePins.
+	/// The other parameters are as for SetSpongyPose, and apply to every space pin.
+	UFUNCTION(BlueprintCallable, Category = "World Locking Tools")
+	static void SetSpongyPoses(const TArray<USpacePin*>& SpacePins, const TArray<FTransform>& SpongyPoses, bool FlipTransformAroundY = false, bool IgnoreYaw = false, bool IgnorePitch = true, bool IgnoreRoll = true, float PositionTolerance = 1, float RotationTolerance = 3);
+
+	/// SetLockedPose for each of many space pins, updating the alignment once for all of them, as after a calibration pass.
+	/// @param SpacePins The space pins to set.
+	/// @param LockedPoses Pose in locked space for each of SpacePins.
+	/// The other parameters are as for SetLockedPose, and apply to every space pin.
+	UFUNCTION(BlueprintCallable, Category = "World Locking Tools")
+	static void SetLockedPoses(const TArray<USpacePin*>& SpacePins, const TArray<FTransform>& LockedPoses, float PositionTolerance = 1, float RotationTolerance = 3);
+
 private:
 	WorldLockingTools::FAttachmentPoint::FAdjustLocationDelegate LocationHandler;
 
@@ -79,7 +100,7 @@ private:
 	FTransform restorePoseLocal = FTransform::Identity;
 	FTransform modelingPoseParent = FTransform::Identity;
 
-	TSharedPtr<WorldLockingTools::FAttachmentPoint> AttachmentPoint = nullptr;
+	WorldLockingTools::FAttachmentPointHandle AttachmentPoint;
 
 	FTransform GlobalFromParent();
 	FTransform ParentFromGlobal();
@@ -92,6 +113,8 @@ private:
 	void RestoreOnLoad();
 	void Reset();
 
+	static bool CheckBatchSizes(const TArray<USpacePin*>& SpacePins, const TArray<FTransform>& Poses);
+
 public:
 	FrozenWorld_AnchorId AnchorID = FrozenWorld_AnchorId_UNKNOWN;
 	FString AnchorName;
@@ -69,4 +69,22 @@ public:
 	// Reset WorldLocking to a well-defined, empty state
 	UFUNCTION(BlueprintCallable, Category = "World Locking Tools")
 	static void Reset();
+
+	// Statistics of the pool of scene components spongy anchors are pinned to.
+	UFUNCTION(BlueprintPure, Category = "World Locking Tools")
+	static FAnchorComponentPoolStats GetAnchorComponentPoolStats();
+
+	// Statistics of collapsing clusters of redundant anchors.
+	UFUNCTION(BlueprintPure, Category = "World Locking Tools")
+	static FAnchorConsolidationStats GetAnchorConsolidationStats();
+
+	// Statistics of attachment points waiting to be set up.
+	UFUNCTION(BlueprintPure, Category = "World Locking Tools")
+	static FPendingAttachmentPointStats GetPendingAttachmentPointStats();
+
+	// The pinning transform, from locked to pinned space, at each of many positions in locked space, as applied at the head.
+	// Positions are evaluated fastest in order of nearness to the one before. Batches of BatchSize positions are spread
+	// over worker threads, or all are evaluated on the calling thread if BatchSize is zero or negative.
+	UFUNCTION(BlueprintCallable, Category = "World Locking Tools")
+	static TArray<FTransform> ComputePinnedFromLockedPoses(const TArray<FVector>& LockedPositions, int BatchSize = 256);
 };
@@ -8,6 +8,115 @@
 
 #include "WorldLockingToolsTypes.generated.h"
 
+/*How edges between spongy anchors are created.*/
+UENUM(BlueprintType, Category = "World Locking Tools")
+enum class EAnchorEdgeMode : uint8
+{
+	/*Connect each new anchor to every anchor within MaxAnchorEdgeLength.*/
+	Radius,
+	/*
+	* Connect each new anchor to its nearest anchors within MaxAnchorEdgeLength, at most MaxAnchorEdgesPerAnchor per anchor,
+	* and repair the graph in the background by adding missing edges and dropping redundant ones.
+	*/
+	NearestNeighbors
+};
+
+/*Statistics of the pool of scene components that spongy anchors are pinned to.*/
+USTRUCT(BlueprintType, Category = "World Locking Tools")
+struct FAnchorComponentPoolStats
+{
+	GENERATED_BODY()
+
+	/*Components created since the pool was started.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumCreated = 0;
+
+	/*Components currently pinned to an anchor.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumInUse = 0;
+
+	/*Components waiting in the pool to be reused.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumFree = 0;
+
+	/*Times a new anchor was served a component from the pool instead of a new one.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumReused = 0;
+
+	/*Components released to the garbage collector because the pool was full.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumDiscarded = 0;
+};
+
+/*Statistics of anchor consolidation.*/
+USTRUCT(BlueprintType, Category = "World Locking Tools")
+struct FAnchorConsolidationStats
+{
+	GENERATED_BODY()
+
+	/*Consolidation passes run since starting.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumPasses = 0;
+
+	/*Clusters collapsed into a single anchor since starting.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumClustersCollapsed = 0;
+
+	/*Anchors removed by consolidation since starting.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumAnchorsRemoved = 0;
+
+	/*Anchors in the spongy snapshot after the last pass.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumActiveAnchors = 0;
+
+	/*Visual supports gathered by the engine in the frame before the last pass.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumVisualSupports = 0;
+
+	/*
+	* Largest disagreement between spongy and frozen distance of an anchor removed in the last pass to its representative, in cm.
+	* Stays below AnchorConsolidationTolerance.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	float MaxConsolidationError = 0.0f;
+
+	/*CPU time of the last pass in microseconds.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	float LastPassMicroseconds = 0.0f;
+};
+
+/*Statistics of attachment points waiting for a valid fragment to be set up in.*/
+USTRUCT(BlueprintType, Category = "World Locking Tools")
+struct FPendingAttachmentPointStats
+{
+	GENERATED_BODY()
+
+	/*Attachment points waiting to be set up.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 QueueDepth = 0;
+
+	/*Most attachment points ever waiting at once.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 MaxQueueDepth = 0;
+
+	/*Attachment points set up in the last frame.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumProcessedLastFrame = 0;
+
+	/*Attachment points set up since starting.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	int32 NumProcessed = 0;
+
+	/*Average time in milliseconds from queueing to setting up an attachment point.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	float AverageLatencyMilliseconds = 0.0f;
+
+	/*Longest time in milliseconds from queueing to setting up an attachment point.*/
+	UPROPERTY(BlueprintReadOnly, Category = "World Locking Tools")
+	float MaxLatencyMilliseconds = 0.0f;
+};
+
 /*Configuration for World Locking Tools.*/
 USTRUCT(BlueprintType, Category = "World Locking Tools")
 struct FWorldLockingToolsConfiguration
@@ -55,4 +164,133 @@ struct FWorldLockingToolsConfiguration
 	*/
 	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
 	int MaxLocalAnchors = 0;
+
+	/*How edges between anchors are created.*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	EAnchorEdgeMode AnchorEdgeMode = EAnchorEdgeMode::Radius;
+
+	/*Maximum number of edges per anchor when AnchorEdgeMode is NearestNeighbors.*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int MaxAnchorEdgesPerAnchor = 6;
+
+	/*Number of anchors visited per frame by the background graph repair when AnchorEdgeMode is NearestNeighbors.*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int MaxGraphRepairsPerFrame = 4;
+
+	/*
+	* Maximum number of stored anchors restored per frame after loading, nearest to the head first.
+	* Zero or negative restores all stored anchors in a single frame.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int MaxAnchorRestoresPerFrame = 16;
+
+	/*
+	* Edge length of the cubic regions by which anchors are paged in and out of the FrozenWorld engine on very large sites.
+	* Zero or negative keeps all anchors resident.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float AnchorRegionSize = 0.0f;
+
+	/*Regions up to this many regions away from the head's region are paged in.*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int AnchorRegionLoadRadius = 1;
+
+	/*
+	* Regions more than this many regions away from the head's region are paged out.
+	* Raised to at least AnchorRegionLoadRadius + 1, so that walking along a region border doesn't page the same regions in and out.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int AnchorRegionUnloadRadius = 2;
+
+	/*
+	* Maximum number of unused anchor scene components kept for reuse.
+	* Components released beyond this are left to the garbage collector.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int MaxPooledAnchorComponents = 32;
+
+	/*Number of anchor scene components created up front when starting.*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int PrewarmAnchorComponents = 4;
+
+	/*
+	* Tracked anchors closer than this to each other are collapsed into a single anchor, if they agree on their relative placement.
+	* This reduces the supports the engine gathers and aligns each frame on dense walking paths.
+	* Zero or negative disables consolidation. Should be below MinNewAnchorDistance.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float AnchorConsolidationDistance = 0.0f;
+
+	/*Maximum difference between the spongy and frozen distance of two anchors for them to be collapsed.*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float AnchorConsolidationTolerance = 2.0f;
+
+	/*Time in seconds between consolidation passes.*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float AnchorConsolidationInterval = 5.0f;
+
+	/*
+	* Number of attachment points whose refreeze adjustments are computed per worker task.
+	* Zero or negative computes all adjustments on the game thread, which is the default since the
+	* FrozenWorld engine isn't documented as safe to query from several threads at once.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int AdjustmentBatchSize = 0;
+
+	/*
+	* CPU time per frame in microseconds for applying the adjustments of a refreeze or merge to attachment points.
+	* The refit itself is committed at once, but attachment points beyond the budget are adjusted on following frames,
+	* those in view and near the head first.
+	* Zero or negative adjusts all attachment points in the frame of the refit.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float RefitBudgetMicroseconds = 0.0f;
+
+	/*
+	* Maximum number of pending attachment points set up per frame, nearest to the head first.
+	* Zero or negative sets up all pending attachment points as soon as there is a valid fragment.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	int MaxPendingAttachmentPointsPerFrame = 0;
+
+	/*
+	* CPU time per frame in microseconds for setting up pending attachment points.
+	* Zero or negative for no time limit.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float PendingAttachmentPointBudgetMicroseconds = 0.0f;
+
+	/*
+	* Edge length of the grid cells by which attachment points are indexed for spatial queries.
+	* Queries are fastest when this is close to the typical query radius.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float AttachmentPointIndexCellSize = 200.0f;
+
+	/*
+	* Triangulate the space pins Delaunay, using exact geometric predicates, instead of flipping long edges.
+	* This avoids sliver triangles, for smoother alignment between pins, and is robust to pins placed in lines or on a grid.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	bool DelaunayTriangulation = false;
+
+	/*
+	* Average the rotations of the space pins around the camera exactly, as the eigenvector of their outer products,
+	* rather than by normalizing their sum. This only makes a visible difference where nearby pins disagree strongly in rotation.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	bool EigenRotationAveraging = false;
+
+	/*
+	* Align by the space pins on each level of a building, such as each floor, separately from those on the others.
+	* Pins are on different levels where their heights are further apart than this. Zero or negative to align by all the pins together.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float AlignmentLevelSeparation = 0.0f;
+
+	/*
+	* Height over which the alignment blends from one level of space pins to the next, halfway between them, as on stairs and ramps.
+	*/
+	UPROPERTY(BlueprintReadWrite, AdvancedDisplay, Category = "World Locking Tools")
+	float AlignmentLevelBlendHeight = 100.0f;
 };
\ No newline at end of file